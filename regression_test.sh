@@ -0,0 +1,61 @@
+#! /bin/bash
+#
+# Runs every tests/NAME.sh from the repository root and compares what it prints (stdout and
+# stderr, then its exit status) with tests/NAME.out. A case exiting with 77 is skipped.
+#
+#     ./regression_test.sh [--update] [NAME...]
+#
+# DIS names the binary under test (default Release/Toy_disassembler), --update rewrites the
+# expected output of the cases run.
+
+cd "$(dirname "$0")"
+
+DIS=${DIS:-Release/Toy_disassembler}
+if [ ! -x "$DIS" ]; then
+	echo "$DIS not found, build the Release configuration or set DIS" >&2
+	exit 2
+fi
+export DIS="$(cd "$(dirname "$DIS")" && pwd)/$(basename "$DIS")"
+
+update=0
+if [ "$1" = "--update" ]; then
+	update=1
+	shift
+fi
+
+cases=("$@")
+if [ ${#cases[@]} -eq 0 ]; then
+	for f in tests/*.sh; do
+		cases+=("$(basename "$f" .sh)")
+	done
+fi
+
+passed=0 failed=0 skipped=0
+for name in "${cases[@]}"; do
+	export TMP=$(mktemp -d)
+	actual="$TMP/.actual"
+
+	bash "tests/$name.sh" > "$actual" 2>&1
+	status=$?
+	echo "exit $status" >> "$actual"
+
+	if [ $status -eq 77 ]; then
+		echo "SKIP $name"
+		skipped=$((skipped + 1))
+	elif [ $update -eq 1 ]; then
+		cp "$actual" "tests/$name.out"
+		echo "UPDATED $name"
+	elif diff -u "tests/$name.out" "$actual" > "$TMP/.diff"; then
+		echo "PASS $name"
+		passed=$((passed + 1))
+	else
+		echo "FAIL $name"
+		head -40 "$TMP/.diff"
+		failed=$((failed + 1))
+	fi
+
+	rm -rf "$TMP"
+done
+
+echo "$passed passed, $failed failed, $skipped skipped"
+[ $failed -eq 0 ]
@@ -0,0 +1,570 @@
+/*
+ * assembler.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Single pass assembler for the alternate (-a) format. Literal sections (LIT_*) give the
+ * function tree in pre-order, code sections (MAIN, FUN_*) are encoded as they are read
+ * and forward jump labels are backpatched as soon as the label is defined.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "disassembler_utils.h"
+#include "disassembler_index.h"
+#include "disassembler_rewrite.h"
+#include "disassembler_string.h"
+#include "assembler.h"
+
+typedef struct asm_function_s {
+    dis_buffer_t literals;
+    uint16_t literal_count;
+    uint16_t function_literals;
+    uint16_t children;
+    dis_buffer_t code;
+    uint32_t pending; // jumps to labels not defined yet
+    bool has_code;
+} asm_function_t;
+
+typedef struct asm_fixup_s {
+    uint32_t pos;  // operand position inside the code buffer
+    int32_t fn;    //
+    int32_t next;  // next pending fixup of the same label, -1 ends
+} asm_fixup_t;
+
+typedef struct asm_s {
+    const char *filename;
+    uint32_t line;
+    dis_index_t idx;
+    asm_function_t *fns;
+    dis_buffer_t header;
+    int32_t section;        // function of the current LIT_/code section, -1 none
+    bool in_code;           //
+    bool implicit_return;   // next FN_RETURN was synthesized by the disassembler
+    int32_t *label_offset;  // per label id, -1 undefined
+    int32_t *label_pending; // head of the pending fixup list per label id
+    uint32_t label_capacity;
+    asm_fixup_t *fixups;
+    uint32_t fixup_count;
+    uint32_t fixup_capacity;
+} asm_t;
+
+static uint8_t asm_error(asm_t *as, const char *msg, const char *arg) {
+    printf("ERROR: %s:%u: %s%s%s\n", as->filename, as->line, msg, arg ? " " : "", arg ? arg : "");
+    return 1;
+}
+
+static char* asm_skip(char *s) {
+    while (*s == ' ' || *s == '\t')
+        ++s;
+    return s;
+}
+
+static char* asm_token(char **s) {
+    char *start = asm_skip(*s), *end = start;
+
+    while (*end && *end != ' ' && *end != '\t')
+        ++end;
+    if (*end)
+        *end++ = '\0';
+    *s = end;
+    return start;
+}
+
+static int32_t asm_find_function(asm_t *as, const char *path) {
+    for (uint32_t i = 0; i < as->idx.function_count; i++)
+        if (!strcmp(as->idx.functions[i].path, path))
+            return i;
+    return -1;
+}
+
+static int32_t asm_add_function(asm_t *as, const char *path, int32_t parent) {
+    if (as->idx.function_count == as->idx.function_capacity) {
+        as->idx.function_capacity = as->idx.function_capacity ? as->idx.function_capacity * 2 : 16;
+        as->idx.functions = realloc(as->idx.functions, as->idx.function_capacity * sizeof(dis_function_t));
+        as->fns = realloc(as->fns, as->idx.function_capacity * sizeof(asm_function_t));
+    }
+
+    dis_function_t *f = &as->idx.functions[as->idx.function_count];
+    memset(f, 0, sizeof(dis_function_t));
+    memset(&as->fns[as->idx.function_count], 0, sizeof(asm_function_t));
+    strcpy(f->path, path);
+    f->parent = parent;
+    f->depth = parent < 0 ? 0 : as->idx.functions[parent].depth + 1;
+
+    return as->idx.function_count++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static uint8_t asm_literal(asm_t *as, char *line) {
+    asm_function_t *af = &as->fns[as->section];
+    dis_buffer_t *b = &af->literals;
+    char *kind = asm_token(&line), *end;
+    uint32_t len;
+
+    if (af->literal_count == UINT16_MAX)
+        return asm_error(as, "too many literals", NULL);
+
+    if (!strcmp(kind, "NULL"))
+        dis_buffer_byte(b, DIS_LITERAL_NULL);
+    else if (!strcmp(kind, "BLANK"))
+        dis_buffer_byte(b, DIS_LITERAL_INDEX_BLANK);
+    else if (!strcmp(kind, "BOOLEAN")) {
+        char *v = asm_token(&line);
+        dis_buffer_byte(b, DIS_LITERAL_BOOLEAN);
+        dis_buffer_byte(b, !strcmp(v, "true"));
+    } else if (!strcmp(kind, "INTEGER")) {
+        int32_t v = strtol(asm_token(&line), &end, 10);
+        dis_buffer_byte(b, DIS_LITERAL_INTEGER);
+        dis_buffer_append(b, &v, 4);
+    } else if (!strcmp(kind, "FLOAT")) {
+        float v = strtof(asm_token(&line), &end);
+        dis_buffer_byte(b, DIS_LITERAL_FLOAT);
+        dis_buffer_append(b, &v, 4);
+    } else if (!strcmp(kind, "STRING")) {
+        char *open = strchr(line, '"');
+        if (open == NULL || dis_unescape(open + 1, '"', open + 1, &len, NULL))
+            return asm_error(as, "bad or unterminated string literal", NULL);
+        dis_buffer_byte(b, DIS_LITERAL_STRING);
+        dis_buffer_append(b, open + 1, len);
+        dis_buffer_byte(b, '\0');
+    } else if (!strcmp(kind, "IDENTIFIER")) {
+        char *v = asm_token(&line);
+        if (dis_unescape(v, '\0', v, &len, NULL))
+            return asm_error(as, "bad identifier literal", NULL);
+        dis_buffer_byte(b, DIS_LITERAL_IDENTIFIER);
+        dis_buffer_append(b, v, len);
+        dis_buffer_byte(b, '\0');
+    } else if (!strcmp(kind, "FUNCTION")) {
+        dis_buffer_byte(b, DIS_LITERAL_FUNCTION);
+        dis_buffer_word(b, strtoul(asm_token(&line), &end, 10));
+        ++af->function_literals;
+    } else if (!strcmp(kind, "ARRAY") || !strcmp(kind, "ARRAY_INTERMEDIATE")) {
+        dis_buffer_t items = { NULL, 0, 0 };
+        char *tok;
+        while (*(tok = asm_token(&line)))
+            dis_buffer_word(&items, strtoul(tok, &end, 10));
+        dis_buffer_byte(b, kind[5] ? DIS_LITERAL_ARRAY_INTERMEDIATE : DIS_LITERAL_ARRAY);
+        dis_buffer_word(b, items.len / 2);
+        dis_buffer_append(b, items.data, items.len);
+        dis_buffer_free(&items);
+    } else if (!strcmp(kind, "DICTIONARY") || !strcmp(kind, "DICTIONARY_INTERMEDIATE")) {
+        dis_buffer_t items = { NULL, 0, 0 };
+        char *tok;
+        while (*(tok = asm_token(&line))) {
+            dis_buffer_word(&items, strtoul(tok, &end, 10));
+            if (*end != ',') {
+                dis_buffer_free(&items);
+                return asm_error(as, "malformed dictionary entry", tok);
+            }
+            dis_buffer_word(&items, strtoul(end + 1, &end, 10));
+        }
+        dis_buffer_byte(b, kind[10] ? DIS_LITERAL_DICTIONARY_INTERMEDIATE : DIS_LITERAL_DICTIONARY);
+        dis_buffer_word(b, items.len / 2);
+        dis_buffer_append(b, items.data, items.len);
+        dis_buffer_free(&items);
+    } else if (!strcmp(kind, "TYPE") || !strcmp(kind, "TYPE_INTERMEDIATE")) {
+        char *name = asm_token(&line), *sub;
+        int16_t type = -1;
+
+        for (uint8_t t = 0; t <= DIS_LITERAL_INDEX_BLANK; t++)
+            if (!strcmp(LIT_STR[t] + 12, name))
+                type = t;
+        if (type < 0)
+            return asm_error(as, "unknown literal type", name);
+
+        dis_buffer_byte(b, kind[4] ? DIS_LITERAL_TYPE_INTERMEDIATE : DIS_LITERAL_TYPE);
+        dis_buffer_byte(b, type);
+        dis_buffer_byte(b, strtoul(asm_token(&line), &end, 10));
+
+        if (type == DIS_LITERAL_ARRAY || type == DIS_LITERAL_DICTIONARY) {
+            if (strcmp(asm_token(&line), "SUBTYPE"))
+                return asm_error(as, "missing SUBTYPE", NULL);
+            sub = asm_token(&line);
+            dis_buffer_word(b, strtoul(sub, &end, 10));
+            if (type == DIS_LITERAL_DICTIONARY) {
+                if (*end != ',')
+                    return asm_error(as, "malformed SUBTYPE", sub);
+                dis_buffer_word(b, strtoul(end + 1, &end, 10));
+            }
+        }
+    } else
+        return asm_error(as, "unknown literal", kind);
+
+    ++af->literal_count;
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void asm_label_reserve(asm_t *as, uint32_t id) {
+    if (id < as->label_capacity)
+        return;
+
+    uint32_t capacity = as->label_capacity ? as->label_capacity : 64;
+    while (capacity <= id)
+        capacity *= 2;
+
+    as->label_offset = realloc(as->label_offset, capacity * sizeof(int32_t));
+    as->label_pending = realloc(as->label_pending, capacity * sizeof(int32_t));
+    for (uint32_t i = as->label_capacity; i < capacity; i++)
+        as->label_offset[i] = as->label_pending[i] = -1;
+    as->label_capacity = capacity;
+}
+
+static uint8_t asm_label_id(asm_t *as, const char *s, uint32_t *id) {
+    char *end;
+
+    if (strncmp(s, "JL_", 3) || !isdigit((unsigned char) s[3]))
+        return asm_error(as, "malformed label", s);
+
+    *id = strtoul(s + 3, &end, 10);
+    if (*end != '_' || *id >= (1 << 24))
+        return asm_error(as, "malformed label", s);
+
+    asm_label_reserve(as, *id);
+    return 0;
+}
+
+static uint8_t asm_define_label(asm_t *as, const char *s) {
+    dis_buffer_t *code = &as->fns[as->section].code;
+    uint32_t id;
+
+    if (asm_label_id(as, s, &id))
+        return 1;
+    if (as->label_offset[id] >= 0)
+        return asm_error(as, "duplicated label", s);
+    as->label_offset[id] = code->len;
+
+    // backpatch every jump already emitted for this label
+    for (int32_t f = as->label_pending[id]; f >= 0; f = as->fixups[f].next) {
+        uint16_t word = code->len;
+        if (as->fixups[f].fn != as->section)
+            return asm_error(as, "label used outside its function", s);
+        memcpy(code->data + as->fixups[f].pos, &word, 2);
+        as->fixups[f].fn = -1;
+        as->fns[as->section].pending--;
+    }
+    as->label_pending[id] = -1;
+
+    return 0;
+}
+
+static uint8_t asm_instruction(asm_t *as, char *line) {
+    dis_buffer_t *code = &as->fns[as->section].code;
+    char *mnemonic = asm_token(&line);
+    int16_t opcode = -1;
+
+    for (uint8_t op = 0; op < DIS_OP_END_OPCODES; op++)
+        if (!strcmp(OP_STR[op] + 7, mnemonic))
+            opcode = op;
+    if (opcode < 0)
+        return asm_error(as, "unknown opcode", mnemonic);
+    if (as->idx.ops->removed[opcode])
+        return asm_error(as, "opcode not in this bytecode version", mnemonic);
+
+    if (as->implicit_return) {
+        as->implicit_return = false;
+        if (opcode == DIS_OP_FN_RETURN)
+            return 0;
+    }
+
+    dis_buffer_byte(code, opcode);
+
+    for (uint8_t n = 0; n < 2; n++) {
+        char *arg, *end;
+        uint32_t value, id;
+
+        if (as->idx.ops->args[opcode][n] == DIS_ARG_NONE)
+            continue;
+
+        arg = asm_token(&line);
+        if (n == 0 && as->idx.ops->args[opcode][2]) {
+            if (asm_label_id(as, arg, &id))
+                return 1;
+
+            if (as->label_offset[id] >= 0) {
+                dis_buffer_word(code, as->label_offset[id]);
+                continue;
+            }
+
+            if (as->fixup_count == as->fixup_capacity) {
+                as->fixup_capacity = as->fixup_capacity ? as->fixup_capacity * 2 : 64;
+                as->fixups = realloc(as->fixups, as->fixup_capacity * sizeof(asm_fixup_t));
+            }
+            as->fixups[as->fixup_count] = (asm_fixup_t) { code->len, as->section, as->label_pending[id] };
+            as->label_pending[id] = as->fixup_count++;
+            as->fns[as->section].pending++;
+            dis_buffer_word(code, 0);
+            continue;
+        }
+
+        if ((arg[0] != 'b' && arg[0] != 'w') || arg[1] != '(')
+            return asm_error(as, "malformed operand", arg);
+        value = strtoul(arg + 2, &end, 10);
+        if (*end != ')')
+            return asm_error(as, "malformed operand", arg);
+
+        if (as->idx.ops->args[opcode][n] == DIS_ARG_BYTE) {
+            if (arg[0] != 'b' || value > UINT8_MAX)
+                return asm_error(as, "byte operand expected", arg);
+            dis_buffer_byte(code, value);
+        } else {
+            if (arg[0] != 'w' || value > UINT16_MAX)
+                return asm_error(as, "word operand expected", arg);
+            dis_buffer_word(code, value);
+        }
+    }
+
+    return 0;
+}
+
+static uint8_t asm_end_section(asm_t *as) {
+    if (as->section < 0 || !as->in_code)
+        return 0;
+
+    if (as->fns[as->section].pending)
+        return asm_error(as, "undefined jump label in", as->idx.functions[as->section].path);
+
+    // only one code section is open at a time, all of its jumps are resolved now
+    as->fixup_count = 0;
+
+    dis_buffer_byte(&as->fns[as->section].code, DIS_OP_SECTION_END);
+    dis_buffer_byte(&as->fns[as->section].code, DIS_OP_EOF);
+    as->implicit_return = false;
+    return 0;
+}
+
+static uint8_t asm_begin_literals(asm_t *as, const char *path) {
+    char parent_path[DIS_PATH_MAX];
+    const char *sep = strrchr(path, '_');
+    int32_t parent = 0;
+
+    if (strlen(path) >= DIS_PATH_MAX)
+        return asm_error(as, "function path too long", path);
+
+    if (!strcmp(path, "MAIN")) {
+        if (as->idx.function_count)
+            return asm_error(as, "duplicated section", "LIT_MAIN");
+        as->section = asm_add_function(as, "MAIN", -1);
+        return 0;
+    }
+
+    if (sep != NULL) {
+        memcpy(parent_path, path, sep - path);
+        parent_path[sep - path] = '\0';
+        parent = asm_find_function(as, parent_path);
+    }
+
+    // sections come in pre-order: the parent is the last function or one of its ancestors
+    int32_t last = as->idx.function_count - 1;
+    while (last >= 0 && last != parent)
+        last = as->idx.functions[last].parent;
+    if (parent < 0 || last < 0 || asm_find_function(as, path) >= 0)
+        return asm_error(as, "misplaced section", path);
+
+    if (strtoul(sep ? sep + 1 : path, NULL, 10) != as->fns[parent].children)
+        return asm_error(as, "function sections out of order", path);
+    ++as->fns[parent].children;
+
+    as->section = asm_add_function(as, path, parent);
+    return 0;
+}
+
+static uint8_t asm_line(asm_t *as, char *line) {
+    size_t len;
+
+    line = asm_skip(line);
+    len = strlen(line);
+    while (len && (line[len - 1] == ' ' || line[len - 1] == '\t' || line[len - 1] == '\r'))
+        line[--len] = '\0';
+    if (!len)
+        return 0;
+
+    if (!strncmp(line, ".comment ", 9)) {
+        unsigned major, minor, patch;
+        char *build = strchr(line, '('), *build_end = strrchr(line, ')');
+
+        if (sscanf(line, ".comment Header Version: %u.%u.%u", &major, &minor, &patch) == 3 && build && build_end > build) {
+            if (major > UINT8_MAX || (as->idx.ops = dis_opset_select(major)) == NULL) {
+                char version[12];
+
+                snprintf(version, sizeof(version), "%u", major);
+                return asm_error(as, "unsupported bytecode version", version);
+            }
+            dis_buffer_free(&as->header);
+            dis_buffer_byte(&as->header, major);
+            dis_buffer_byte(&as->header, minor);
+            dis_buffer_byte(&as->header, patch);
+            dis_buffer_append(&as->header, build + 1, build_end - build - 1);
+            dis_buffer_byte(&as->header, '\0');
+            dis_buffer_byte(&as->header, DIS_OP_SECTION_END);
+        } else if (as->in_code && sscanf(line, ".comment args:%u, rets:%u", &major, &minor) == 2) {
+            as->idx.functions[as->section].args = major;
+            as->idx.functions[as->section].rets = minor;
+        } else if (as->in_code && !strcmp(line, ".comment implicit return"))
+            as->implicit_return = true;
+        return 0;
+    }
+
+    if (!strncmp(line, ".start ", 7))
+        return 0;
+
+    if (line[len - 1] == ':') {
+        line[--len] = '\0';
+
+        if (!strncmp(line, "JL_", 3)) {
+            if (!as->in_code)
+                return asm_error(as, "label outside a code section", line);
+            return asm_define_label(as, line);
+        }
+
+        if (asm_end_section(as))
+            return 1;
+
+        if (!strncmp(line, "LIT_FUN_", 8) || !strcmp(line, "LIT_MAIN")) {
+            as->in_code = false;
+            return asm_begin_literals(as, line[4] == 'F' ? line + 8 : line + 4);
+        }
+
+        if (!strncmp(line, "FUN_", 4) || !strcmp(line, "MAIN")) {
+            as->section = asm_find_function(as, line[0] == 'F' ? line + 4 : line);
+            if (as->section < 0 || as->fns[as->section].has_code)
+                return asm_error(as, "misplaced code section", line);
+            as->fns[as->section].has_code = true;
+            as->in_code = true;
+            return 0;
+        }
+
+        return asm_error(as, "unknown section", line);
+    }
+
+    if (as->section < 0)
+        return asm_error(as, "statement outside a section", line);
+
+    if (!strncmp(line, ".lit ", 5)) {
+        if (as->in_code)
+            return asm_error(as, "literal inside a code section", NULL);
+        return asm_literal(as, line + 5);
+    }
+
+    if (!as->in_code)
+        return asm_error(as, "instruction outside a code section", line);
+
+    return asm_instruction(as, line);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static uint8_t asm_finish(asm_t *as, dis_buffer_t *out) {
+    dis_rewrite_t rw;
+    uint8_t ret;
+
+    if (!as->header.len)
+        return asm_error(as, "missing header version comment", NULL);
+    if (!as->idx.function_count)
+        return asm_error(as, "missing LIT_MAIN section", NULL);
+
+    for (uint32_t i = 0; i < as->idx.function_count; i++) {
+        if (!as->fns[i].has_code)
+            return asm_error(as, "missing code section for", as->idx.functions[i].path);
+        if (as->fns[i].function_literals != as->fns[i].children)
+            return asm_error(as, "function literals do not match function sections in", as->idx.functions[i].path);
+    }
+
+    dis_rewrite_init(&rw, &as->idx);
+    rw.header = as->header;
+    for (uint32_t i = 0; i < as->idx.function_count; i++) {
+        rw.function_count[i] = as->fns[i].children;
+        rw.literal_count[i] = as->fns[i].literal_count;
+        rw.literals[i] = as->fns[i].literals;
+        rw.code[i] = as->fns[i].code;
+    }
+
+    ret = dis_rewrite_emit(&rw, out);
+    if (ret)
+        asm_error(as, "function too large to encode", NULL);
+
+    // buffers are owned by the rewrite now
+    as->header = (dis_buffer_t) { NULL, 0, 0 };
+    for (uint32_t i = 0; i < as->idx.function_count; i++)
+        as->fns[i].literals = as->fns[i].code = (dis_buffer_t) { NULL, 0, 0 };
+    dis_rewrite_free(&rw);
+
+    return ret;
+}
+
+uint8_t dis_assemble(const char *filename, const char *output) {
+    asm_t as;
+    uint8_t *text = NULL;
+    uint32_t len = 0;
+    dis_buffer_t line = { NULL, 0, 0 }, out = { NULL, 0, 0 };
+    uint8_t ret = 0;
+
+    if (dis_read_file(filename, &text, &len)) {
+        printf("Not able to open the file.\n");
+        return 1;
+    }
+
+    memset(&as, 0, sizeof(asm_t));
+    as.filename = filename;
+    as.section = -1;
+    as.idx.ops = dis_opset_latest();
+
+    for (uint32_t pc = 0; pc < len && !ret;) {
+        uint8_t *nl = memchr(text + pc, '\n', len - pc);
+        uint32_t end = nl ? (uint32_t) (nl - text) : len;
+
+        ++as.line;
+        dis_buffer_append(&line, text + pc, end - pc);
+        pc = end + 1;
+
+        // a trailing backslash continues long ARRAY/DICTIONARY literals on the next line
+        if (line.len && line.data[line.len - 1] == '\\') {
+            line.data[line.len - 1] = ' ';
+            continue;
+        }
+
+        dis_buffer_byte(&line, '\0');
+        ret = asm_line(&as, (char*) line.data);
+        line.len = 0;
+    }
+
+    if (!ret && line.len) {
+        dis_buffer_byte(&line, '\0');
+        ret = asm_line(&as, (char*) line.data);
+    }
+
+    if (!ret)
+        ret = asm_end_section(&as) || asm_finish(&as, &out);
+
+    if (!ret && dis_rewrite_verify(out.data, out.len)) {
+        printf("ERROR: assembled bytecode failed verification, nothing written\n");
+        ret = 1;
+    }
+
+    if (!ret && dis_write_file(output, out.data, out.len)) {
+        printf("ERROR: not able to write %s\n", output);
+        ret = 1;
+    }
+
+    for (uint32_t i = 0; i < as.idx.function_count; i++) {
+        dis_buffer_free(&as.fns[i].literals);
+        dis_buffer_free(&as.fns[i].code);
+    }
+    free(as.fns);
+    free(as.idx.functions);
+    free(as.label_offset);
+    free(as.label_pending);
+    free(as.fixups);
+    dis_buffer_free(&as.header);
+    dis_buffer_free(&line);
+    dis_buffer_free(&out);
+    free(text);
+
+    return ret;
+}
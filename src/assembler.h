@@ -0,0 +1,16 @@
+/*
+ * assembler.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Assembler for the alternate (-a) disassembly format, rebuilds the .tb binary.
+ */
+
+#ifndef ASSEMBLER_H_
+#define ASSEMBLER_H_
+
+#include <stdint.h>
+
+uint8_t dis_assemble(const char *filename, const char *output);
+
+#endif /* ASSEMBLER_H_ */
@@ -12,13 +12,27 @@
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "disassembler_utils.h"
+#include "disassembler_cache.h"
+#include "disassembler_profile.h"
+#include "disassembler_string.h"
 #include "disassembler.h"
+#include "disassembler_version.h"
 
-#define SPC(n)  printf("%.*s", n, "| | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | |");
+#define SPC(n)  fprintf(out, "%.*s", n, "| | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | | |");
 #define EP(x)   [x] = #x
 
+// stream mode gives back input pages every DIS_STREAM_WINDOW bytes of a long code section
+#define DIS_STREAM_WINDOW (1 << 20)
+
+// bytes per line of the --hex column, longer entries continue on the lines below
+#define DIS_HEX_COLUMN 8
+
 const char *OP_STR[] = {
         EP(DIS_OP_EOF),                       //
         EP(DIS_OP_PASS),                      //
@@ -98,15 +112,6 @@ const char *LIT_STR[] = {
         EP(DIS_LITERAL_INDEX_BLANK),             //
 };
 
-enum DIS_ARG_TYPE {
-    DIS_ARG_NONE,    //
-    DIS_ARG_BYTE,    //
-    DIS_ARG_WORD,    //
-    DIS_ARG_INTEGER, //
-    DIS_ARG_FLOAT,   //
-    DIS_ARG_STRING   //
-};
-
 const uint8_t OP_ARGS[DIS_OP_END_OPCODES][3] = {
       // |  first arg  | second arg | jump |
         { DIS_ARG_NONE, DIS_ARG_NONE, false }, // DIS_OP_EOF
@@ -163,10 +168,69 @@ const uint8_t OP_ARGS[DIS_OP_END_OPCODES][3] = {
         { DIS_ARG_NONE, DIS_ARG_NONE, false }, // DIS_OP_TERNARY
 };
 
+// stack effect of each opcode, DIS_STACK_VARIABLE is resolved by the stack analysis
+const int8_t OP_STACK[DIS_OP_END_OPCODES][2] = {
+      // | pops | pushes |
+        {  0,  0 }, // DIS_OP_EOF
+        {  0,  0 }, // DIS_OP_PASS
+        {  2,  0 }, // DIS_OP_ASSERT
+        {  1,  0 }, // DIS_OP_PRINT
+        {  0,  1 }, // DIS_OP_LITERAL
+        {  0,  1 }, // DIS_OP_LITERAL_LONG
+        {  1,  1 }, // DIS_OP_LITERAL_RAW
+        {  1,  1 }, // DIS_OP_NEGATE
+        {  2,  1 }, // DIS_OP_ADDITION
+        {  2,  1 }, // DIS_OP_SUBTRACTION
+        {  2,  1 }, // DIS_OP_MULTIPLICATION
+        {  2,  1 }, // DIS_OP_DIVISION
+        {  2,  1 }, // DIS_OP_MODULO
+        {  0,  0 }, // DIS_OP_GROUPING_BEGIN
+        {  0,  0 }, // DIS_OP_GROUPING_END
+        {  0,  0 }, // DIS_OP_SCOPE_BEGIN
+        {  0,  0 }, // DIS_OP_SCOPE_END
+        {  0,  0 }, // DIS_OP_TYPE_DECL_removed
+        {  0,  0 }, // DIS_OP_TYPE_DECL_LONG_removed
+        {  1,  0 }, // DIS_OP_VAR_DECL
+        {  1,  0 }, // DIS_OP_VAR_DECL_LONG
+        {  0,  0 }, // DIS_OP_FN_DECL
+        {  0,  0 }, // DIS_OP_FN_DECL_LONG
+        {  2,  0 }, // DIS_OP_VAR_ASSIGN
+        {  2,  0 }, // DIS_OP_VAR_ADDITION_ASSIGN
+        {  2,  0 }, // DIS_OP_VAR_SUBTRACTION_ASSIGN
+        {  2,  0 }, // DIS_OP_VAR_MULTIPLICATION_ASSIGN
+        {  2,  0 }, // DIS_OP_VAR_DIVISION_ASSIGN
+        {  2,  0 }, // DIS_OP_VAR_MODULO_ASSIGN
+        {  2,  1 }, // DIS_OP_TYPE_CAST
+        {  1,  1 }, // DIS_OP_TYPE_OF
+        {  2,  0 }, // DIS_OP_IMPORT
+        {  0,  0 }, // DIS_OP_EXPORT_removed
+        {  4,  1 }, // DIS_OP_INDEX
+        { DIS_STACK_VARIABLE,  0 }, // DIS_OP_INDEX_ASSIGN (plus one per intermediate)
+        {  4,  2 }, // DIS_OP_INDEX_ASSIGN_INTERMEDIATE
+        { DIS_STACK_VARIABLE,  1 }, // DIS_OP_DOT (argument count literal on top)
+        {  2,  1 }, // DIS_OP_COMPARE_EQUAL
+        {  2,  1 }, // DIS_OP_COMPARE_NOT_EQUAL
+        {  2,  1 }, // DIS_OP_COMPARE_LESS
+        {  2,  1 }, // DIS_OP_COMPARE_LESS_EQUAL
+        {  2,  1 }, // DIS_OP_COMPARE_GREATER
+        {  2,  1 }, // DIS_OP_COMPARE_GREATER_EQUAL
+        {  1,  1 }, // DIS_OP_INVERT
+        {  1,  0 }, // DIS_OP_AND (the value stays when the jump is taken)
+        {  1,  0 }, // DIS_OP_OR (the value stays when the jump is taken)
+        {  0,  0 }, // DIS_OP_JUMP
+        {  1,  0 }, // DIS_OP_IF_FALSE_JUMP
+        { DIS_STACK_VARIABLE,  1 }, // DIS_OP_FN_CALL (argument count literal on top)
+        { DIS_STACK_VARIABLE,  0 }, // DIS_OP_FN_RETURN (operand)
+        { DIS_STACK_VARIABLE,  0 }, // DIS_OP_POP_STACK (whole stack)
+        {  3,  1 }, // DIS_OP_TERNARY
+};
+
 typedef struct dis_program_s {
     uint8_t *program;
     uint32_t len;
     uint32_t pc;
+    bool mapped; // program is a file mapping (stream mode), not a heap buffer
+    const dis_opset_t *ops; // tables picked from the header version
 } dis_program_t;
 
 typedef struct fun_code_s {
@@ -177,9 +241,14 @@ typedef struct fun_code_s {
 
 typedef struct lit_s {
     char *fun;
-    char *str;
+    char *str;   // rendered literal block, NULL in stream mode
+    uint32_t pc; // literal section start, to render it again in stream mode
 } *lit_t;
 
+static FILE *out;
+static dis_profile_t *profile = NULL;
+static char *escaped = NULL;
+static size_t escaped_size = 0;
 uint32_t jump_label;
 uint32_t function_queue_len = 0;
 uint32_t lit_fn_queue_len = 0;
@@ -188,9 +257,25 @@ queue_node_t *function_queue_rear = NULL;
 queue_node_t *lit_fn_queue_front = NULL;
 queue_node_t *lit_fn_queue_rear = NULL;
 
-static void dis_print_opcode(uint8_t op);
+static void dis_print_opcode(const dis_opset_t *ops, uint8_t op);
+
+// LIT_STR name without its DIS_LITERAL_ prefix, type subtypes come straight from the file
+static const char* literalName(uint8_t type) {
+    return type <= DIS_LITERAL_INDEX_BLANK ? LIT_STR[type] + 12 : "UNKNOWN";
+}
+
+// length of the program being listed, no reader goes past it
+static uint32_t read_end = 0;
+
+static void readCheck(uint32_t count, uint32_t size) {
+    if (count > read_end || read_end - count < size) {
+        fprintf(out, "[internal] Truncated program (%u bytes needed at %u, size %u)\n", size, count, read_end);
+        exit(1);
+    }
+}
 
 static uint8_t readByte(const uint8_t *tb, uint32_t *count) {
+    readCheck(*count, 1);
     uint8_t ret = *(uint8_t*) (tb + *count);
     *count += 1;
     return ret;
@@ -198,6 +283,7 @@ static uint8_t readByte(const uint8_t *tb, uint32_t *count) {
 
 static uint16_t readWord(const uint8_t *tb, uint32_t *count) {
     uint16_t ret = 0;
+    readCheck(*count, 2);
     memcpy(&ret, tb + *count, 2);
     *count += 2;
     return ret;
@@ -205,6 +291,7 @@ static uint16_t readWord(const uint8_t *tb, uint32_t *count) {
 
 static int32_t readInt(const uint8_t *tb, uint32_t *count) {
     int ret = 0;
+    readCheck(*count, 4);
     memcpy(&ret, tb + *count, 4);
     *count += 4;
     return ret;
@@ -212,26 +299,80 @@ static int32_t readInt(const uint8_t *tb, uint32_t *count) {
 
 static float readFloat(const uint8_t *tb, uint32_t *count) {
     float ret = 0;
+    readCheck(*count, 4);
     memcpy(&ret, tb + *count, 4);
     *count += 4;
     return ret;
 }
 
-static char* readString(const uint8_t *tb, uint32_t *count) {
+static char* readString(const uint8_t *tb, uint32_t *count, uint32_t end) {
     const unsigned char *ret = tb + *count;
-    *count += strlen((char*) ret) + 1; //+1 for null character
+    uint32_t len = *count < end ? dis_strnlen(ret, end - *count) : 0;
+
+    if (*count + len >= end) {
+        fprintf(out, "[internal] Unterminated string at %u\n", *count);
+        exit(1);
+    }
+
+    *count += len + 1; //+1 for null character
     return (char*) ret;
 }
 
+// string and identifier literals are escaped so each stays on its own line, the buffer is reused
+static const char* escapeString(const char *s, uint32_t len, bool identifier) {
+    if (DIS_ESCAPE_MAX(len) > escaped_size) {
+        escaped_size = DIS_ESCAPE_MAX(len);
+        escaped = realloc(escaped, escaped_size);
+    }
+
+    dis_escape((const uint8_t*) s, len, escaped, identifier);
+    return escaped;
+}
+
+// "%f" unless it loses precision, so alt format output can be assembled back
+static void floatString(char *s, float f) {
+    sprintf(s, "%f", f);
+    if (strtof(s, NULL) != f)
+        sprintf(s, "%.9g", f);
+}
+
 static void consumeByte(uint8_t byte, uint8_t *tb, uint32_t *count) {
+    readCheck(*count, 1);
     if (byte != tb[*count]) {
-        printf("[internal] Failed to consume the correct byte (expected %u, found %u)\n", byte, tb[*count]);
+        fprintf(out, "[internal] Failed to consume the correct byte (expected %u, found %u)\n", byte, tb[*count]);
         exit(1);
     }
 
     *count += 1;
 }
 
+// first line of the hex column for program[from, to), padded to its full width
+static void dis_print_hex(const uint8_t *program, uint32_t from, uint32_t to) {
+    char line[DIS_HEX_MAX(DIS_HEX_COLUMN)];
+    uint32_t n = dis_hex(program + from, to - from < DIS_HEX_COLUMN ? to - from : DIS_HEX_COLUMN, line);
+
+    memset(line + n, ' ', 3 * DIS_HEX_COLUMN - n);
+    fwrite(line, 1, 3 * DIS_HEX_COLUMN, out);
+}
+
+// the bytes dis_print_hex left out, one line each under indent: instructions start their
+// lines with the newline, literal entries end them with it
+static void dis_print_hex_rest(const uint8_t *program, uint32_t from, uint32_t to, uint8_t spaces, const char *indent, bool line_end) {
+    char line[DIS_HEX_MAX(DIS_HEX_COLUMN)];
+
+    for (from += DIS_HEX_COLUMN; from < to; from += DIS_HEX_COLUMN) {
+        uint32_t n = dis_hex(program + from, to - from < DIS_HEX_COLUMN ? to - from : DIS_HEX_COLUMN, line);
+
+        if (!line_end)
+            fprintf(out, "\n");
+        SPC(spaces);
+        fputs(indent, out);
+        fwrite(line, 1, n - 1, out);
+        if (line_end)
+            fprintf(out, "\n");
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 static void dis_disassembler_init(dis_program_t **prg) {
@@ -239,101 +380,187 @@ static void dis_disassembler_init(dis_program_t **prg) {
     (*prg)->program = NULL;
     (*prg)->len = 0;
     (*prg)->pc = 0;
+    (*prg)->mapped = false;
+    (*prg)->ops = dis_opset_latest();
 }
 
 static void dis_disassembler_deinit(dis_program_t **prg) {
-    if((*prg)->program != NULL)
+    if ((*prg)->mapped)
+        munmap((*prg)->program, (*prg)->len);
+    else if((*prg)->program != NULL)
         free((*prg)->program);
     free((*prg));
 }
 
-static uint8_t dis_load_file(const char *filename, dis_program_t **prg, bool alt_fmt) {
-    FILE *f;
-    size_t fsize, bytes;
-    uint32_t count = 0;
-    uint8_t buf = 0;
+static uint8_t dis_load_file(const char *filename, dis_program_t **prg) {
+    if (dis_read_file(filename, &(*prg)->program, &(*prg)->len)) {
+        fprintf(out, "Not able to open the file.\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+// stream mode: pages are read ahead in order and dropped by dis_release once rendered
+static uint8_t dis_map_file(const char *filename, dis_program_t **prg) {
+    struct stat st;
+    int fd;
 
-    f = fopen(filename, "r");
-    if (f == NULL) {
-        printf("Not able to open the file.\n");
+    fd = strcmp(filename, "-") ? open(filename, O_RDONLY) : dup(STDIN_FILENO);
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size > UINT32_MAX) {
+        fprintf(out, "Not able to open the file.\n");
+        if (fd >= 0)
+            close(fd);
         return 1;
     }
 
-    fseek(f, 0, SEEK_END);
-    fsize = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    (*prg)->program = malloc(fsize * sizeof(uint8_t));
+    // a pipe can't be mapped, it is read whole
+    if (!S_ISREG(st.st_mode) || st.st_size == 0) {
+        close(fd);
+        return dis_load_file(filename, prg);
+    }
 
-    while ((bytes = fread(&buf, sizeof(uint8_t), 1, f)) == 1)
-        (*prg)->program[count++] = buf;
+    (*prg)->program = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
 
-    (*prg)->len = fsize;
+    if ((*prg)->program == MAP_FAILED) {
+        (*prg)->program = NULL;
+        fprintf(out, "Not able to map the file.\n");
+        return 1;
+    }
 
-    if (!alt_fmt)
-        printf("\nFile: %s\nSize: %zu\n", filename, fsize);
-    else
-        printf("\n.comment File: %s, Size: %zu\n", filename, fsize);
+    madvise((*prg)->program, st.st_size, MADV_SEQUENTIAL);
+    (*prg)->len = st.st_size;
+    (*prg)->mapped = true;
 
-    fclose(f);
     return 0;
 }
 
+// gives back the whole pages of [from, to), a later read of them faults them in again
+static void dis_release(dis_program_t **prg, uint32_t from, uint32_t to) {
+    if (!(*prg)->mapped)
+        return;
+
+    uintptr_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t start = ((uintptr_t) (*prg)->program + from + page - 1) & ~(page - 1);
+    uintptr_t end = ((uintptr_t) (*prg)->program + (to < (*prg)->len ? to : (*prg)->len)) & ~(page - 1);
+
+    if (start >= end)
+        return;
+
+    madvise((void*) start, end - start, MADV_DONTNEED);
+}
+
+static void dis_print_file(const char *filename, size_t fsize, bool alt_fmt) {
+    if (!alt_fmt)
+        fprintf(out, "\nFile: %s\nSize: %zu\n", filename, fsize);
+    else
+        fprintf(out, "\n.comment File: %s, Size: %zu\n", filename, fsize);
+}
+
 static void dis_read_header(dis_program_t **prg, bool alt_fmt) {
     const unsigned char major = readByte((*prg)->program, &((*prg)->pc));
     const unsigned char minor = readByte((*prg)->program, &((*prg)->pc));
     const unsigned char patch = readByte((*prg)->program, &((*prg)->pc));
-    const char *build = readString((*prg)->program, &((*prg)->pc));
+    const char *build = readString((*prg)->program, &((*prg)->pc), (*prg)->len);
 
     if (!alt_fmt)
-        printf("[Header Version: %d.%d.%d (%s)]\n", major, minor, patch, build);
+        fprintf(out, "[Header Version: %d.%d.%d (%s)]\n", major, minor, patch, build);
     else
-        printf(".comment Header Version: %d.%d.%d (%s)\n", major, minor, patch, build);
+        fprintf(out, ".comment Header Version: %d.%d.%d (%s)\n", major, minor, patch, build);
+
+    // no opcode table means no way to tell where one instruction ends, don't guess a layout
+    if (((*prg)->ops = dis_opset_select(major)) == NULL) {
+        fflush(out);
+        fprintf(stderr, "unsupported bytecode version %d\n", major);
+        exit(1);
+    }
 }
 
-static void dis_print_opcode(uint8_t op) {
+static void dis_print_opcode(const dis_opset_t *ops, uint8_t op) {
     if (op == 255) {
-        printf("SECTION_END");
+        fprintf(out, "SECTION_END");
         return;
     }
 
-    if (op < DIS_OP_END_OPCODES)
-        printf("%s", (OP_STR[op] + 7));
+    if (op < DIS_OP_END_OPCODES && !ops->removed[op])
+        fprintf(out, "%s", (OP_STR[op] + 7));
     else
-        printf("(OP UNKNOWN [%c])", op);
+        fprintf(out, "(OP UNKNOWN [%c])", op);
+}
+
+// block totals at every block start, hits before the instruction in alt format so it still assembles
+static void dis_print_profile(uint32_t pc, uint8_t spaces, options_t config) {
+    if (profile->leader[pc]) {
+        if (!config.alt_format_flag) {
+            fprintf(out, "\n");
+            SPC(spaces);
+            fprintf(out, "| --- ( block: %llu hits, %.2f%% ) ---", (unsigned long long) profile->blocks[pc], dis_profile_percent(profile, profile->blocks[pc]));
+        } else
+            fprintf(out, "\n    .comment block: %llu hits, %.2f%%", (unsigned long long) profile->blocks[pc], dis_profile_percent(profile, profile->blocks[pc]));
+    }
+
+    if (config.alt_format_flag && profile->counts[pc])
+        fprintf(out, "\n    .comment hits: %llu, %.2f%%", (unsigned long long) profile->counts[pc], dis_profile_percent(profile, profile->counts[pc]));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 #define S_OP(n, p) \
-		switch (OP_ARGS[opcode][n]) { \
+		switch ((*prg)->ops->args[opcode][n]) { \
 		    case DIS_ARG_NONE: \
 		    break; \
 		    case DIS_ARG_BYTE: \
 		        uint = readByte((*prg)->program, &pc); \
-		        if (p) printf(" b(%d)", uint); \
+		        if (p) fprintf(out, " b(%d)", uint); \
 		    break; \
 		    case DIS_ARG_WORD: \
 		        uint = readWord((*prg)->program, &pc);\
-		        if (p) printf(" w(%d)", uint); \
+		        if (p) fprintf(out, " w(%d)", uint); \
 		    break; \
 		    case DIS_ARG_INTEGER: \
 		        intg = readInt((*prg)->program, &pc); \
-		        if (p) printf(" i(%d)", intg); \
+		        if (p) fprintf(out, " i(%d)", intg); \
 		    break; \
 		    case DIS_ARG_FLOAT: \
 		        flt = readFloat((*prg)->program, &pc); \
-		        if (p) printf(" f(%f)", flt); \
+		        if (p) fprintf(out, " f(%f)", flt); \
 		    break; \
 		    case DIS_ARG_STRING: \
-		        str = readString((*prg)->program, &pc); \
-		        if (p) printf(" s(%s)", str); \
+		        str = readString((*prg)->program, &pc, (*prg)->len); \
+		        if (p) fprintf(out, " s(%s)", str); \
 		    break; \
 		    default: \
-		        printf("ERROR, unknown argument type\n"); \
+		        fprintf(out, "ERROR, unknown argument type\n"); \
 		        exit(1); \
 		}
 
-static void dis_disassemble_section(dis_program_t **prg, uint32_t pc, uint32_t len, uint8_t spaces, bool is_function, options_t config) {
+// indexed by DIS_ARG_TYPE, a string operand counts its terminator only
+static const uint8_t ARG_SIZE[] = { 0, 1, 2, 4, 4, 1 };
+
+// bytes after the opcode
+static uint32_t dis_operand_size(const dis_opset_t *ops, uint8_t opcode) {
+    return ARG_SIZE[ops->args[opcode][0]] + ARG_SIZE[ops->args[opcode][1]];
+}
+
+// end of the instruction at pc as the listing reads it, never past len
+static uint32_t dis_instruction_end(const dis_program_t *prg, uint32_t pc, uint32_t len) {
+    uint8_t opcode = prg->program[pc++];
+
+    if (opcode >= DIS_OP_END_OPCODES || prg->ops->removed[opcode])
+        return pc;
+
+    for (uint8_t n = 0; n < 2 && pc < len; n++) {
+        if (prg->ops->args[opcode][n] == DIS_ARG_STRING)
+            pc += dis_strnlen(prg->program + pc, len - pc) + 1;
+        else
+            pc += ARG_SIZE[prg->ops->args[opcode][n]];
+    }
+
+    return pc < len ? pc : len;
+}
+
+static void dis_render_section(dis_program_t **prg, uint32_t pc, uint32_t len, uint8_t spaces, bool is_function, options_t config) {
     uint8_t opcode = 0;
     uint16_t uint = 0;
     int32_t intg = 0;
@@ -342,17 +569,22 @@ static void dis_disassemble_section(dis_program_t **prg, uint32_t pc, uint32_t l
 
     // first 4 bytes of the program section within a function are actually specifying the parameter and return lists
     if (is_function) {
-        printf("\n");
+        fprintf(out, "\n");
         uint16_t args = readWord((*prg)->program, &pc);
         uint16_t rets = readWord((*prg)->program, &pc);
         if (!config.alt_format_flag) {
             SPC(spaces);
-            printf("| ");
+            fprintf(out, "| ");
+            if (config.hex_flag) {
+                fprintf(out, "%13s", "");
+                dis_print_hex((*prg)->program, pc - 4, pc);
+                fprintf(out, "( args: %d, rets: %d )", args, rets);
+            }
         } else
-            printf("    .comment args:%d, rets:%d", args, rets);
+            fprintf(out, "    .comment args:%d, rets:%d", args, rets);
     }
 
-    uint32_t pc_start = pc;
+    uint32_t pc_start = pc, released = pc;
 
     uint32_t labels_qty = 0;
     uint16_t *label_line = NULL;
@@ -372,32 +604,46 @@ static void dis_disassemble_section(dis_program_t **prg, uint32_t pc, uint32_t l
                 continue;
             }
 
-            if (opcode > DIS_OP_END_OPCODES)
+            // the listing shows these one byte at a time
+            if (opcode >= DIS_OP_END_OPCODES || pc + 1 + dis_operand_size((*prg)->ops, opcode) > len) {
+                ++pc;
                 continue;
+            }
 
             ++pc;
 
             S_OP(0, 0);
 
-            if (OP_ARGS[opcode][2]) {
+            if ((*prg)->ops->args[opcode][2]) {
                 label_line[labels_qty] = uint;
                 label_id[labels_qty] = jump_label++;
                 ++labels_qty;
             }
 
             S_OP(1, 0);
+
+            if (config.stream_flag && pc - released >= DIS_STREAM_WINDOW) {
+                dis_release(prg, released, pc);
+                released = pc;
+            }
         }
 
-        pc = pc_start;
+        pc = released = pc_start;
     }
 
     while (pc < len) {
+        uint32_t ins_pc = pc;
         opcode = (*prg)->program[pc];
 
+        if (config.stream_flag && pc - released >= DIS_STREAM_WINDOW) {
+            dis_release(prg, released, pc);
+            released = pc;
+        }
+
         if (config.alt_format_flag) {
             for (uint32_t lbl = 0; lbl < labels_qty; lbl++) {
                 if (pc - pc_start == label_line[lbl]) {
-                    printf("\nJL_%04d_:", label_id[lbl]);
+                    fprintf(out, "\nJL_%04d_:", label_id[lbl]);
                     break;
                 }
             }
@@ -408,27 +654,38 @@ static void dis_disassemble_section(dis_program_t **prg, uint32_t pc, uint32_t l
             continue;
         }
 
-        printf("\n");
+        if (profile != NULL)
+            dis_print_profile(ins_pc, spaces, config);
+
+        fprintf(out, "\n");
         if (!config.alt_format_flag) {
             SPC(spaces);
-            printf("| ");
-            printf("[%05d](%03d) ", (pc++) - pc_start, opcode);
+            fprintf(out, "| ");
+            fprintf(out, "[%05d](%03d) ", (pc++) - pc_start, opcode);
+            if (config.hex_flag)
+                dis_print_hex((*prg)->program, ins_pc, dis_instruction_end(*prg, ins_pc, len));
         } else {
-            printf("    ");
+            fprintf(out, "    ");
             pc++;
         }
 
-        dis_print_opcode(opcode);
+        dis_print_opcode((*prg)->ops, opcode);
 
-        if (opcode >= DIS_OP_END_OPCODES)
+        if (opcode >= DIS_OP_END_OPCODES || (*prg)->ops->removed[opcode])
             continue;
 
+        if (pc + dis_operand_size((*prg)->ops, opcode) > len) {
+            fprintf(out, " (truncated)");
+            pc = len;
+            continue;
+        }
+
         if (config.alt_format_flag) {
-            if (OP_ARGS[opcode][2]) {
+            if ((*prg)->ops->args[opcode][2]) {
                 uint = readWord((*prg)->program, &pc);
                 for (uint32_t lbl = 0; lbl < labels_qty; lbl++) {
                     if (uint == label_line[lbl]) {
-                        printf(" JL_%04d_", label_id[lbl]);
+                        fprintf(out, " JL_%04d_", label_id[lbl]);
                         break;
                     }
                 }
@@ -438,6 +695,12 @@ static void dis_disassemble_section(dis_program_t **prg, uint32_t pc, uint32_t l
             S_OP(0, 1);
 
         S_OP(1, 1);
+
+        if (profile != NULL && !config.alt_format_flag && profile->counts[ins_pc])
+            fprintf(out, "  ( hits: %llu, %.2f%% )", (unsigned long long) profile->counts[ins_pc], dis_profile_percent(profile, profile->counts[ins_pc]));
+
+        if (config.hex_flag && !config.alt_format_flag)
+            dis_print_hex_rest((*prg)->program, ins_pc, pc, spaces, "|              ", false);
     }
 
     if (config.alt_format_flag) {
@@ -445,41 +708,112 @@ static void dis_disassemble_section(dis_program_t **prg, uint32_t pc, uint32_t l
         free(label_id);
     }
 
+    // not in the bytecode, marked so the assembler can drop it again
     if (config.alt_format_flag && (*prg)->program[pc - 5] != DIS_OP_FN_RETURN)
-        printf("\n    FN_RETURN w(0)");
+        fprintf(out, "\n    .comment implicit return\n    FN_RETURN w(0)");
+}
+
+// code sections are the bulk of the output, they are served from the memo or the cache when enabled
+static void dis_disassemble_section(dis_program_t **prg, uint32_t pc, uint32_t len, uint8_t spaces, bool is_function, options_t config) {
+    FILE *sink = out;
+    uint8_t *data = NULL;
+    const uint8_t *resident;
+    uint32_t data_len = 0, label_base = jump_label, labels;
+    char *text = NULL;
+    size_t text_len = 0;
+
+    if ((config.cache_dir == NULL && config.memo == NULL) || profile != NULL) {
+        dis_render_section(prg, pc, len, spaces, is_function, config);
+        dis_release(prg, pc, len);
+        return;
+    }
+
+    // the implicit return check looks 5 bytes back, alt format labels continue the file numbering
+    uint32_t from = len >= 5 && len - 5 < pc ? len - 5 : pc;
+    uint64_t key = dis_cache_key((*prg)->program + from, len - from, config,
+            (uint64_t) (config.alt_format_flag ? label_base : 0) << 32 | (pc - from) << 16 | (*prg)->ops->id << 12 | spaces << 1 | is_function);
+
+    if (config.memo != NULL && !dis_memo_get(config.memo, key, &resident, &data_len)) {
+        memcpy(&labels, resident, 4);
+        fwrite(resident + 4, 1, data_len - 4, out);
+        jump_label += labels;
+        return;
+    }
+
+    if (config.cache_dir != NULL && !dis_cache_get(config.cache_dir, DIS_CACHE_SECTION, key, &data, &data_len) && data_len >= 4) {
+        memcpy(&labels, data, 4);
+        fwrite(data + 4, 1, data_len - 4, out);
+        jump_label += labels;
+        if (config.memo != NULL)
+            dis_memo_put(config.memo, key, data, data_len);
+        else
+            free(data);
+        return;
+    }
+    free(data);
+
+    out = open_memstream(&text, &text_len);
+    fwrite(&labels, 1, 4, out);
+    dis_render_section(prg, pc, len, spaces, is_function, config);
+    fclose(out);
+    out = sink;
+
+    labels = jump_label - label_base;
+    memcpy(text, &labels, 4);
+    fwrite(text + 4, 1, text_len - 4, out);
+    if (config.cache_dir != NULL)
+        dis_cache_put(config.cache_dir, DIS_CACHE_SECTION, key, (uint8_t*) text, text_len);
+    if (config.memo != NULL)
+        dis_memo_put(config.memo, key, (uint8_t*) text, text_len);
+    else
+        free(text);
 }
 
 #define LIT_ADD(a, b, c)  b[c] = a;  ++c;
-static void dis_read_interpreter_sections(dis_program_t **prg, uint32_t *pc, uint8_t spaces, char *tree, options_t config) {
+
+// "[index] " of a default format literal entry, followed by the first hex line of the entry
+static void dis_print_literal_index(dis_program_t **prg, uint32_t entry, int i, uint8_t spaces, options_t config) {
+    uint32_t size = 1;
+
+    SPC(spaces);
+    fprintf(out, "| | ");
+    fprintf(out, "[%05d] ", i);
+    if (config.hex_flag) {
+        dis_literal_size((*prg)->program, entry, (*prg)->len, &size);
+        dis_print_hex((*prg)->program, entry, entry + size);
+    }
+}
+
+// literal section up to its SECTION_END, alt format entries are returned instead of printed
+static char* dis_read_literals(dis_program_t **prg, uint32_t *pc, uint8_t spaces, options_t config, uint8_t *literal_type, uint32_t *literal_count_out) {
     uint32_t literal_count = 0;
-    uint8_t literal_type[65536];
     char *lit_str = NULL;
 
     const unsigned short literalCount = readWord((*prg)->program, pc);
 
     if(!config.group_flag)
-        printf("\n");
+        fprintf(out, "\n");
 
     if (!config.alt_format_flag) {
         SPC(spaces);
-        printf("| ");
-        printf("  ");
-        printf("--- ( Reading %d literals from cache ) ---\n", literalCount);
+        fprintf(out, "| ");
+        fprintf(out, "  ");
+        fprintf(out, "--- ( Reading %d literals from cache ) ---\n", literalCount);
     }
 
     if (config.alt_format_flag)
         lit_str = calloc(1, sizeof(char));
 
     for (int i = 0; i < literalCount; i++) {
+        uint32_t entry = *pc;
         const unsigned char literalType = readByte((*prg)->program, pc);
 
         switch (literalType) {
             case DIS_LITERAL_NULL:
                 LIT_ADD(DIS_LITERAL_NULL, literal_type, literal_count);
                 if (!config.alt_format_flag) {
-                    SPC(spaces);
-                    printf("| | ");
-                    printf("[%05d] ( null )\n", i);
+                    dis_print_literal_index(prg, entry, i, spaces, config);
+                    fprintf(out, "( null )\n");
                 } else {
                     str_append(&lit_str, "    .lit NULL\n");
                 }
@@ -490,9 +824,8 @@ static void dis_read_interpreter_sections(dis_program_t **prg, uint32_t *pc, uin
                 const bool b = readByte((*prg)->program, pc);
                 LIT_ADD(DIS_LITERAL_BOOLEAN, literal_type, literal_count);
                 if (!config.alt_format_flag) {
-                    SPC(spaces);
-                    printf("| | ");
-                    printf("[%05d] ( boolean %s )\n", i, b ? "true" : "false");
+                    dis_print_literal_index(prg, entry, i, spaces, config);
+                    fprintf(out, "( boolean %s )\n", b ? "true" : "false");
                 } else {
                     char bs[10];
                     sprintf(bs, "%s\n", b ? "true" : "false");
@@ -506,9 +839,8 @@ static void dis_read_interpreter_sections(dis_program_t **prg, uint32_t *pc, uin
                 const int d = readInt((*prg)->program, pc);
                 LIT_ADD(DIS_LITERAL_INTEGER, literal_type, literal_count);
                 if (!config.alt_format_flag) {
-                    SPC(spaces);
-                    printf("| | ");
-                    printf("[%05d] ( integer %d )\n", i, d);
+                    dis_print_literal_index(prg, entry, i, spaces, config);
+                    fprintf(out, "( integer %d )\n", d);
                 } else {
                     char ds[20];
                     sprintf(ds, "%d\n", d);
@@ -520,27 +852,28 @@ static void dis_read_interpreter_sections(dis_program_t **prg, uint32_t *pc, uin
 
             case DIS_LITERAL_FLOAT: {
                 const float f = readFloat((*prg)->program, pc);
+                char fs[64];
+                floatString(fs, f);
                 LIT_ADD(DIS_LITERAL_FLOAT, literal_type, literal_count);
                 if (!config.alt_format_flag) {
-                    SPC(spaces);
-                    printf("| | ");
-                    printf("[%05d] ( float %f )\n", i, f);
+                    dis_print_literal_index(prg, entry, i, spaces, config);
+                    fprintf(out, "( float %s )\n", fs);
                 } else {
-                    char fs[20];
-                    sprintf(fs, "%f\n", f);
                     str_append(&lit_str, "    .lit FLOAT ");
                     str_append(&lit_str, fs);
+                    str_append(&lit_str, "\n");
                 }
             }
                 break;
 
             case DIS_LITERAL_STRING: {
-                const char *s = readString((*prg)->program, pc);
+                uint32_t start = *pc;
+                const char *s = readString((*prg)->program, pc, (*prg)->len);
+                s = escapeString(s, *pc - start - 1, false);
                 LIT_ADD(DIS_LITERAL_STRING, literal_type, literal_count);
                 if (!config.alt_format_flag) {
-                    SPC(spaces);
-                    printf("| | ");
-                    printf("[%05d] ( string \"%s\" )\n", i, s);
+                    dis_print_literal_index(prg, entry, i, spaces, config);
+                    fprintf(out, "( string \"%s\" )\n", s);
                 } else {
                     str_append(&lit_str, "    .lit STRING \"");
                     str_append(&lit_str, s);
@@ -553,38 +886,38 @@ static void dis_read_interpreter_sections(dis_program_t **prg, uint32_t *pc, uin
             case DIS_LITERAL_ARRAY: {
                 unsigned short length = readWord((*prg)->program, pc);
                 if (!config.alt_format_flag) {
-                    SPC(spaces);
-                    printf("| | ");
-                    printf("[%05d] ( array ", i);
+                    dis_print_literal_index(prg, entry, i, spaces, config);
+                    fprintf(out, "( array ");
                 } else {
-                    str_append(&lit_str, "    .lit ARRAY ");
+                    str_append(&lit_str, literalType == DIS_LITERAL_ARRAY ? "    .lit ARRAY " : "    .lit ARRAY_INTERMEDIATE ");
                 }
 
                 for (int i = 0; i < length; i++) {
                     int index = readWord((*prg)->program, pc);
                     if (!config.alt_format_flag) {
-                        printf("%d ", index);
+                        fprintf(out, "%d ", index);
                     } else {
                         char ds[20];
                         sprintf(ds, "%d ", index);
                         str_append(&lit_str, ds);
 
                     }
-                    LIT_ADD(DIS_LITERAL_NULL, literal_type, literal_count);
                     if (!(i % 15) && i != 0) {
                         if (!config.alt_format_flag) {
-                            printf("\\\n");
+                            fprintf(out, "\\\n");
                             SPC(spaces);
-                            printf("| | ");
-                            printf("           ");
+                            fprintf(out, "| | ");
+                            if (config.hex_flag)
+                                fprintf(out, "%*s", 3 * DIS_HEX_COLUMN, "");
+                            fprintf(out, "           ");
                         } else {
                             str_append(&lit_str, "\\\n               ");
                         }
                     }
                 }
                 if (!config.alt_format_flag) {
-                    printf(")");
-                    printf("\n");
+                    fprintf(out, ")");
+                    fprintf(out, "\n");
                 } else {
                     str_append(&lit_str, "\n");
                 }
@@ -597,18 +930,17 @@ static void dis_read_interpreter_sections(dis_program_t **prg, uint32_t *pc, uin
             case DIS_LITERAL_DICTIONARY: {
                 unsigned short length = readWord((*prg)->program, pc);
                 if (!config.alt_format_flag) {
-                    SPC(spaces);
-                    printf("| | ");
-                    printf("[%05d] ( dictionary ", i);
+                    dis_print_literal_index(prg, entry, i, spaces, config);
+                    fprintf(out, "( dictionary ");
                 } else {
-                    str_append(&lit_str, "    .lit DICTIONARY ");
+                    str_append(&lit_str, literalType == DIS_LITERAL_DICTIONARY ? "    .lit DICTIONARY " : "    .lit DICTIONARY_INTERMEDIATE ");
                 }
                 for (int i = 0; i < length / 2; i++) {
                     int key = readWord((*prg)->program, pc);
                     int val = readWord((*prg)->program, pc);
 
                     if (!config.alt_format_flag)
-                        printf("(key: %d, val:%d) ", key, val);
+                        fprintf(out, "(key: %d, val:%d) ", key, val);
                     else {
                         char s[100];
                         sprintf(s, "%d,%d ", key, val);
@@ -617,18 +949,20 @@ static void dis_read_interpreter_sections(dis_program_t **prg, uint32_t *pc, uin
 
                     if (!(i % 5) && i != 0) {
                         if (!config.alt_format_flag) {
-                            printf("\\\n");
+                            fprintf(out, "\\\n");
                             SPC(spaces);
-                            printf("| | ");
-                            printf("                ");
+                            fprintf(out, "| | ");
+                            if (config.hex_flag)
+                                fprintf(out, "%*s", 3 * DIS_HEX_COLUMN, "");
+                            fprintf(out, "                ");
                         } else {
                             str_append(&lit_str, "\\\n                    ");
                         }
                     }
                 }
                 if (!config.alt_format_flag) {
-                    printf(")");
-                    printf("\n");
+                    fprintf(out, ")");
+                    fprintf(out, "\n");
                 } else {
                     str_append(&lit_str, "\n");
                 }
@@ -640,9 +974,8 @@ static void dis_read_interpreter_sections(dis_program_t **prg, uint32_t *pc, uin
                 unsigned short index = readWord((*prg)->program, pc);
                 LIT_ADD(DIS_LITERAL_FUNCTION_INTERMEDIATE, literal_type, literal_count);
                 if (!config.alt_format_flag) {
-                    SPC(spaces);
-                    printf("| | ");
-                    printf("[%05d] ( function index: %d )\n", i, index);
+                    dis_print_literal_index(prg, entry, i, spaces, config);
+                    fprintf(out, "( function index: %d )\n", index);
                 } else {
                     char s[100];
                     sprintf(s, "    .lit FUNCTION %d\n", index);
@@ -652,12 +985,13 @@ static void dis_read_interpreter_sections(dis_program_t **prg, uint32_t *pc, uin
                 break;
 
             case DIS_LITERAL_IDENTIFIER: {
-                const char *str = readString((*prg)->program, pc);
+                uint32_t start = *pc;
+                const char *str = readString((*prg)->program, pc, (*prg)->len);
+                str = escapeString(str, *pc - start - 1, true);
                 LIT_ADD(DIS_LITERAL_IDENTIFIER, literal_type, literal_count);
                 if (!config.alt_format_flag) {
-                    SPC(spaces);
-                    printf("| | ");
-                    printf("[%05d] ( identifier %s )\n", i, str);
+                    dis_print_literal_index(prg, entry, i, spaces, config);
+                    fprintf(out, "( identifier %s )\n", str);
                 } else {
                     str_append(&lit_str, "    .lit IDENTIFIER ");
                     str_append(&lit_str, str);
@@ -668,15 +1002,15 @@ static void dis_read_interpreter_sections(dis_program_t **prg, uint32_t *pc, uin
 
             case DIS_LITERAL_TYPE:
             case DIS_LITERAL_TYPE_INTERMEDIATE: {
+                const char *directive = literalType == DIS_LITERAL_TYPE ? "TYPE" : "TYPE_INTERMEDIATE";
                 uint8_t literalType = readByte((*prg)->program, pc);
                 uint8_t constant = readByte((*prg)->program, pc);
                 if (!config.alt_format_flag) {
-                    SPC(spaces);
-                    printf("| | ");
-                    printf("[%05d] ( type %s: %d)\n", i, (LIT_STR[literalType] + 12), constant);
+                    dis_print_literal_index(prg, entry, i, spaces, config);
+                    fprintf(out, "( type %s: %d)\n", literalName(literalType), constant);
                 } else {
                     char s[100];
-                    sprintf(s, "    .lit TYPE %s %d", (LIT_STR[literalType] + 12), constant);
+                    sprintf(s, "    .lit %s %s %d", directive, literalName(literalType), constant);
                     str_append(&lit_str, s);
                 }
 
@@ -684,8 +1018,8 @@ static void dis_read_interpreter_sections(dis_program_t **prg, uint32_t *pc, uin
                     uint16_t vt = readWord((*prg)->program, pc);
                     if (!config.alt_format_flag) {
                         SPC(spaces);
-                        printf("| | ");
-                        printf("\n          ( subtype: %d)\n", vt);
+                        fprintf(out, "| | ");
+                        fprintf(out, "\n          ( subtype: %d)\n", vt);
                     } else {
                         char s[100];
                         sprintf(s, " SUBTYPE %d\n", vt);
@@ -693,12 +1027,12 @@ static void dis_read_interpreter_sections(dis_program_t **prg, uint32_t *pc, uin
                     }
                 } else
                     if (literalType == DIS_LITERAL_DICTIONARY) {
-                        uint8_t kt = readWord((*prg)->program, pc);
-                        uint8_t vt = readWord((*prg)->program, pc);
+                        uint16_t kt = readWord((*prg)->program, pc);
+                        uint16_t vt = readWord((*prg)->program, pc);
                         if (!config.alt_format_flag) {
                             SPC(spaces);
-                            printf("| | ");
-                            printf("\n          ( subtype: [%d, %d] )\n\n\n", kt, vt);
+                            fprintf(out, "| | ");
+                            fprintf(out, "\n          ( subtype: [%d, %d] )\n\n\n", kt, vt);
                         } else {
                             char s[100];
                             sprintf(s, " SUBTYPE %d,%d\n", kt, vt);
@@ -706,43 +1040,63 @@ static void dis_read_interpreter_sections(dis_program_t **prg, uint32_t *pc, uin
                         }
                     } else {
                         if (!config.alt_format_flag)
-                            printf("\n");
+                            fprintf(out, "\n");
                         else
                             str_append(&lit_str, "\n");
                     }
 
-                LIT_ADD(literalType, literal_type, literal_count);
+                // one entry per cache literal: the function section pairs FUNCTION entries by ordinal
+                LIT_ADD(DIS_LITERAL_TYPE, literal_type, literal_count);
             }
                 break;
 
             case DIS_LITERAL_INDEX_BLANK:
                 LIT_ADD(DIS_LITERAL_INDEX_BLANK, literal_type, literal_count);
                 if (!config.alt_format_flag) {
-                    SPC(spaces);
-                    printf("| | ");
-                    printf("[%05d] ( blank )\n", i);
+                    dis_print_literal_index(prg, entry, i, spaces, config);
+                    fprintf(out, "( blank )\n");
                 } else {
                     str_append(&lit_str, "    .lit BLANK\n");
                 }
                 break;
         }
+
+        if (config.hex_flag && !config.alt_format_flag)
+            dis_print_hex_rest((*prg)->program, entry, *pc, spaces, "| |         ", true);
     }
 
+
+    *literal_count_out = literal_count;
+    return lit_str;
+}
+
+static void dis_read_interpreter_sections(dis_program_t **prg, uint32_t *pc, uint8_t spaces, char *tree, options_t config) {
+    uint32_t literal_count = 0;
+    uint8_t literal_type[65536];
+    uint32_t section_start = *pc;
+    char *lit_str = dis_read_literals(prg, pc, spaces, config, literal_type, &literal_count);
+
     if (!config.group_flag) {
-        printf(lit_str);
+        if (lit_str != NULL)
+            fputs(lit_str, out);
     } else {
         lit_t fn_str = (lit_t)(lit_fn_queue_rear->data);
-        fn_str->str = calloc(1, strlen(lit_str) + 1);
-        strcpy(fn_str->str, lit_str);
+        fn_str->pc = section_start;
+        fn_str->str = NULL;
+        if (!config.stream_flag) {
+            fn_str->str = calloc(1, strlen(lit_str) + 1);
+            strcpy(fn_str->str, lit_str);
+        }
     }
     free(lit_str);
+    dis_release(prg, section_start, *pc);
 
     consumeByte(DIS_OP_SECTION_END, (*prg)->program, pc);
 
     if (!config.alt_format_flag) {
         SPC(spaces);
-        printf("| ");
-        printf("--- ( end literal section ) ---\n");
+        fprintf(out, "| ");
+        fprintf(out, "--- ( end literal section ) ---\n");
     }
 
     int functionCount = readWord((*prg)->program, pc);
@@ -751,10 +1105,10 @@ static void dis_read_interpreter_sections(dis_program_t **prg, uint32_t *pc, uin
     if (functionCount) {
         if (!config.alt_format_flag) {
             SPC(spaces);
-            printf("|\n");
+            fprintf(out, "|\n");
             SPC(spaces);
-            printf("| ");
-            printf("--- ( fn count: %d, total size: %d ) ---\n", functionCount, functionSize);
+            fprintf(out, "| ");
+            fprintf(out, "--- ( fn count: %d, total size: %d ) ---\n", functionCount, functionSize);
         }
 
         uint32_t fcnt = 0;
@@ -771,22 +1125,22 @@ static void dis_read_interpreter_sections(dis_program_t **prg, uint32_t *pc, uin
                 if (!config.alt_format_flag) {
                     sprintf(tree_local, "%s.%d", tree, fcnt);
                     if (tree_local[0] == '_')
-                        memcpy(tree_local, tree_local + 1, strlen(tree_local));
+                        memmove(tree_local, tree_local + 1, strlen(tree_local));
                 } else {
                     sprintf(tree_local, "%s_%d", tree, fcnt);
                     if (tree_local[0] == '_')
-                        memcpy(tree_local, tree_local + 1, strlen(tree_local));
+                        memmove(tree_local, tree_local + 1, strlen(tree_local));
                 }
 
                 if (!config.alt_format_flag) {
                     SPC(spaces);
-                    printf("| |\n");
+                    fprintf(out, "| |\n");
                     SPC(spaces);
-                    printf("| | ");
-                    printf("( fun %s [ start: %d, end: %d ] )", tree_local, fpc_start, fpc_end);
+                    fprintf(out, "| | ");
+                    fprintf(out, "( fun %s [ start: %d, end: %d ] )", tree_local, fpc_start, fpc_end);
                 } else {
                     if (!config.group_flag)
-                        printf("\nLIT_FUN_%s:", tree_local);
+                        fprintf(out, "\nLIT_FUN_%s:", tree_local);
                     else {
                         lit_t new_lit = malloc(sizeof(struct lit_s));
                         new_lit->fun = calloc(1, strlen(tree_local) + 1);
@@ -795,8 +1149,8 @@ static void dis_read_interpreter_sections(dis_program_t **prg, uint32_t *pc, uin
                     }
                 }
 
-                if ((*prg)->program[*pc + size - 1] != DIS_OP_FN_END) {
-                    printf("\nERROR: Failed to find function end\n");
+                if (size == 0 || size > (*prg)->len - *pc || (*prg)->program[*pc + size - 1] != DIS_OP_FN_END) {
+                    fprintf(out, "\nERROR: Failed to find function end\n");
                     exit(1);
                 }
 
@@ -804,15 +1158,15 @@ static void dis_read_interpreter_sections(dis_program_t **prg, uint32_t *pc, uin
 
                 if (!config.alt_format_flag) {
                     SPC(spaces);
-                    printf("| | |\n");
+                    fprintf(out, "| | |\n");
                     SPC(spaces + 4);
-                    printf("| ");
-                    printf("--- ( reading code for %s ) ---", tree_local);
+                    fprintf(out, "| ");
+                    fprintf(out, "--- ( reading code for %s ) ---", tree_local);
                     dis_disassemble_section(prg, fpc_start, fpc_end, spaces + 4, true, config);
-                    printf("\n");
+                    fprintf(out, "\n");
                     SPC(spaces + 4);
-                    printf("| ");
-                    printf("--- ( end code section ) ---\n");
+                    fprintf(out, "| ");
+                    fprintf(out, "--- ( end code section ) ---\n");
                 } else {
                     fun_code_t *fun = malloc(sizeof(struct fun_code_s));
                     fun->fun = malloc(strlen(tree_local) + 1);
@@ -829,65 +1183,113 @@ static void dis_read_interpreter_sections(dis_program_t **prg, uint32_t *pc, uin
 
         if (!config.alt_format_flag) {
             SPC(spaces);
-            printf("|\n");
+            fprintf(out, "|\n");
             SPC(spaces);
-            printf("| ");
-            printf("--- ( end fn section ) ---\n");
+            fprintf(out, "| ");
+            fprintf(out, "--- ( end fn section ) ---\n");
         }
     }
 
     consumeByte(DIS_OP_SECTION_END, (*prg)->program, pc);
 }
 
+// group mode literal block, stream mode renders it again from the file instead of keeping it
+static void dis_print_group_literals(dis_program_t **prg, lit_t litf, char *function, options_t config) {
+    static uint8_t literal_type[65536];
+    uint32_t pc = litf->pc, literal_count;
+    char *lit_str = litf->str, *str;
+
+    if (lit_str == NULL) {
+        lit_str = dis_read_literals(prg, &pc, 0, config, literal_type, &literal_count);
+        dis_release(prg, litf->pc, pc);
+    }
+
+    str = str_replace_substr_all(lit_str, ".lit FUNCTION ", function);
+    fputs(str, out);
+    free(str);
+
+    if (lit_str != litf->str)
+        free(lit_str);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
-void disassemble(const char *filename, options_t config) {
-    dis_program_t *prg;
+// everything after the "File:" line, prg is released by the caller
+static void dis_disassemble_program(dis_program_t *prg, options_t config) {
+    FILE *sink = out;
+    dis_profile_t prof;
+    uint8_t *data = NULL;
+    uint32_t data_len = 0;
+    uint64_t key = 0;
+    char *text = NULL;
+    size_t text_len = 0;
 
     jump_label = 0;
+    read_end = prg->len;
 
-    dis_disassembler_init(&prg);
-    if (dis_load_file(filename, &prg, config.alt_format_flag)) {
-        dis_disassembler_deinit(&prg);
-        exit(1);
+    if (config.profile != NULL) {
+        if (dis_profile_load(config.profile, prg->program, prg->len, &prof)) {
+            fprintf(stderr, "%s: not able to load the profile\n", config.profile);
+            exit(1);
+        }
+        profile = &prof;
+
+        // annotated listings depend on the profile, they are never cached
+        config.cache_dir = NULL;
+    }
+
+    // a cached listing is built in memory first, streaming would hold the whole output
+    if (config.stream_flag)
+        config.cache_dir = NULL;
+
+    // the "File:" line names the input, everything after it only depends on its bytes
+    if (config.cache_dir != NULL) {
+        key = dis_cache_key(prg->program, prg->len, config, 0);
+        if (!dis_cache_get(config.cache_dir, DIS_CACHE_FILE, key, &data, &data_len)) {
+            fwrite(data, 1, data_len, out);
+            free(data);
+            return;
+        }
+
+        out = open_memstream(&text, &text_len);
     }
 
     dis_read_header(&prg, config.alt_format_flag);
 
-    printf("\n.start MAIN\n");
+    fprintf(out, "\n.start MAIN\n");
 
     consumeByte(DIS_OP_SECTION_END, prg->program, &(prg->pc));
 
     if (!config.group_flag) {
         if (config.alt_format_flag)
-            printf("\nLIT_MAIN:");
+            fprintf(out, "\nLIT_MAIN:");
 
         dis_read_interpreter_sections(&prg, &(prg->pc), 0, "", config);
 
         if (!config.alt_format_flag) {
-            printf("|\n| ");
-            printf("--- ( reading main code ) ---");
+            fprintf(out, "|\n| ");
+            fprintf(out, "--- ( reading main code ) ---");
         } else
-            printf("\nMAIN:");
+            fprintf(out, "\nMAIN:");
 
         dis_disassemble_section(&prg, prg->pc, prg->len, 0, false, config);
 
         if (!config.alt_format_flag) {
-            printf("\n| ");
-            printf("--- ( end main code section ) ---");
+            fprintf(out, "\n| ");
+            fprintf(out, "--- ( end main code section ) ---");
         } else
-            printf("\n");
+            fprintf(out, "\n");
 
         if (config.alt_format_flag) {
             while (function_queue_front != NULL) {
                 fun_code_t *fun = (fun_code_t*) function_queue_front->data;
-                printf("\nFUN_%s:", fun->fun);
+                fprintf(out, "\nFUN_%s:", fun->fun);
                 free(fun->fun);
 
                 dis_disassemble_section(&prg, fun->start, fun->len, 0, true, config);
 
                 dis_dequeue(&function_queue_front, &function_queue_rear, &function_queue_len);
-                printf("\n");
+                fprintf(out, "\n");
             }
         }
     } else {
@@ -899,27 +1301,27 @@ void disassemble(const char *filename, options_t config) {
         dis_enqueue((void*) new_lit, &lit_fn_queue_front, &lit_fn_queue_rear, &lit_fn_queue_len);
 
         dis_read_interpreter_sections(&prg, &(prg->pc), 0, "", config);
-        printf("\n");
+        fprintf(out, "\n");
 
         while (lit_fn_queue_front != NULL) {
             lit_t litf = (lit_t) lit_fn_queue_front->data;
 
             if (!strcmp(litf->fun, "MAIN")) {
-                printf("MAIN:\n");
-                printf("%s", str_replace_substr_all(litf->str, ".lit FUNCTION ", ".lit FUNCTION (code=FUN_) "));
+                fprintf(out, "MAIN:\n");
+                dis_print_group_literals(&prg, litf, ".lit FUNCTION (code=FUN_) ", config);
 
                 dis_disassemble_section(&prg, prg->pc, prg->len, 0, false, config);
                 free(litf->fun);
                 free(litf->str);
                 dis_dequeue(&lit_fn_queue_front, &lit_fn_queue_rear, &lit_fn_queue_len);
-                printf("\n\n");
+                fprintf(out, "\n\n");
                 continue;
             }
 
-            printf("FUN_%s:\n", litf->fun);
-            char sbtr[strlen(litf->fun) +  19];
+            fprintf(out, "FUN_%s:\n", litf->fun);
+            char sbtr[strlen(litf->fun) + sizeof(".lit FUNCTION (code=FUN__) ")];
             sprintf(sbtr, ".lit FUNCTION (code=FUN_%s_) ", litf->fun);
-            printf("%s", str_replace_substr_all(litf->str, ".lit FUNCTION ", sbtr));
+            dis_print_group_literals(&prg, litf, sbtr, config);
 
             queue_node_t *fqf = function_queue_front;
             while (fqf != NULL) {
@@ -935,7 +1337,7 @@ void disassemble(const char *filename, options_t config) {
             free(litf->str);
             dis_dequeue(&lit_fn_queue_front, &lit_fn_queue_rear, &lit_fn_queue_len);
 
-            printf("\n\n");
+            fprintf(out, "\n\n");
         }
 
         while (function_queue_front != NULL) {
@@ -944,6 +1346,81 @@ void disassemble(const char *filename, options_t config) {
         }
     }
 
-    printf("\n");
+    fprintf(out, "\n");
+
+    if (profile != NULL) {
+        dis_profile_summary(profile, out);
+        dis_profile_free(profile);
+        profile = NULL;
+    }
+
+    if (config.cache_dir != NULL) {
+        fclose(out);
+        out = sink;
+        fwrite(text, 1, text_len, out);
+        dis_cache_put(config.cache_dir, DIS_CACHE_FILE, key, (uint8_t*) text, text_len);
+        free(text);
+    }
+}
+
+void disassemble(const char *filename, options_t config) {
+    dis_program_t *prg;
+    dis_index_t idx;
+
+    out = stdout;
+
+    dis_disassembler_init(&prg);
+    if (config.stream_flag ? dis_map_file(filename, &prg) : dis_load_file(filename, &prg)) {
+        dis_disassembler_deinit(&prg);
+        exit(1);
+    }
+
+    if (prg->len >= 1 && dis_opset_select(prg->program[0]) == NULL) {
+        fprintf(stderr, "%s: unsupported bytecode version %d\n", filename, prg->program[0]);
+        dis_disassembler_deinit(&prg);
+        exit(1);
+    }
+
+    // malformed files are refused up front like batch and daemon mode do; stream mode can't
+    // afford indexing the whole file, there the bounded readers stop at the first bad size
+    if (!config.stream_flag && dis_index_build(prg->program, prg->len, &idx)) {
+        fprintf(stderr, "%s: not able to decode the file\n", filename);
+        dis_index_free(&idx);
+        dis_disassembler_deinit(&prg);
+        exit(1);
+    }
+    if (!config.stream_flag)
+        dis_index_free(&idx);
+
+    dis_print_file(filename, prg->len, config.alt_format_flag);
+    dis_disassemble_program(prg, config);
     dis_disassembler_deinit(&prg);
 }
+
+// same listing as disassemble() for a program already in memory, printed to stream; the
+// listing only reads the program, it is rendered in place
+void disassemble_buffer(const char *name, const uint8_t *program, uint32_t len, options_t config, FILE *stream) {
+    struct dis_program_s buffer = { (uint8_t*) program, len, 0, false, dis_opset_latest() };
+
+    out = stream;
+
+    dis_print_file(name, len, config.alt_format_flag);
+    dis_disassemble_program(&buffer, config);
+
+    out = stdout;
+}
+
+// one code section (from the args/rets words for functions) with labels numbered from 0
+void disassemble_section(const uint8_t *program, uint32_t len, uint32_t start, uint32_t end, bool is_function, options_t config, FILE *stream) {
+    struct dis_program_s section = { (uint8_t*) program, len, start, false, dis_opset_header(program, len) };
+    dis_program_t *prg = &section;
+
+    out = stream;
+    jump_label = 0;
+    read_end = len;
+    config.cache_dir = NULL;
+
+    dis_disassemble_section(&prg, start, end, 0, is_function, config);
+
+    out = stdout;
+}
@@ -10,9 +10,18 @@
 #ifndef DISASSEMBLER_H_
 #define DISASSEMBLER_H_
 
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
 typedef struct options_s {
     bool alt_format_flag;
     bool group_flag;
+    const char *cache_dir; // NULL disables the disassembly cache
+    const char *profile;   // execution counts to annotate the listing with, NULL if none
+    bool stream_flag;      // map the input and release it behind the output, no whole file buffers
+    bool hex_flag;         // raw bytes of every instruction and literal entry next to it (default format)
+    struct dis_memo_s *memo; // resident code sections of the previous render, NULL if none
 } options_t;
 
 typedef enum DIS_OPCODES {
@@ -128,6 +137,24 @@ typedef enum DIS_LITERAL_TYPE {
     DIS_LITERAL_INDEX_BLANK,             // for blank indexing i.e. arr[:]
 } dis_literal_type_t;
 
+typedef enum DIS_ARG_TYPE {
+    DIS_ARG_NONE,    //
+    DIS_ARG_BYTE,    //
+    DIS_ARG_WORD,    //
+    DIS_ARG_INTEGER, //
+    DIS_ARG_FLOAT,   //
+    DIS_ARG_STRING   //
+} dis_arg_type_t;
+
+extern const char *OP_STR[];
+extern const char *LIT_STR[];
+extern const uint8_t OP_ARGS[DIS_OP_END_OPCODES][3];
+
+#define DIS_STACK_VARIABLE -1
+extern const int8_t OP_STACK[DIS_OP_END_OPCODES][2];
+
 extern void disassemble(const char *filename, options_t config);
+extern void disassemble_buffer(const char *name, const uint8_t *program, uint32_t len, options_t config, FILE *stream);
+extern void disassemble_section(const uint8_t *program, uint32_t len, uint32_t start, uint32_t end, bool is_function, options_t config, FILE *stream);
 
 #endif /* DISASSEMBLER_H_ */
@@ -0,0 +1,328 @@
+/*
+ * disassembler_batch.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Three threads connected by bounded single producer/single consumer rings:
+ *
+ *     reader    reads groups of files through io_uring where available, otherwise maps each
+ *               file with MAP_POPULATE, so the page cache is filled ahead of use
+ *     renderer  validates and renders it into a memory buffer (the listing code keeps file
+ *               scope state, so there is exactly one renderer)
+ *     writer    sends every rendered buffer that is ready with a single writev
+ *
+ * A NULL item closes a ring. Output keeps the order of the input files. Items move through
+ * the rings without locks, a stage only takes the ring lock to sleep when its ring is full
+ * or empty, and to wake the other side.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include "disassembler_utils.h"
+#include "disassembler_index.h"
+#include "disassembler_uring.h"
+#include "disassembler_batch.h"
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+typedef struct batch_item_s {
+    char *name;         //
+    uint8_t *data;      // file contents
+    uint32_t len;       //
+    bool mapped;        // data is a mapping, not a heap buffer
+    char *text;         // rendered listing
+    size_t text_len;    //
+    const char *error;  // reported by the writer, in order
+} batch_item_t;
+
+typedef struct batch_ring_s {
+    batch_item_t *items[DIS_BATCH_QUEUE];
+    _Atomic uint32_t head; // next to pop, written by the consumer only
+    _Atomic uint32_t tail; // next to push, written by the producer only
+    pthread_mutex_t lock;  // only for sleeping and waking
+    pthread_cond_t moved;  // head or tail changed
+} batch_ring_t;
+
+typedef struct batch_s {
+    char **files;
+    uint32_t file_count;
+    options_t config;
+    batch_ring_t read;     // reader -> renderer
+    batch_ring_t rendered; // renderer -> writer
+    uint8_t failed;
+} batch_t;
+
+static void ring_init(batch_ring_t *ring) {
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->moved, NULL);
+}
+
+static void ring_destroy(batch_ring_t *ring) {
+    pthread_mutex_destroy(&ring->lock);
+    pthread_cond_destroy(&ring->moved);
+}
+
+// the other side checks and sleeps under the lock, so taking it here can't miss a sleeper
+static void ring_wake(batch_ring_t *ring) {
+    pthread_mutex_lock(&ring->lock);
+    pthread_cond_signal(&ring->moved);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+static void ring_push(batch_ring_t *ring, batch_item_t *item) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    if (tail - atomic_load_explicit(&ring->head, memory_order_acquire) == DIS_BATCH_QUEUE) {
+        pthread_mutex_lock(&ring->lock);
+        while (tail - atomic_load_explicit(&ring->head, memory_order_acquire) == DIS_BATCH_QUEUE)
+            pthread_cond_wait(&ring->moved, &ring->lock);
+        pthread_mutex_unlock(&ring->lock);
+    }
+
+    ring->items[tail & (DIS_BATCH_QUEUE - 1)] = item;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    ring_wake(ring);
+}
+
+// 0 if the ring is empty
+static uint8_t ring_try_pop(batch_ring_t *ring, batch_item_t **item) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    if (head == atomic_load_explicit(&ring->tail, memory_order_acquire))
+        return 0;
+
+    *item = ring->items[head & (DIS_BATCH_QUEUE - 1)];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    ring_wake(ring);
+    return 1;
+}
+
+static batch_item_t* ring_pop(batch_ring_t *ring) {
+    batch_item_t *item;
+
+    if (ring_try_pop(ring, &item))
+        return item;
+
+    pthread_mutex_lock(&ring->lock);
+    while (atomic_load_explicit(&ring->head, memory_order_relaxed) == atomic_load_explicit(&ring->tail, memory_order_acquire))
+        pthread_cond_wait(&ring->moved, &ring->lock);
+    pthread_mutex_unlock(&ring->lock);
+
+    ring_try_pop(ring, &item);
+    return item;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// a whole group of files per io_uring round trip, files it could not read fall back to stdio
+static uint8_t batch_reader_uring(batch_t *b) {
+    dis_uring_t *ring = dis_uring_open();
+    uint8_t *data[DIS_URING_FILES];
+    uint32_t len[DIS_URING_FILES];
+
+    if (ring == NULL)
+        return 1;
+
+    for (uint32_t base = 0; base < b->file_count; base += DIS_URING_FILES) {
+        uint32_t n = b->file_count - base < DIS_URING_FILES ? b->file_count - base : DIS_URING_FILES;
+
+        dis_uring_read_files(ring, &b->files[base], n, data, len);
+
+        for (uint32_t i = 0; i < n; i++) {
+            batch_item_t *item = calloc(1, sizeof(batch_item_t));
+
+            item->name = b->files[base + i];
+            item->data = data[i];
+            item->len = len[i];
+
+            if (item->data == NULL && (dis_read_file(item->name, &item->data, &item->len) || !item->len))
+                item->error = "not able to read the file";
+
+            ring_push(&b->read, item);
+        }
+    }
+
+    dis_uring_close(ring);
+    return 0;
+}
+
+static void* batch_reader(void *arg) {
+    batch_t *b = arg;
+
+    if (!batch_reader_uring(b)) {
+        ring_push(&b->read, NULL);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < b->file_count; i++) {
+        batch_item_t *item = calloc(1, sizeof(batch_item_t));
+        struct stat st;
+        int fd;
+
+        item->name = b->files[i];
+
+        fd = open(item->name, O_RDONLY);
+        if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0 || st.st_size > UINT32_MAX) {
+            item->error = "not able to read the file";
+            if (fd >= 0)
+                close(fd);
+            ring_push(&b->read, item);
+            continue;
+        }
+
+        item->data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        close(fd);
+
+        if (item->data == MAP_FAILED) {
+            item->data = NULL;
+            item->error = "not able to map the file";
+        } else {
+            item->len = st.st_size;
+            item->mapped = true;
+        }
+
+        ring_push(&b->read, item);
+    }
+
+    ring_push(&b->read, NULL);
+    return NULL;
+}
+
+static void* batch_renderer(void *arg) {
+    batch_t *b = arg;
+    batch_item_t *item;
+
+    while ((item = ring_pop(&b->read)) != NULL) {
+        if (item->error == NULL) {
+            dis_index_t idx;
+
+            // the listing code exits on malformed input, one bad file must not end the batch
+            if (dis_index_build(item->data, item->len, &idx))
+                item->error = "not able to decode the file";
+            else {
+                FILE *stream = open_memstream(&item->text, &item->text_len);
+                disassemble_buffer(item->name, item->data, item->len, b->config, stream);
+                fclose(stream);
+            }
+            dis_index_free(&idx);
+        }
+
+        if (item->mapped)
+            munmap(item->data, item->len);
+        else
+            free(item->data);
+        item->data = NULL;
+
+        ring_push(&b->rendered, item);
+    }
+
+    ring_push(&b->rendered, NULL);
+    return NULL;
+}
+
+static void batch_free_item(batch_item_t *item) {
+    free(item->text);
+    free(item->name);
+    free(item);
+}
+
+static uint8_t batch_writev(struct iovec *iov, int count) {
+    while (count) {
+        ssize_t w = writev(STDOUT_FILENO, iov, count);
+
+        if (w < 0)
+            return 1;
+
+        // drop what went out, partial writes resume mid buffer
+        while (count && (size_t) w >= iov->iov_len) {
+            w -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count) {
+            iov->iov_base = (char*) iov->iov_base + w;
+            iov->iov_len -= w;
+        }
+    }
+
+    return 0;
+}
+
+static void batch_writer(batch_t *b) {
+    batch_item_t *pending[IOV_MAX];
+    struct iovec iov[IOV_MAX];
+    uint8_t done = 0;
+
+    while (!done) {
+        int count = 0;
+
+        // block for one, then take whatever else is ready
+        pending[count] = ring_pop(&b->rendered);
+        do {
+            if (pending[count] == NULL) {
+                done = 1;
+                break;
+            }
+
+            if (pending[count]->error != NULL) {
+                fprintf(stderr, "%s: %s\n", pending[count]->name, pending[count]->error);
+                b->failed = 1;
+                batch_free_item(pending[count]);
+                continue;
+            }
+
+            iov[count].iov_base = pending[count]->text;
+            iov[count].iov_len = pending[count]->text_len;
+            ++count;
+        } while (count < IOV_MAX && ring_try_pop(&b->rendered, &pending[count]));
+
+        if (batch_writev(iov, count))
+            b->failed = 1;
+
+        for (int i = 0; i < count; i++)
+            batch_free_item(pending[i]);
+    }
+}
+
+uint8_t dis_batch(char **paths, uint32_t path_count, options_t config) {
+    batch_t *b = calloc(1, sizeof(batch_t));
+    pthread_t reader, renderer;
+    uint8_t failed;
+
+    for (uint32_t i = 0; i < path_count; i++)
+        dis_collect_files(paths[i], ".tb", &b->files, &b->file_count);
+    b->config = config;
+    ring_init(&b->read);
+    ring_init(&b->rendered);
+
+    fflush(stdout);
+
+    if (pthread_create(&reader, NULL, batch_reader, b) || pthread_create(&renderer, NULL, batch_renderer, b)) {
+        fprintf(stderr, "not able to start the batch threads\n");
+        exit(1);
+    }
+
+    batch_writer(b);
+
+    pthread_join(reader, NULL);
+    pthread_join(renderer, NULL);
+
+    failed = b->failed;
+    ring_destroy(&b->read);
+    ring_destroy(&b->rendered);
+    free(b->files);
+    free(b);
+    return failed;
+}
@@ -0,0 +1,20 @@
+/*
+ * disassembler_batch.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Batch disassembly of many files: read, render and write run as pipelined stages.
+ */
+
+#ifndef DISASSEMBLER_BATCH_H_
+#define DISASSEMBLER_BATCH_H_
+
+#include <stdint.h>
+
+#include "disassembler.h"
+
+#define DIS_BATCH_QUEUE 16 // files in flight between two stages, power of two
+
+uint8_t dis_batch(char **paths, uint32_t path_count, options_t config);
+
+#endif /* DISASSEMBLER_BATCH_H_ */
@@ -0,0 +1,1049 @@
+/*
+ * disassembler_browse.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * The file is mapped and opened with dis_index_open, which reads the MAIN literal cache and
+ * steps over every child with its size word, so nothing else is touched until asked for. The
+ * rows of an expanded function are its literals, its children and then its code. Literals
+ * and code are cut into pages of BRW_PAGE rows: a literal page is found by index, a code page
+ * by the start offsets of the pages before it, which are kept once found. Rendered pages stay
+ * cached until BRW_CACHE_BYTES is used, then the least recently drawn ones are dropped and
+ * rendered again when they scroll back into view. Search walks the tree in the same order,
+ * scanning functions as it goes, without rendering anything.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "disassembler_utils.h"
+#include "disassembler_string.h"
+#include "disassembler_index.h"
+#include "disassembler_browse.h"
+
+#define BRW_PAGE        256        // literals or instructions per rendered page
+#define BRW_CACHE_BYTES (32 << 20) // rendered pages kept before the least recently drawn go
+#define BRW_LINE_MAX    512        //
+#define BRW_QUERY_MAX   128        //
+
+enum {
+    BRW_KEY_NONE = 0,
+    BRW_KEY_UP = 256,
+    BRW_KEY_DOWN,
+    BRW_KEY_LEFT,
+    BRW_KEY_RIGHT,
+    BRW_KEY_PGUP,
+    BRW_KEY_PGDN,
+    BRW_KEY_HOME,
+    BRW_KEY_END,
+};
+
+typedef struct brw_page_s {
+    dis_buffer_t text;          // NUL terminated lines
+    uint32_t line[BRW_PAGE];    // start of each line in text
+    uint32_t offset[BRW_PAGE];  // bytecode offset of each line
+    uint32_t lines;             //
+    uint64_t used;              // frame it was last drawn in
+} brw_page_t;
+
+typedef struct brw_node_s {
+    bool ready;                 // children and literal pages set up
+    bool bad;                   // sections failed to decode, never expanded
+    bool expanded;              //
+    uint32_t first_child;       // children are appended together when a function is scanned
+    uint32_t child_count;       //
+    brw_page_t **lits;          // literal pages, NULL until rendered
+    brw_page_t **code;          // code pages, NULL until rendered
+    uint32_t *code_start;       // first instruction of each known code page, one more for the end
+    uint32_t code_pages;        // code pages with a known start and end
+    uint32_t code_capacity;     //
+    uint32_t code_last;         // rows of the last code page once code_done
+    bool code_done;             // every code page is known
+} brw_node_t;
+
+typedef struct brw_pos_s {
+    uint32_t fn;
+    int64_t row; // -1 for the function row, literals from 0, code from literal_count
+} brw_pos_t;
+
+typedef struct brw_s {
+    const char *filename;
+    uint8_t *program;
+    uint32_t len;
+    bool mapped;
+    dis_index_t idx;
+    brw_node_t *nodes;
+    uint32_t node_capacity;
+    uint64_t cached;            // bytes held by rendered pages
+    uint64_t frame;             //
+    brw_pos_t top;              // first row on screen
+    brw_pos_t cur;              //
+    uint32_t cur_row;           // screen row of cur
+    uint32_t width;             //
+    uint32_t height;            // rows, the status line included
+    char query[BRW_QUERY_MAX];  //
+    char message[BRW_LINE_MAX / 2]; // shown in the status line until the next key
+} brw_t;
+
+static struct termios brw_saved;
+
+static void brw_winch(int sig) {
+    (void) sig;
+}
+
+static brw_pos_t brw_pos(uint32_t fn, int64_t row) {
+    return (brw_pos_t) { fn, row };
+}
+
+static int64_t brw_lits(const brw_t *b, uint32_t fn) {
+    return b->idx.functions[fn].literal_count;
+}
+
+static uint32_t brw_lit_pages(const brw_t *b, uint32_t fn) {
+    return ((uint32_t) b->idx.functions[fn].literal_count + BRW_PAGE - 1) / BRW_PAGE;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void brw_sync(brw_t *b) {
+    uint32_t old = b->node_capacity;
+
+    if (b->idx.function_count <= old)
+        return;
+
+    b->node_capacity = b->idx.function_capacity;
+    b->nodes = realloc(b->nodes, b->node_capacity * sizeof(brw_node_t));
+    memset(b->nodes + old, 0, (b->node_capacity - old) * sizeof(brw_node_t));
+}
+
+static void brw_ready(brw_t *b, uint32_t fn, uint32_t first_child) {
+    const dis_function_t *f = &b->idx.functions[fn];
+    brw_node_t *n = &b->nodes[fn];
+
+    n->first_child = first_child;
+    n->child_count = b->idx.function_count - first_child;
+    n->lits = calloc(brw_lit_pages(b, fn) + 1, sizeof(brw_page_t*));
+    n->code_capacity = 16;
+    n->code_start = malloc((n->code_capacity + 1) * sizeof(uint32_t));
+    n->code = calloc(n->code_capacity, sizeof(brw_page_t*));
+    n->code_start[0] = f->code_start;
+    n->code_done = f->code_start >= f->code_end;
+    n->ready = true;
+}
+
+// reads the sections of fn, 1 if they are malformed
+static uint8_t brw_scan(brw_t *b, uint32_t fn) {
+    uint32_t before = b->idx.function_count;
+
+    if (b->nodes[fn].ready || b->nodes[fn].bad)
+        return b->nodes[fn].bad;
+
+    if (dis_index_expand(&b->idx, fn)) {
+        brw_sync(b);
+        b->nodes[fn].bad = true;
+        return 1;
+    }
+
+    brw_sync(b);
+    brw_ready(b, fn, before);
+    return 0;
+}
+
+// instructions of code page p, a byte that doesn't decode stands alone and is flagged in bad
+static uint32_t brw_decode_page(const brw_t *b, uint32_t fn, uint32_t p, dis_instruction_t *ins, bool *bad) {
+    const dis_function_t *f = &b->idx.functions[fn];
+    uint32_t count = 0;
+
+    for (uint32_t pc = b->nodes[fn].code_start[p]; pc < f->code_end && count < BRW_PAGE; pc += ins[count++].size) {
+        bool failed = b->idx.ops->decode(b->program, pc, f->code_end, &ins[count]);
+
+        if (failed) {
+            ins[count].offset = pc;
+            ins[count].opcode = b->program[pc];
+            ins[count].size = 1;
+        }
+        if (bad != NULL)
+            bad[count] = failed;
+    }
+
+    return count;
+}
+
+// finds the code pages of fn up to p, false if the code ends before it
+static bool brw_code_page(brw_t *b, uint32_t fn, uint64_t p) {
+    brw_node_t *n = &b->nodes[fn];
+    dis_instruction_t ins[BRW_PAGE];
+
+    while (n->code_pages <= p && !n->code_done) {
+        uint32_t count = brw_decode_page(b, fn, n->code_pages, ins, NULL);
+        uint32_t end = ins[count - 1].offset + ins[count - 1].size;
+
+        if (n->code_pages == n->code_capacity) {
+            n->code_capacity *= 2;
+            n->code_start = realloc(n->code_start, (n->code_capacity + 1) * sizeof(uint32_t));
+            n->code = realloc(n->code, n->code_capacity * sizeof(brw_page_t*));
+            memset(n->code + n->code_pages, 0, (n->code_capacity - n->code_pages) * sizeof(brw_page_t*));
+        }
+
+        n->code_start[++n->code_pages] = end;
+        if (end >= b->idx.functions[fn].code_end) {
+            n->code_done = true;
+            n->code_last = count;
+        }
+    }
+
+    return p < n->code_pages;
+}
+
+// code row r (counted from the first instruction) of fn exists
+static bool brw_code_row(brw_t *b, uint32_t fn, uint64_t r) {
+    brw_node_t *n = &b->nodes[fn];
+    uint64_t p = r / BRW_PAGE;
+
+    if (!brw_code_page(b, fn, p))
+        return false;
+
+    return !n->code_done || p + 1 < n->code_pages || r % BRW_PAGE < n->code_last;
+}
+
+// last code row of fn, -1 without code
+static int64_t brw_code_end(brw_t *b, uint32_t fn) {
+    brw_node_t *n = &b->nodes[fn];
+
+    brw_code_page(b, fn, UINT64_MAX);
+    return n->code_pages ? (int64_t) (n->code_pages - 1) * BRW_PAGE + n->code_last - 1 : -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the row after the subtree of fn: its next sibling, or the code of the closest ancestor with more
+static bool brw_climb(brw_t *b, uint32_t fn, brw_pos_t *pos) {
+    for (int32_t parent = b->idx.functions[fn].parent; parent >= 0; fn = parent, parent = b->idx.functions[fn].parent) {
+        const brw_node_t *p = &b->nodes[parent];
+
+        if (fn + 1 < p->first_child + p->child_count) {
+            *pos = brw_pos(fn + 1, -1);
+            return true;
+        }
+
+        if (brw_code_row(b, parent, 0)) {
+            *pos = brw_pos(parent, brw_lits(b, parent));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool brw_next(brw_t *b, brw_pos_t *pos) {
+    const brw_node_t *n = &b->nodes[pos->fn];
+    int64_t lits = brw_lits(b, pos->fn);
+
+    if (pos->row >= lits) {
+        if (!brw_code_row(b, pos->fn, pos->row - lits + 1))
+            return brw_climb(b, pos->fn, pos);
+        ++pos->row;
+        return true;
+    }
+
+    if (!n->expanded)
+        return brw_climb(b, pos->fn, pos);
+
+    if (pos->row + 1 < lits) {
+        ++pos->row;
+        return true;
+    }
+
+    if (n->child_count) {
+        *pos = brw_pos(n->first_child, -1);
+        return true;
+    }
+
+    if (brw_code_row(b, pos->fn, 0)) {
+        pos->row = lits;
+        return true;
+    }
+
+    return brw_climb(b, pos->fn, pos);
+}
+
+// last row shown for the subtree of fn
+static brw_pos_t brw_last(brw_t *b, uint32_t fn) {
+    for (;;) {
+        const brw_node_t *n = &b->nodes[fn];
+        int64_t code;
+
+        if (!n->expanded)
+            return brw_pos(fn, -1);
+
+        code = brw_code_end(b, fn);
+        if (code >= 0)
+            return brw_pos(fn, brw_lits(b, fn) + code);
+
+        if (!n->child_count)
+            return brw_pos(fn, brw_lits(b, fn) - 1);
+
+        fn = n->first_child + n->child_count - 1;
+    }
+}
+
+static bool brw_prev(brw_t *b, brw_pos_t *pos) {
+    const brw_node_t *n = &b->nodes[pos->fn];
+    int64_t lits = brw_lits(b, pos->fn);
+    int32_t parent = b->idx.functions[pos->fn].parent;
+
+    // the first code row follows the children
+    if (pos->row == lits && n->child_count) {
+        *pos = brw_last(b, n->first_child + n->child_count - 1);
+        return true;
+    }
+
+    if (pos->row >= 0) {
+        --pos->row;
+        return true;
+    }
+
+    if (parent < 0)
+        return false;
+
+    if (pos->fn == b->nodes[parent].first_child)
+        *pos = brw_pos(parent, brw_lits(b, parent) - 1);
+    else
+        *pos = brw_last(b, pos->fn - 1);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void brw_line(brw_page_t *page, uint32_t offset, const char *line) {
+    page->line[page->lines] = page->text.len;
+    page->offset[page->lines++] = offset;
+    dis_buffer_append(&page->text, line, strlen(line) + 1);
+}
+
+// literal text without the type name when dis_index_literal_str repeats it
+static void brw_literal_str(const brw_t *b, uint32_t fn, uint32_t l, char *s, uint32_t size) {
+    const dis_function_t *f = &b->idx.functions[fn];
+    uint8_t type = f->literals[l].type;
+    const char *name = type <= DIS_LITERAL_INDEX_BLANK ? LIT_STR[type] + 12 : "?";
+    char value[BRW_LINE_MAX / 4];
+    size_t skip = strlen(name);
+
+    dis_index_literal_str(&b->idx, f, l, value, sizeof(value));
+    if (strncmp(value, name, skip) || (value[skip] != ' ' && value[skip] != '\0'))
+        skip = 0;
+    else if (value[skip] == ' ')
+        ++skip;
+
+    snprintf(s, size, "%-11s %s", name, value + skip);
+}
+
+static brw_page_t* brw_render_lits(const brw_t *b, uint32_t fn, uint32_t p) {
+    const dis_function_t *f = &b->idx.functions[fn];
+    brw_page_t *page = calloc(1, sizeof(brw_page_t));
+    char line[BRW_LINE_MAX], value[BRW_LINE_MAX / 2];
+
+    for (uint32_t l = p * BRW_PAGE; l < f->literal_count && l < (p + 1) * BRW_PAGE; l++) {
+        brw_literal_str(b, fn, l, value, sizeof(value));
+        snprintf(line, sizeof(line), "%08x  [%05u] %s", f->literals[l].offset, l, value);
+        brw_line(page, f->literals[l].offset, line);
+    }
+
+    return page;
+}
+
+static brw_page_t* brw_render_code(const brw_t *b, uint32_t fn, uint32_t p) {
+    const dis_function_t *f = &b->idx.functions[fn];
+    brw_page_t *page = calloc(1, sizeof(brw_page_t));
+    dis_instruction_t ins[BRW_PAGE];
+    bool bad[BRW_PAGE];
+    uint32_t count = brw_decode_page(b, fn, p, ins, bad);
+    char line[BRW_LINE_MAX], value[BRW_LINE_MAX / 2];
+
+    for (uint32_t i = 0; i < count; i++) {
+        const dis_instruction_t *in = &ins[i];
+        int n = snprintf(line, sizeof(line), "%08x  [%05u](%03u) %s", in->offset, in->offset - f->code_start, in->opcode,
+                bad[i] ? "(bad)" : in->opcode == DIS_OP_SECTION_END ? "SECTION_END" : OP_STR[in->opcode] + 7);
+
+        for (uint8_t a = 0; a < 2 && !bad[i] && in->opcode < DIS_OP_END_OPCODES; a++) {
+            float fl;
+
+            switch (b->idx.ops->args[in->opcode][a]) {
+                case DIS_ARG_BYTE:
+                    n += snprintf(line + n, sizeof(line) - n, " b(%u)", in->arg[a]);
+                    break;
+                case DIS_ARG_WORD:
+                    n += snprintf(line + n, sizeof(line) - n, " w(%u)", in->arg[a]);
+                    break;
+                case DIS_ARG_INTEGER:
+                    n += snprintf(line + n, sizeof(line) - n, " i(%d)", (int32_t) in->arg[a]);
+                    break;
+                case DIS_ARG_FLOAT:
+                    memcpy(&fl, &in->arg[a], 4);
+                    n += snprintf(line + n, sizeof(line) - n, " f(%g)", fl);
+                    break;
+                case DIS_ARG_STRING: {
+                    uint32_t len = dis_strnlen(b->program + in->arg[a], 64);
+                    char escaped[DIS_ESCAPE_MAX(64)];
+
+                    dis_escape(b->program + in->arg[a], len, escaped, false);
+                    n += snprintf(line + n, sizeof(line) - n, " s(\"%s\")", escaped);
+                }
+                    break;
+            }
+
+            if (n >= (int) sizeof(line))
+                n = sizeof(line) - 1;
+        }
+
+        // the literal an instruction loads or declares
+        switch (bad[i] ? DIS_OP_EOF : in->opcode) {
+            case DIS_OP_LITERAL:
+            case DIS_OP_LITERAL_LONG:
+            case DIS_OP_VAR_DECL:
+            case DIS_OP_VAR_DECL_LONG:
+            case DIS_OP_FN_DECL:
+            case DIS_OP_FN_DECL_LONG:
+                if (in->arg[0] < f->literal_count) {
+                    dis_index_literal_str(&b->idx, f, in->arg[0], value, sizeof(value));
+                    snprintf(line + n, sizeof(line) - n, "  ; %s", value);
+                }
+                break;
+        }
+
+        brw_line(page, in->offset, line);
+    }
+
+    return page;
+}
+
+static brw_page_t* brw_page(brw_t *b, uint32_t fn, bool code, uint32_t p) {
+    brw_node_t *n = &b->nodes[fn];
+    brw_page_t **slot = code ? &n->code[p] : &n->lits[p];
+
+    if (*slot == NULL) {
+        *slot = code ? brw_render_code(b, fn, p) : brw_render_lits(b, fn, p);
+        b->cached += sizeof(brw_page_t) + (*slot)->text.capacity;
+    }
+
+    (*slot)->used = b->frame;
+    return *slot;
+}
+
+static void brw_page_free(brw_t *b, brw_page_t **slot) {
+    b->cached -= sizeof(brw_page_t) + (*slot)->text.capacity;
+    dis_buffer_free(&(*slot)->text);
+    free(*slot);
+    *slot = NULL;
+}
+
+// drops the least recently drawn pages, never the ones on screen
+static void brw_evict(brw_t *b) {
+    while (b->cached > BRW_CACHE_BYTES) {
+        brw_page_t **oldest = NULL;
+
+        for (uint32_t fn = 0; fn < b->idx.function_count; fn++) {
+            brw_node_t *n = &b->nodes[fn];
+
+            if (!n->ready)
+                continue;
+
+            for (uint32_t p = 0; p < brw_lit_pages(b, fn); p++)
+                if (n->lits[p] != NULL && n->lits[p]->used < b->frame && (oldest == NULL || n->lits[p]->used < (*oldest)->used))
+                    oldest = &n->lits[p];
+
+            for (uint32_t p = 0; p < n->code_pages; p++)
+                if (n->code[p] != NULL && n->code[p]->used < b->frame && (oldest == NULL || n->code[p]->used < (*oldest)->used))
+                    oldest = &n->code[p];
+        }
+
+        if (oldest == NULL)
+            break;
+        brw_page_free(b, oldest);
+    }
+}
+
+// text of a row, its bytecode offset in offset
+static void brw_row(brw_t *b, brw_pos_t pos, char *s, uint32_t size, uint32_t *offset) {
+    const dis_function_t *f = &b->idx.functions[pos.fn];
+    const brw_node_t *n = &b->nodes[pos.fn];
+    uint32_t indent = 2 * f->depth + 4;
+    int64_t lits = f->literal_count;
+    brw_page_t *page;
+    int len;
+
+    if (pos.row < 0) {
+        len = snprintf(s, size, "%*s%c %s  %u bytes", indent - 4, "", n->bad ? '!' : n->expanded ? '-' : '+', f->path, f->end - f->start);
+        if (n->bad)
+            snprintf(s + len, size - len, ", malformed");
+        else if (n->ready && f->parent >= 0)
+            snprintf(s + len, size - len, ", %u literals, %u functions, args %u rets %u", f->literal_count, n->child_count, f->args, f->rets);
+        else if (n->ready)
+            snprintf(s + len, size - len, ", %u literals, %u functions", f->literal_count, n->child_count);
+        *offset = f->start;
+        return;
+    }
+
+    if (pos.row < lits)
+        page = brw_page(b, pos.fn, false, pos.row / BRW_PAGE);
+    else
+        page = brw_page(b, pos.fn, true, (pos.row - lits) / BRW_PAGE);
+
+    uint32_t line = (pos.row < lits ? pos.row : pos.row - lits) % BRW_PAGE;
+    snprintf(s, size, "%*s%s", indent, "", (char*) page->text.data + page->line[line]);
+    *offset = page->offset[line];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void brw_size(brw_t *b) {
+    struct winsize ws;
+
+    b->width = 80;
+    b->height = 24;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col && ws.ws_row) {
+        b->width = ws.ws_col < BRW_LINE_MAX - 1 ? ws.ws_col : BRW_LINE_MAX - 1;
+        b->height = ws.ws_row > 2 ? ws.ws_row : 2;
+    }
+}
+
+// puts cur on screen row want, or as high as the rows above it leave it
+static void brw_anchor(brw_t *b, uint32_t want) {
+    b->top = b->cur;
+    b->cur_row = 0;
+
+    if (want + 1 >= b->height)
+        want = b->height - 2;
+    while (b->cur_row < want && brw_prev(b, &b->top))
+        ++b->cur_row;
+}
+
+static void brw_write(const void *data, size_t len) {
+    const uint8_t *p = data;
+
+    while (len) {
+        ssize_t n = write(STDOUT_FILENO, p, len);
+
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return;
+        p += n;
+        len -= n;
+    }
+}
+
+static void brw_draw(brw_t *b, const char *prompt) {
+    dis_buffer_t screen = { NULL, 0, 0 };
+    brw_pos_t pos = b->top;
+    char line[BRW_LINE_MAX], status[2 * BRW_LINE_MAX];
+    uint32_t offset = 0, cur_offset = 0;
+    bool more = true;
+
+    ++b->frame;
+    dis_buffer_append(&screen, "\x1b[H", 3);
+
+    for (uint32_t r = 0; r + 1 < b->height; r++) {
+        line[0] = '\0';
+        if (more)
+            brw_row(b, pos, line, sizeof(line), &offset);
+
+        if (more && r == b->cur_row) {
+            cur_offset = offset;
+            dis_buffer_append(&screen, "\x1b[7m", 4);
+        }
+        dis_buffer_append(&screen, line, strnlen(line, b->width));
+        if (more && r == b->cur_row)
+            dis_buffer_append(&screen, "\x1b[0m", 4);
+        dis_buffer_append(&screen, "\x1b[K\r\n", 5);
+
+        more = more && brw_next(b, &pos);
+    }
+
+    if (prompt != NULL)
+        snprintf(status, sizeof(status), "%s%s", prompt, b->query);
+    else
+        snprintf(status, sizeof(status), " %s  %s  0x%08x  %s", b->filename, b->idx.functions[b->cur.fn].path, cur_offset,
+                b->message[0] ? b->message : "/ search (opcode, identifier or @offset)  n next  enter expand  q quit");
+
+    dis_buffer_append(&screen, "\x1b[7m", 4);
+    dis_buffer_append(&screen, status, strnlen(status, b->width));
+    dis_buffer_append(&screen, "\x1b[K\x1b[0m", 7);
+
+    brw_write(screen.data, screen.len);
+    dis_buffer_free(&screen);
+    brw_evict(b);
+}
+
+// one key from what the terminal sent, pasted text and key repeat arrive several keys per read
+static int brw_key(void) {
+    static uint8_t buf[64];
+    static uint32_t len = 0, pos = 0;
+    int key;
+
+    if (pos == len) {
+        ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+
+        // end of input quits, like ctrl-c
+        if (n <= 0)
+            return n < 0 && errno == EINTR ? BRW_KEY_NONE : 3;
+        len = n;
+        pos = 0;
+    }
+
+    if (buf[pos] != 0x1b || len - pos < 3 || (buf[pos + 1] != '[' && buf[pos + 1] != 'O'))
+        return buf[pos++];
+
+    switch (buf[pos + 2]) {
+        case 'A':
+            key = BRW_KEY_UP;
+            break;
+        case 'B':
+            key = BRW_KEY_DOWN;
+            break;
+        case 'C':
+            key = BRW_KEY_RIGHT;
+            break;
+        case 'D':
+            key = BRW_KEY_LEFT;
+            break;
+        case 'H':
+            key = BRW_KEY_HOME;
+            break;
+        case 'F':
+            key = BRW_KEY_END;
+            break;
+        case '5':
+            key = BRW_KEY_PGUP;
+            break;
+        case '6':
+            key = BRW_KEY_PGDN;
+            break;
+        default:
+            key = BRW_KEY_NONE;
+            break;
+    }
+
+    // the whole sequence goes, up to its final letter or ~
+    for (pos += 2; pos < len && !isalpha(buf[pos]) && buf[pos] != '~'; pos++)
+        ;
+    if (pos < len)
+        ++pos;
+
+    return key;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void brw_down(brw_t *b, uint32_t count) {
+    for (; count; count--) {
+        brw_pos_t next = b->cur;
+
+        if (!brw_next(b, &next))
+            break;
+
+        b->cur = next;
+        if (++b->cur_row + 1 >= b->height) {
+            brw_next(b, &b->top);
+            --b->cur_row;
+        }
+    }
+}
+
+static void brw_up(brw_t *b, uint32_t count) {
+    for (; count; count--) {
+        if (!brw_prev(b, &b->cur))
+            break;
+
+        if (b->cur_row)
+            --b->cur_row;
+        else
+            b->top = b->cur;
+    }
+}
+
+static void brw_toggle(brw_t *b) {
+    brw_node_t *n = &b->nodes[b->cur.fn];
+
+    if (n->expanded) {
+        n->expanded = false;
+        b->cur.row = -1;
+    } else if (brw_scan(b, b->cur.fn))
+        snprintf(b->message, sizeof(b->message), "%.200s: malformed sections", b->idx.functions[b->cur.fn].path);
+    else
+        b->nodes[b->cur.fn].expanded = true;
+
+    brw_anchor(b, b->cur_row);
+}
+
+static void brw_collapse(brw_t *b) {
+    int32_t parent = b->idx.functions[b->cur.fn].parent;
+
+    if (b->cur.row >= 0 || b->nodes[b->cur.fn].expanded) {
+        b->nodes[b->cur.fn].expanded = false;
+        b->cur.row = -1;
+    } else if (parent >= 0)
+        b->cur = brw_pos(parent, -1);
+
+    brw_anchor(b, b->cur_row);
+}
+
+// expands everything above pos and scrolls it to the upper third
+static void brw_reveal(brw_t *b, brw_pos_t pos) {
+    for (int32_t fn = pos.row >= 0 ? (int32_t) pos.fn : b->idx.functions[pos.fn].parent; fn >= 0; fn = b->idx.functions[fn].parent)
+        b->nodes[fn].expanded = true;
+
+    b->cur = pos;
+    brw_anchor(b, (b->height - 1) / 3);
+}
+
+// the innermost function holding offset, and its row holding it
+static bool brw_goto(brw_t *b, uint32_t offset, brw_pos_t *pos) {
+    uint32_t fn = 0;
+    const dis_function_t *f;
+    brw_node_t *n;
+
+    if (offset >= b->len)
+        return false;
+
+    for (bool deeper = true; deeper && !brw_scan(b, fn);) {
+        n = &b->nodes[fn];
+        deeper = false;
+        for (uint32_t c = n->first_child; c < n->first_child + n->child_count; c++) {
+            if (b->idx.functions[c].start <= offset && offset < b->idx.functions[c].end) {
+                fn = c;
+                deeper = true;
+                break;
+            }
+        }
+    }
+
+    f = &b->idx.functions[fn];
+    n = &b->nodes[fn];
+    *pos = brw_pos(fn, -1);
+    if (!n->ready)
+        return true;
+
+    if (offset >= f->code_start && offset < f->code_end) {
+        dis_instruction_t ins[BRW_PAGE];
+
+        for (uint32_t p = 0; brw_code_page(b, fn, p); p++) {
+            if (n->code_start[p + 1] <= offset)
+                continue;
+
+            uint32_t count = brw_decode_page(b, fn, p, ins, NULL), i = 0;
+            while (i + 1 < count && ins[i + 1].offset <= offset)
+                ++i;
+            pos->row = f->literal_count + (int64_t) p * BRW_PAGE + i;
+            break;
+        }
+    } else if (f->literal_count && offset >= f->literals[0].offset && offset < f->lit_end - 1) {
+        uint32_t l = 0;
+
+        while (l + 1 < f->literal_count && f->literals[l + 1].offset <= offset)
+            ++l;
+        pos->row = l;
+    }
+
+    return true;
+}
+
+// first row of fn from row from matching an opcode, or an identifier when opcode is -1
+static bool brw_match(brw_t *b, uint32_t fn, int64_t from, int opcode, brw_pos_t *pos) {
+    const dis_function_t *f;
+    dis_instruction_t ins[BRW_PAGE];
+    bool bad[BRW_PAGE];
+
+    if (brw_scan(b, fn))
+        return false;
+    f = &b->idx.functions[fn];
+
+    if (opcode < 0) {
+        for (int64_t l = from > 0 ? from : 0; l < f->literal_count; l++) {
+            if (f->literals[l].type == DIS_LITERAL_IDENTIFIER && strstr((const char*) b->program + f->literals[l].offset + 1, b->query)) {
+                *pos = brw_pos(fn, l);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    int64_t first = from > f->literal_count ? from - f->literal_count : 0;
+    for (uint64_t p = first / BRW_PAGE; brw_code_page(b, fn, p); p++) {
+        uint32_t count = brw_decode_page(b, fn, p, ins, bad);
+
+        for (uint32_t i = 0; i < count; i++) {
+            int64_t row = (int64_t) p * BRW_PAGE + i;
+
+            if (row >= first && !bad[i] && ins[i].opcode == opcode) {
+                *pos = brw_pos(fn, f->literal_count + row);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// next function in tree order, scanning on the way, MAIN after the last one
+static uint32_t brw_next_fn(brw_t *b, uint32_t fn) {
+    if (!brw_scan(b, fn) && b->nodes[fn].child_count)
+        return b->nodes[fn].first_child;
+
+    for (int32_t parent = b->idx.functions[fn].parent; parent >= 0; fn = parent, parent = b->idx.functions[fn].parent)
+        if (fn + 1 < b->nodes[parent].first_child + b->nodes[parent].child_count)
+            return fn + 1;
+
+    return 0;
+}
+
+static void brw_search(brw_t *b) {
+    const char *q = b->query;
+    char *end;
+    int opcode = -1;
+    uint32_t fn = b->cur.fn;
+    int64_t from = b->cur.row + 1;
+    brw_pos_t pos;
+
+    if (q[0] == '\0')
+        return;
+
+    if (q[0] == '@' || isdigit((unsigned char) q[0])) {
+        unsigned long offset = strtoul(q + (q[0] == '@'), &end, 0);
+
+        if (*end == '\0') {
+            if (offset > UINT32_MAX || !brw_goto(b, offset, &pos))
+                snprintf(b->message, sizeof(b->message), "offset %s is past the end of the file", q);
+            else
+                brw_reveal(b, pos);
+            return;
+        }
+    }
+
+    for (int op = 0; op < DIS_OP_END_OPCODES; op++)
+        if (OP_STR[op] != NULL && !strcasecmp(OP_STR[op] + 7, q))
+            opcode = op;
+
+    // the start function comes around again last, from its first row
+    for (bool wrapped = false;;) {
+        if (brw_match(b, fn, from, opcode, &pos)) {
+            brw_reveal(b, pos);
+            return;
+        }
+
+        if (wrapped)
+            break;
+
+        fn = brw_next_fn(b, fn);
+        from = -1;
+        wrapped = fn == b->cur.fn;
+    }
+
+    snprintf(b->message, sizeof(b->message), "%s %s not found", opcode < 0 ? "identifier" : "opcode", q);
+}
+
+// reads the query in the status line, false when cancelled
+static bool brw_prompt(brw_t *b) {
+    size_t len = 0;
+
+    b->query[0] = '\0';
+    for (;;) {
+        brw_size(b);
+        brw_draw(b, "/");
+
+        int key = brw_key();
+        if (key == '\r' || key == '\n')
+            return len > 0;
+        if (key == 0x1b || key == 3)
+            return false;
+        if ((key == 127 || key == 8) && len)
+            b->query[--len] = '\0';
+        else if (key >= 0x20 && key < 0x7f && len + 1 < sizeof(b->query)) {
+            b->query[len++] = key;
+            b->query[len] = '\0';
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static uint8_t brw_open(brw_t *b, const char *filename) {
+    struct stat st;
+    int fd = open(filename, O_RDONLY);
+
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size > UINT32_MAX) {
+        if (fd >= 0)
+            close(fd);
+        return 1;
+    }
+
+    // a pipe can't be mapped, it is read whole
+    if (!S_ISREG(st.st_mode) || st.st_size == 0) {
+        close(fd);
+        return dis_read_file(filename, &b->program, &b->len);
+    }
+
+    b->program = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (b->program == MAP_FAILED)
+        return 1;
+
+    b->len = st.st_size;
+    b->mapped = true;
+    return 0;
+}
+
+static void brw_free(brw_t *b) {
+    for (uint32_t fn = 0; fn < b->node_capacity; fn++) {
+        brw_node_t *n = &b->nodes[fn];
+
+        if (!n->ready)
+            continue;
+
+        for (uint32_t p = 0; p < brw_lit_pages(b, fn); p++)
+            if (n->lits[p] != NULL)
+                brw_page_free(b, &n->lits[p]);
+        for (uint32_t p = 0; p < n->code_pages; p++)
+            if (n->code[p] != NULL)
+                brw_page_free(b, &n->code[p]);
+
+        free(n->lits);
+        free(n->code);
+        free(n->code_start);
+    }
+
+    free(b->nodes);
+    dis_index_free(&b->idx);
+    if (b->mapped)
+        munmap(b->program, b->len);
+    else
+        free(b->program);
+}
+
+uint8_t dis_browse(const char *filename) {
+    struct sigaction sa;
+    struct termios raw;
+    brw_t b;
+    bool quit = false;
+
+    memset(&b, 0, sizeof(b));
+    b.filename = filename;
+
+    if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO)) {
+        fprintf(stderr, "ERROR: browse needs a terminal\n");
+        return 1;
+    }
+
+    if (brw_open(&b, filename)) {
+        printf("Not able to open the file.\n");
+        return 1;
+    }
+
+    if (dis_index_open(b.program, b.len, &b.idx)) {
+        printf("ERROR: malformed bytecode in %s\n", filename);
+        brw_sync(&b);
+        brw_free(&b);
+        return 1;
+    }
+
+    brw_sync(&b);
+    brw_ready(&b, 0, 1);
+    b.nodes[0].expanded = true;
+    b.cur = b.top = brw_pos(0, -1);
+
+    // a resize interrupts the read below and the next frame picks the new size up
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = brw_winch;
+    sigaction(SIGWINCH, &sa, NULL);
+
+    tcgetattr(STDIN_FILENO, &brw_saved);
+    raw = brw_saved;
+    raw.c_iflag &= ~(ICRNL | IXON);
+    raw.c_lflag &= ~(ICANON | ECHO | ISIG | IEXTEN);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
+    brw_write("\x1b[?1049h\x1b[?25l", 14);
+
+    while (!quit) {
+        brw_size(&b);
+        if (b.cur_row + 1 >= b.height)
+            brw_anchor(&b, b.height - 2);
+        brw_draw(&b, NULL);
+
+        int key = brw_key();
+        b.message[0] = '\0';
+
+        switch (key) {
+            case 'q':
+            case 3:
+                quit = true;
+                break;
+            case 'j':
+            case BRW_KEY_DOWN:
+                brw_down(&b, 1);
+                break;
+            case 'k':
+            case BRW_KEY_UP:
+                brw_up(&b, 1);
+                break;
+            case ' ':
+            case BRW_KEY_PGDN:
+                brw_down(&b, b.height - 1);
+                break;
+            case 'b':
+            case BRW_KEY_PGUP:
+                brw_up(&b, b.height - 1);
+                break;
+            case 'g':
+            case BRW_KEY_HOME:
+                b.cur = b.top = brw_pos(0, -1);
+                b.cur_row = 0;
+                break;
+            case 'G':
+            case BRW_KEY_END:
+                b.cur = brw_last(&b, 0);
+                brw_anchor(&b, b.height - 2);
+                break;
+            case '\r':
+            case '\n':
+                brw_toggle(&b);
+                break;
+            case 'l':
+            case BRW_KEY_RIGHT:
+                if (b.cur.row < 0 && !b.nodes[b.cur.fn].expanded)
+                    brw_toggle(&b);
+                else
+                    brw_down(&b, 1);
+                break;
+            case 'h':
+            case BRW_KEY_LEFT:
+                brw_collapse(&b);
+                break;
+            case '/':
+                if (brw_prompt(&b))
+                    brw_search(&b);
+                break;
+            case 'n':
+                brw_search(&b);
+                break;
+        }
+    }
+
+    brw_write("\x1b[?25h\x1b[?1049l", 14);
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &brw_saved);
+    brw_free(&b);
+    return 0;
+}
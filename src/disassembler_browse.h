@@ -0,0 +1,18 @@
+/*
+ * disassembler_browse.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Interactive terminal browser over the function tree of a .tb file. Functions are scanned
+ * when expanded and their literals and code are decoded a page at a time as they scroll
+ * into view.
+ */
+
+#ifndef DISASSEMBLER_BROWSE_H_
+#define DISASSEMBLER_BROWSE_H_
+
+#include <stdint.h>
+
+uint8_t dis_browse(const char *filename);
+
+#endif /* DISASSEMBLER_BROWSE_H_ */
@@ -0,0 +1,202 @@
+/*
+ * disassembler_cache.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Entries live in DIR/xx/<kind><key>, sharded by the first key byte. They are written to a
+ * temporary name and renamed, so concurrent CI jobs sharing DIR never read a partial entry.
+ *
+ * Keys are salted with the identity of the running build: its GNU build id, or a hash of the
+ * executable when it was linked without one. Any change to the tool, the listing code or its
+ * tables included, starts from an empty cache without anyone having to remember a bump.
+ *
+ * The memo keeps the same section entries in memory. Every entry remembers the last render
+ * that used it and a sweep after each render drops the rest, so a long running process holds
+ * the sections of the current version of its file and nothing older.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <link.h>
+#include <elf.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "disassembler_utils.h"
+#include "disassembler_cache.h"
+
+static uint64_t cache_build = 0;
+static pthread_once_t cache_build_once = PTHREAD_ONCE_INIT;
+
+// the first object reported is the executable itself
+static int cache_build_note(struct dl_phdr_info *info, size_t size, void *arg) {
+    (void) size;
+
+    for (uint16_t i = 0; i < info->dlpi_phnum; i++) {
+        const uint8_t *p, *end;
+
+        if (info->dlpi_phdr[i].p_type != PT_NOTE)
+            continue;
+
+        p = (const uint8_t*) (info->dlpi_addr + info->dlpi_phdr[i].p_vaddr);
+        end = p + info->dlpi_phdr[i].p_memsz;
+        while (p + sizeof(ElfW(Nhdr)) <= end) {
+            const ElfW(Nhdr) *note = (const ElfW(Nhdr)*) p;
+            const uint8_t *desc = p + sizeof(ElfW(Nhdr)) + ((note->n_namesz + 3) & ~3u);
+
+            if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 && !memcmp(p + sizeof(ElfW(Nhdr)), "GNU", 4)
+                    && desc + note->n_descsz <= end) {
+                *(uint64_t*) arg = dis_hash(desc, note->n_descsz, DIS_HASH_SEED);
+                return 1;
+            }
+            p = desc + ((note->n_descsz + 3) & ~3u);
+        }
+    }
+
+    return 1;
+}
+
+static void cache_build_init(void) {
+    uint8_t *exe;
+    uint32_t len;
+
+    dl_iterate_phdr(cache_build_note, &cache_build);
+    if (cache_build != 0)
+        return;
+
+    if (!dis_read_file("/proc/self/exe", &exe, &len)) {
+        cache_build = dis_hash(exe, len, DIS_HASH_SEED);
+        free(exe);
+    }
+}
+
+uint64_t dis_cache_key(const uint8_t *data, uint32_t len, options_t config, uint64_t extra) {
+    uint8_t salt[5] = { DIS_CACHE_VERSION, config.alt_format_flag, config.group_flag, config.hex_flag, sizeof(extra) };
+    uint64_t hash;
+
+    pthread_once(&cache_build_once, cache_build_init);
+
+    hash = dis_hash(&cache_build, sizeof(cache_build), DIS_HASH_SEED);
+    hash = dis_hash(salt, sizeof(salt), hash);
+    hash = dis_hash(&extra, sizeof(extra), hash);
+    return dis_hash(data, len, hash);
+}
+
+static void cache_path(char *path, size_t size, const char *dir, char kind, uint64_t key) {
+    snprintf(path, size, "%s/%02x/%c%016llx", dir, (unsigned) (key >> 56), kind, (unsigned long long) key);
+}
+
+uint8_t dis_cache_get(const char *dir, char kind, uint64_t key, uint8_t **data, uint32_t *len) {
+    char path[strlen(dir) + 24];
+
+    cache_path(path, sizeof(path), dir, kind, key);
+    return dis_read_file(path, data, len);
+}
+
+void dis_cache_put(const char *dir, char kind, uint64_t key, const uint8_t *data, uint32_t len) {
+    char path[strlen(dir) + 24], tmp[strlen(dir) + 48];
+
+    // a cache that can't be written only costs the next run some time
+    mkdir(dir, 0777);
+    snprintf(path, sizeof(path), "%s/%02x", dir, (unsigned) (key >> 56));
+    mkdir(path, 0777);
+
+    cache_path(path, sizeof(path), dir, kind, key);
+    snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", path, (long) getpid());
+
+    if (dis_write_file(tmp, data, len) || rename(tmp, path))
+        remove(tmp);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static dis_memo_entry_t* memo_slot(dis_memo_entry_t *entries, uint32_t capacity, uint64_t key) {
+    uint32_t i = (uint32_t) (key ^ key >> 32) & (capacity - 1);
+
+    while (entries[i].key != 0 && entries[i].key != key)
+        i = (i + 1) & (capacity - 1);
+
+    return &entries[i];
+}
+
+static void memo_resize(dis_memo_t *memo, uint32_t capacity) {
+    dis_memo_entry_t *entries = calloc(capacity, sizeof(dis_memo_entry_t));
+
+    for (uint32_t i = 0; i < memo->capacity; i++)
+        if (memo->entries[i].key != 0)
+            *memo_slot(entries, capacity, memo->entries[i].key) = memo->entries[i];
+
+    free(memo->entries);
+    memo->entries = entries;
+    memo->capacity = capacity;
+}
+
+uint8_t dis_memo_get(dis_memo_t *memo, uint64_t key, const uint8_t **data, uint32_t *len) {
+    dis_memo_entry_t *entry;
+
+    key |= key == 0;
+    if (memo->capacity == 0 || (entry = memo_slot(memo->entries, memo->capacity, key))->key == 0) {
+        memo->misses++;
+        return 1;
+    }
+
+    entry->generation = memo->generation;
+    *data = entry->data;
+    *len = entry->len;
+    memo->hits++;
+    return 0;
+}
+
+// takes ownership of data
+void dis_memo_put(dis_memo_t *memo, uint64_t key, uint8_t *data, uint32_t len) {
+    dis_memo_entry_t *entry;
+
+    key |= key == 0;
+    if (2 * (memo->count + 1) > memo->capacity)
+        memo_resize(memo, memo->capacity ? 2 * memo->capacity : 64);
+
+    entry = memo_slot(memo->entries, memo->capacity, key);
+    if (entry->key == 0)
+        memo->count++;
+    else
+        free(entry->data);
+
+    entry->key = key;
+    entry->data = data;
+    entry->len = len;
+    entry->generation = memo->generation;
+}
+
+// drops the entries the last render did not use and starts the next one
+void dis_memo_sweep(dis_memo_t *memo) {
+    for (uint32_t i = 0; i < memo->capacity; i++) {
+        dis_memo_entry_t *entry = &memo->entries[i];
+
+        if (entry->key != 0 && entry->generation != memo->generation) {
+            free(entry->data);
+            entry->key = 0;
+            memo->count--;
+        }
+    }
+
+    // linear probing can't leave holes in a chain, reinsert the survivors
+    uint32_t capacity = memo->capacity;
+    while (capacity > 64 && 8 * memo->count < capacity)
+        capacity /= 2;
+    if (capacity)
+        memo_resize(memo, capacity);
+
+    memo->generation++;
+    memo->hits = memo->misses = 0;
+}
+
+void dis_memo_free(dis_memo_t *memo) {
+    for (uint32_t i = 0; i < memo->capacity; i++)
+        free(memo->entries[i].data);
+
+    free(memo->entries);
+    memset(memo, 0, sizeof(dis_memo_t));
+}
@@ -0,0 +1,48 @@
+/*
+ * disassembler_cache.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Persistent content addressed cache of rendered disassembly, for whole files and for
+ * single code sections, and a resident store of rendered code sections for processes that
+ * render the same file again and again.
+ */
+
+#ifndef DISASSEMBLER_CACHE_H_
+#define DISASSEMBLER_CACHE_H_
+
+#include <stdint.h>
+
+#include "disassembler.h"
+
+#define DIS_CACHE_VERSION 3 // bump whenever the rendered output changes, keys also carry the build identity
+
+#define DIS_CACHE_FILE    'f'
+#define DIS_CACHE_SECTION 's'
+
+uint64_t dis_cache_key(const uint8_t *data, uint32_t len, options_t config, uint64_t extra);
+uint8_t dis_cache_get(const char *dir, char kind, uint64_t key, uint8_t **data, uint32_t *len);
+void dis_cache_put(const char *dir, char kind, uint64_t key, const uint8_t *data, uint32_t len);
+
+typedef struct dis_memo_entry_s {
+    uint64_t key;        // section key, 0 marks a free slot
+    uint8_t *data;       // same layout as a DIS_CACHE_SECTION entry
+    uint32_t len;        //
+    uint32_t generation; // last render that used the entry
+} dis_memo_entry_t;
+
+typedef struct dis_memo_s {
+    dis_memo_entry_t *entries; // open addressing, capacity is a power of two
+    uint32_t count;            //
+    uint32_t capacity;         //
+    uint32_t generation;       // current render
+    uint32_t hits;             // sections served since the last sweep
+    uint32_t misses;           // sections rendered since the last sweep
+} dis_memo_t;
+
+uint8_t dis_memo_get(dis_memo_t *memo, uint64_t key, const uint8_t **data, uint32_t *len);
+void dis_memo_put(dis_memo_t *memo, uint64_t key, uint8_t *data, uint32_t len);
+void dis_memo_sweep(dis_memo_t *memo);
+void dis_memo_free(dis_memo_t *memo);
+
+#endif /* DISASSEMBLER_CACHE_H_ */
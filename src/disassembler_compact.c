@@ -0,0 +1,311 @@
+/*
+ * disassembler_compact.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * A literal is referenced by a LITERAL/VAR_DECL/FN_DECL operand anywhere in the code (dead
+ * code included, the code itself is left alone), by the args/rets words or by an element of
+ * another referenced compound literal. FUNCTION entries are always kept and never merged:
+ * the function section pairs them with the children by ordinal. Duplicates are found after
+ * their elements are renumbered, so equal arrays of equal strings collapse as well.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "disassembler_utils.h"
+#include "disassembler_index.h"
+#include "disassembler_rewrite.h"
+#include "disassembler_compact.h"
+
+#define CMP_NONE UINT32_MAX
+
+typedef struct cmp_stats_s {
+    uint32_t unreferenced;
+    uint32_t merged;
+    uint32_t narrowed; // operands re-encoded from the _LONG form
+} cmp_stats_t;
+
+// number of literal index words of an entry, starting at entry + 3
+static uint16_t cmp_elements(const uint8_t *entry) {
+    uint16_t length = 0;
+
+    switch (entry[0]) {
+        case DIS_LITERAL_ARRAY:
+        case DIS_LITERAL_ARRAY_INTERMEDIATE:
+            memcpy(&length, entry + 1, 2);
+            break;
+        case DIS_LITERAL_DICTIONARY:
+        case DIS_LITERAL_DICTIONARY_INTERMEDIATE:
+            memcpy(&length, entry + 1, 2);
+            length &= ~1;
+            break;
+        case DIS_LITERAL_TYPE:
+        case DIS_LITERAL_TYPE_INTERMEDIATE:
+            length = entry[1] == DIS_LITERAL_ARRAY ? 1 : entry[1] == DIS_LITERAL_DICTIONARY ? 2 : 0;
+            break;
+    }
+
+    return length;
+}
+
+static void cmp_mark(bool *live, uint32_t *work, uint32_t *work_len, uint32_t count, uint32_t literal) {
+    if (literal < count && !live[literal]) {
+        live[literal] = true;
+        work[(*work_len)++] = literal;
+    }
+}
+
+// copy of an entry with its element words renumbered, fails on an unmapped element
+static uint8_t cmp_remap(const uint8_t *entry, uint32_t size, const uint32_t *map, uint32_t count, dis_buffer_t *out) {
+    uint16_t length = cmp_elements(entry), element;
+    uint32_t pos = out->len;
+
+    dis_buffer_append(out, entry, size);
+    for (uint16_t e = 0; e < length; e++) {
+        memcpy(&element, entry + 3 + 2 * e, 2);
+        if (element >= count || map[element] == CMP_NONE)
+            return 1;
+        element = map[element];
+        memcpy(out->data + pos + 3 + 2 * e, &element, 2);
+    }
+
+    return 0;
+}
+
+static uint8_t cmp_function(dis_rewrite_t *rw, uint32_t fn, cmp_stats_t *stats) {
+    const dis_function_t *f = &rw->idx->functions[fn];
+    const uint8_t *lits = rw->literals[fn].data;
+    uint32_t count = rw->literal_count[fn], kept = 0, pc = 0, work_len = 0, capacity = 16;
+    uint32_t *offset = malloc((count + 1) * sizeof(uint32_t));
+    uint32_t *map = malloc((count ? count : 1) * sizeof(uint32_t));
+    uint32_t *work = malloc((count ? count : 1) * sizeof(uint32_t));
+    uint32_t *key_offset = malloc((count + 1) * sizeof(uint32_t));
+    bool *live = calloc(count ? count : 1, sizeof(bool));
+    dis_buffer_t keys = { NULL, 0, 0 }, literals = { NULL, 0, 0 }, code = { NULL, 0, 0 };
+    dis_rw_instr_t *ins = NULL;
+    uint32_t ins_count = 0, *table;
+    uint8_t ret = 1;
+
+    while (capacity < 2 * count)
+        capacity *= 2;
+    table = calloc(capacity, sizeof(uint32_t));
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t size;
+
+        offset[i] = pc;
+        if (dis_literal_size(lits, pc, rw->literals[fn].len, &size))
+            goto done;
+        pc += size;
+    }
+    offset[count] = pc;
+
+    if (pc != rw->literals[fn].len || dis_rewrite_decode(rw->idx->ops, rw->code[fn].data, rw->code[fn].len, &ins, &ins_count))
+        goto done;
+
+    for (uint32_t i = 0; i < ins_count; i++) {
+        switch (ins[i].opcode) {
+            case DIS_OP_VAR_DECL:
+            case DIS_OP_VAR_DECL_LONG:
+            case DIS_OP_FN_DECL:
+            case DIS_OP_FN_DECL_LONG:
+                cmp_mark(live, work, &work_len, count, ins[i].arg[1]);
+                /* fall through */
+            case DIS_OP_LITERAL:
+            case DIS_OP_LITERAL_LONG:
+                cmp_mark(live, work, &work_len, count, ins[i].arg[0]);
+                break;
+        }
+    }
+
+    if (f->parent >= 0) {
+        cmp_mark(live, work, &work_len, count, rw->args[fn]);
+        cmp_mark(live, work, &work_len, count, rw->rets[fn]);
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+        if (lits[offset[i]] == DIS_LITERAL_FUNCTION)
+            cmp_mark(live, work, &work_len, count, i);
+
+    while (work_len) {
+        const uint8_t *entry = lits + offset[work[--work_len]];
+        uint16_t length = cmp_elements(entry), element;
+
+        for (uint16_t e = 0; e < length; e++) {
+            memcpy(&element, entry + 3 + 2 * e, 2);
+            cmp_mark(live, work, &work_len, count, element);
+        }
+    }
+
+    // entries only referring to earlier ones can be compared once renumbered
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t *entry = lits + offset[i];
+        uint32_t size = offset[i + 1] - offset[i], slot;
+        bool unique = entry[0] == DIS_LITERAL_FUNCTION;
+        uint64_t hash;
+
+        map[i] = CMP_NONE;
+        if (!live[i]) {
+            ++stats->unreferenced;
+            continue;
+        }
+
+        key_offset[kept] = keys.len;
+        if (cmp_remap(entry, size, map, i, &keys)) {
+            // forward references are left to the final pass
+            keys.len = key_offset[kept];
+            dis_buffer_append(&keys, entry, size);
+            unique = true;
+        }
+
+        hash = dis_hash(keys.data + key_offset[kept], size, DIS_HASH_SEED);
+        for (slot = hash & (capacity - 1); !unique && table[slot]; slot = (slot + 1) & (capacity - 1)) {
+            uint32_t other = table[slot] - 1;
+
+            if (key_offset[other + 1] - key_offset[other] == size && memcmp(keys.data + key_offset[other], keys.data + key_offset[kept], size) == 0)
+                break;
+        }
+
+        if (!unique && table[slot]) {
+            map[i] = table[slot] - 1;
+            keys.len = key_offset[kept];
+            ++stats->merged;
+            continue;
+        }
+
+        if (!unique)
+            table[slot] = kept + 1;
+        map[i] = kept++;
+        key_offset[kept] = keys.len;
+    }
+
+    // emit in survivor order: the first entry holding each new index
+    for (uint32_t i = 0, next = 0; i < count; i++) {
+        if (map[i] != next)
+            continue;
+        if (cmp_remap(lits + offset[i], offset[i + 1] - offset[i], map, count, &literals))
+            goto done;
+        ++next;
+    }
+
+    for (uint32_t i = 0; i < ins_count; i++) {
+        dis_rw_instr_t *in = &ins[i];
+
+        switch (in->opcode) {
+            case DIS_OP_LITERAL:
+            case DIS_OP_LITERAL_LONG:
+                if (in->arg[0] >= count)
+                    goto done;
+                in->arg[0] = map[in->arg[0]];
+                if (in->opcode == DIS_OP_LITERAL_LONG && in->arg[0] <= UINT8_MAX)
+                    ++stats->narrowed;
+                in->opcode = in->arg[0] <= UINT8_MAX ? DIS_OP_LITERAL : DIS_OP_LITERAL_LONG;
+                break;
+            case DIS_OP_VAR_DECL:
+            case DIS_OP_VAR_DECL_LONG:
+            case DIS_OP_FN_DECL:
+            case DIS_OP_FN_DECL_LONG: {
+                bool var = in->opcode == DIS_OP_VAR_DECL || in->opcode == DIS_OP_VAR_DECL_LONG;
+                bool wide = in->opcode == DIS_OP_VAR_DECL_LONG || in->opcode == DIS_OP_FN_DECL_LONG;
+
+                if (in->arg[0] >= count || in->arg[1] >= count)
+                    goto done;
+                in->arg[0] = map[in->arg[0]];
+                in->arg[1] = map[in->arg[1]];
+                if (in->arg[0] <= UINT8_MAX && in->arg[1] <= UINT8_MAX) {
+                    if (wide)
+                        ++stats->narrowed;
+                    in->opcode = var ? DIS_OP_VAR_DECL : DIS_OP_FN_DECL;
+                } else
+                    in->opcode = var ? DIS_OP_VAR_DECL_LONG : DIS_OP_FN_DECL_LONG;
+            }
+                break;
+        }
+    }
+
+    if (dis_rewrite_encode(rw->idx->ops, ins, ins_count, rw->code[fn].len, &code))
+        goto done;
+
+    if (f->parent >= 0) {
+        if (rw->args[fn] >= count || rw->rets[fn] >= count)
+            goto done;
+        rw->args[fn] = map[rw->args[fn]];
+        rw->rets[fn] = map[rw->rets[fn]];
+    }
+
+    dis_buffer_free(&rw->literals[fn]);
+    dis_buffer_free(&rw->code[fn]);
+    rw->literals[fn] = literals;
+    rw->literal_count[fn] = kept;
+    rw->code[fn] = code;
+    literals = (dis_buffer_t) { NULL, 0, 0 };
+    code = (dis_buffer_t) { NULL, 0, 0 };
+    ret = 0;
+
+    done:
+    dis_buffer_free(&keys);
+    dis_buffer_free(&literals);
+    dis_buffer_free(&code);
+    free(ins);
+    free(offset);
+    free(map);
+    free(work);
+    free(key_offset);
+    free(live);
+    free(table);
+    return ret;
+}
+
+uint8_t dis_compact(const char *filename, const char *output) {
+    uint8_t *program = NULL;
+    uint32_t len = 0;
+    dis_index_t idx;
+    dis_rewrite_t rw;
+    dis_buffer_t out = { NULL, 0, 0 };
+    uint8_t ret = 0;
+
+    if (dis_read_file(filename, &program, &len)) {
+        printf("Not able to open the file.\n");
+        return 1;
+    }
+
+    if (dis_index_build(program, len, &idx)) {
+        printf("ERROR: malformed bytecode in %s\n", filename);
+        dis_index_free(&idx);
+        free(program);
+        return 1;
+    }
+
+    dis_rewrite_init(&rw, &idx);
+
+    printf("\n.comment compact %s -> %s\n", filename, output);
+    for (uint32_t i = 0; i < idx.function_count; i++) {
+        cmp_stats_t stats = { 0, 0, 0 };
+        uint32_t count = rw.literal_count[i], size = rw.literals[i].len + rw.code[i].len;
+
+        if (cmp_function(&rw, i, &stats)) {
+            printf(".comment %s: not compacted (unable to re-encode)\n", idx.functions[i].path);
+            continue;
+        }
+
+        printf(".comment %s: literals %u -> %u, %u -> %u bytes (unreferenced: %u, merged: %u, narrowed: %u)\n", idx.functions[i].path, count,
+                rw.literal_count[i], size, rw.literals[i].len + rw.code[i].len, stats.unreferenced, stats.merged, stats.narrowed);
+    }
+
+    if (dis_rewrite_emit(&rw, &out) || dis_rewrite_verify(out.data, out.len)) {
+        printf("ERROR: compacted bytecode failed verification, nothing written\n");
+        ret = 1;
+    } else if (dis_write_file(output, out.data, out.len)) {
+        printf("ERROR: not able to write %s\n", output);
+        ret = 1;
+    } else
+        printf(".comment size: %u -> %u bytes\n", len, out.len);
+
+    dis_buffer_free(&out);
+    dis_rewrite_free(&rw);
+    dis_index_free(&idx);
+    free(program);
+    return ret;
+}
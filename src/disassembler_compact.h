@@ -0,0 +1,17 @@
+/*
+ * disassembler_compact.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Literal cache compactor: drops unreferenced literals, merges duplicates inside each cache,
+ * renumbers the operands that index the cache and writes a new .tb.
+ */
+
+#ifndef DISASSEMBLER_COMPACT_H_
+#define DISASSEMBLER_COMPACT_H_
+
+#include <stdint.h>
+
+uint8_t dis_compact(const char *filename, const char *output);
+
+#endif /* DISASSEMBLER_COMPACT_H_ */
@@ -0,0 +1,451 @@
+/*
+ * disassembler_daemon.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Programs are kept decoded (bytes, function index, symbolizer intervals and the listings
+ * already rendered) keyed by path, and reloaded when the file size or mtime changes.
+ *
+ * One thread serves every connection from a poll loop: requests are read and responses
+ * written without blocking, so a client that keeps its connection open between requests
+ * never holds up the others. A client may send any number of requests, its responses come
+ * back in order. The listing code keeps file scope state, requests are answered one at a
+ * time.
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "disassembler.h"
+#include "disassembler_utils.h"
+#include "disassembler_index.h"
+#include "disassembler_symbolize.h"
+#include "disassembler_daemon.h"
+
+enum {
+    LISTING_DEFAULT, //
+    LISTING_ALT,     //
+    LISTING_GROUP,   //
+    LISTING_END,     //
+};
+
+typedef struct daemon_program_s {
+    char *path;                    // NULL for a free slot
+    struct timespec mtime;         //
+    off_t size;                    //
+    uint8_t *program;              //
+    uint32_t len;                  //
+    dis_index_t idx;               //
+    dis_symbolizer_t sym;          //
+    char *listing[LISTING_END];    // whole file listings, rendered on first request
+    size_t listing_len[LISTING_END];
+    uint64_t used;                 // request counter at the last use
+} daemon_program_t;
+
+typedef struct daemon_client_s {
+    int fd;           //
+    dis_buffer_t in;  // received bytes not answered yet
+    dis_buffer_t out; // responses not sent yet
+    uint32_t sent;    // bytes of out already sent
+} daemon_client_t;
+
+typedef struct daemon_s {
+    daemon_program_t programs[DIS_DAEMON_PROGRAMS];
+    uint64_t requests;
+    dis_buffer_t response;
+    daemon_client_t clients[DIS_DAEMON_CLIENTS];
+    uint32_t client_count;
+} daemon_t;
+
+static void daemon_program_free(daemon_program_t *prg) {
+    for (uint32_t i = 0; i < LISTING_END; i++)
+        free(prg->listing[i]);
+
+    dis_symbolizer_free(&prg->sym);
+    dis_index_free(&prg->idx);
+    free(prg->program);
+    free(prg->path);
+    memset(prg, 0, sizeof(daemon_program_t));
+}
+
+static daemon_program_t* daemon_program(daemon_t *d, const char *path, const char **error) {
+    daemon_program_t *prg = NULL, *lru = &d->programs[0];
+    struct stat st;
+
+    if (stat(path, &st) != 0) {
+        *error = "not able to open the file";
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < DIS_DAEMON_PROGRAMS; i++) {
+        daemon_program_t *p = &d->programs[i];
+
+        if (p->path != NULL && !strcmp(p->path, path)) {
+            prg = p;
+            break;
+        }
+        if (p->used < lru->used)
+            lru = p;
+    }
+
+    if (prg != NULL && prg->size == st.st_size && prg->mtime.tv_sec == st.st_mtim.tv_sec && prg->mtime.tv_nsec == st.st_mtim.tv_nsec) {
+        prg->used = d->requests;
+        return prg;
+    }
+
+    if (prg == NULL)
+        prg = lru;
+    daemon_program_free(prg);
+
+    if (dis_read_file(path, &prg->program, &prg->len)) {
+        *error = "not able to read the file";
+        return NULL;
+    }
+
+    // the listing code exits on malformed input, so nothing is served from a file that doesn't index
+    if (dis_index_build(prg->program, prg->len, &prg->idx) || dis_symbolizer_build(&prg->idx, &prg->sym)) {
+        daemon_program_free(prg);
+        *error = "not able to decode the file";
+        return NULL;
+    }
+
+    prg->path = malloc(strlen(path) + 1);
+    strcpy(prg->path, path);
+    prg->mtime = st.st_mtim;
+    prg->size = st.st_size;
+    prg->used = d->requests;
+
+    return prg;
+}
+
+static void daemon_file(daemon_t *d, daemon_program_t *prg, const char *format) {
+    uint32_t kind = LISTING_DEFAULT;
+    options_t config = { false, false, NULL, NULL, false, false, NULL };
+
+    if (format != NULL && !strcmp(format, "alt")) {
+        kind = LISTING_ALT;
+        config.alt_format_flag = true;
+    } else if (format != NULL && !strcmp(format, "group")) {
+        kind = LISTING_GROUP;
+        config.alt_format_flag = config.group_flag = true;
+    }
+
+    if (prg->listing[kind] == NULL) {
+        FILE *stream = open_memstream(&prg->listing[kind], &prg->listing_len[kind]);
+        disassemble_buffer(prg->path, prg->program, prg->len, config, stream);
+        fclose(stream);
+    }
+
+    dis_buffer_append(&d->response, prg->listing[kind], prg->listing_len[kind]);
+}
+
+static uint8_t daemon_function(daemon_t *d, daemon_program_t *prg, const char *path, const char *format) {
+    options_t config = { format != NULL && !strcmp(format, "alt"), false, NULL, NULL, false, false, NULL };
+    char *text = NULL;
+    size_t text_len = 0;
+
+    for (uint32_t i = 0; i < prg->idx.function_count; i++) {
+        const dis_function_t *f = &prg->idx.functions[i];
+        FILE *stream;
+
+        if (strcmp(f->path, path))
+            continue;
+
+        stream = open_memstream(&text, &text_len);
+        disassemble_section(prg->program, prg->len, f->fn_end, f->code_end, f->parent >= 0, config, stream);
+        fclose(stream);
+
+        dis_buffer_append(&d->response, text, text_len);
+        dis_buffer_byte(&d->response, '\n');
+        free(text);
+        return 0;
+    }
+
+    return 1;
+}
+
+static void daemon_range(daemon_t *d, daemon_program_t *prg, uint32_t start, uint32_t end) {
+    char line[DIS_PATH_MAX + 64];
+    int n;
+
+    for (uint32_t pc = start; pc < end && pc < prg->len;) {
+        const dis_symbol_t *s = dis_symbolize(&prg->sym, pc);
+        const dis_function_t *f = &prg->idx.functions[s->fn];
+        uint32_t next = s + 1 < prg->sym.symbols + prg->sym.count ? s[1].offset : prg->len;
+        dis_instruction_t ins;
+
+        if (s->kind != DIS_SYMBOL_CODE) {
+            pc = next;
+            continue;
+        }
+
+        prg->idx.ops->decode(prg->program, s->offset, f->code_end, &ins);
+        n = snprintf(line, sizeof(line), "%s [%05d](%03d) %s", f->path, s->offset - f->code_start, s->opcode,
+                s->opcode == DIS_OP_SECTION_END ? "SECTION_END" : s->opcode < DIS_OP_END_OPCODES ? OP_STR[s->opcode] + 7 : "(OP UNKNOWN)");
+
+        for (uint8_t a = 0; a < 2 && s->opcode < DIS_OP_END_OPCODES; a++) {
+            if (prg->idx.ops->args[s->opcode][a] == DIS_ARG_BYTE)
+                n += snprintf(line + n, sizeof(line) - n, " b(%u)", ins.arg[a]);
+            else if (prg->idx.ops->args[s->opcode][a] == DIS_ARG_WORD)
+                n += snprintf(line + n, sizeof(line) - n, " w(%u)", ins.arg[a]);
+        }
+
+        dis_buffer_append(&d->response, line, n);
+        dis_buffer_byte(&d->response, '\n');
+        pc = next;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// splits the request in place, returns the number of fields
+static uint32_t daemon_fields(char *request, char **fields, uint32_t max) {
+    uint32_t count = 0;
+
+    while (count < max) {
+        fields[count++] = request;
+        request = strchr(request, '\t');
+        if (request == NULL)
+            break;
+        *request++ = '\0';
+    }
+
+    return count;
+}
+
+// 0 keep serving, 1 shut down
+static uint8_t daemon_request(daemon_t *d, char *request) {
+    char *field[4] = { NULL, NULL, NULL, NULL };
+    uint32_t count = daemon_fields(request, field, 4);
+    const char *error = NULL;
+    daemon_program_t *prg = NULL;
+
+    ++d->requests;
+    d->response.len = 0;
+    dis_buffer_byte(&d->response, '0');
+
+    if (!strcmp(field[0], "PING"))
+        dis_buffer_append(&d->response, "PONG\n", 5);
+    else if (!strcmp(field[0], "SHUTDOWN"))
+        return 1;
+    else if (count < 2)
+        error = "unknown request";
+    else if ((prg = daemon_program(d, field[1], &error)) == NULL)
+        ;
+    else if (!strcmp(field[0], "FILE"))
+        daemon_file(d, prg, field[2]);
+    else if (!strcmp(field[0], "FUNCTION") && count >= 3) {
+        if (daemon_function(d, prg, field[2], field[3]))
+            error = "no such function";
+    } else if (!strcmp(field[0], "RANGE") && count == 4)
+        daemon_range(d, prg, strtoul(field[2], NULL, 0), strtoul(field[3], NULL, 0));
+    else
+        error = "unknown request";
+
+    if (error != NULL) {
+        d->response.len = 0;
+        dis_buffer_byte(&d->response, '1');
+        dis_buffer_append(&d->response, error, strlen(error));
+        dis_buffer_byte(&d->response, '\n');
+    }
+
+    return 0;
+}
+
+static void daemon_close(daemon_t *d, daemon_client_t *c) {
+    close(c->fd);
+    dis_buffer_free(&c->in);
+    dis_buffer_free(&c->out);
+    *c = d->clients[--d->client_count];
+}
+
+// answers every complete request received so far, 0 keep the connection, 1 close it, 2 shut down
+static uint8_t daemon_receive(daemon_t *d, daemon_client_t *c) {
+    uint8_t buf[65536];
+    uint32_t used = 0, len;
+    ssize_t r;
+
+    r = recv(c->fd, buf, sizeof(buf), 0);
+    if (r < 0)
+        return errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR;
+    if (r == 0)
+        return 1;
+    dis_buffer_append(&c->in, buf, r);
+
+    while (c->in.len - used >= 4) {
+        memcpy(&len, c->in.data + used, 4);
+        if (len > DIS_DAEMON_REQUEST_MAX)
+            return 1;
+        if (c->in.len - used - 4 < len)
+            break;
+
+        char request[len + 1];
+        memcpy(request, c->in.data + used + 4, len);
+        request[len] = '\0';
+        used += 4 + len;
+
+        if (daemon_request(d, request))
+            return 2;
+
+        len = d->response.len;
+        dis_buffer_append(&c->out, &len, 4);
+        dis_buffer_append(&c->out, d->response.data, d->response.len);
+    }
+
+    memmove(c->in.data, c->in.data + used, c->in.len - used);
+    c->in.len -= used;
+    return 0;
+}
+
+// 0 keep the connection, 1 close it
+static uint8_t daemon_send(daemon_client_t *c) {
+    ssize_t w = send(c->fd, c->out.data + c->sent, c->out.len - c->sent, MSG_NOSIGNAL);
+
+    if (w < 0)
+        return errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR;
+
+    c->sent += w;
+    if (c->sent == c->out.len)
+        c->out.len = c->sent = 0;
+    return 0;
+}
+
+// 0 the path is free, a socket nobody listens on is removed, anything else is left alone
+static uint8_t daemon_claim(const struct sockaddr_un *addr) {
+    struct stat st;
+    int probe;
+
+    if (lstat(addr->sun_path, &st) != 0)
+        return errno != ENOENT;
+
+    if (!S_ISSOCK(st.st_mode)) {
+        fprintf(stderr, "%s: exists and is not a socket\n", addr->sun_path);
+        return 1;
+    }
+
+    probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe >= 0 && !connect(probe, (const struct sockaddr*) addr, sizeof(*addr))) {
+        fprintf(stderr, "%s: another server is listening there\n", addr->sun_path);
+        close(probe);
+        return 1;
+    }
+    if (probe >= 0)
+        close(probe);
+
+    return unlink(addr->sun_path) != 0;
+}
+
+static uint64_t daemon_now_ms(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+uint8_t dis_daemon(const char *socket_path) {
+    struct pollfd fds[DIS_DAEMON_CLIENTS + 1];
+    struct sockaddr_un addr;
+    uint64_t resume = 0;
+    uint8_t shutdown = 0, err = 0;
+    daemon_t *d;
+    int server;
+
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "%s: socket path too long\n", socket_path);
+        return 1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socket_path);
+
+    errno = 0;
+    if (daemon_claim(&addr)) {
+        if (errno)
+            perror(socket_path);
+        return 1;
+    }
+
+    server = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (server < 0 || bind(server, (struct sockaddr*) &addr, sizeof(addr)) || listen(server, 8)) {
+        perror(socket_path);
+        if (server >= 0)
+            close(server);
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    d = calloc(1, sizeof(daemon_t));
+
+    while (!shutdown && !err) {
+        uint64_t now = daemon_now_ms();
+        bool accepting = d->client_count < DIS_DAEMON_CLIENTS && now >= resume;
+        int timeout = now < resume ? (int) (resume - now) : -1;
+        uint32_t n = 0;
+
+        for (uint32_t i = 0; i < d->client_count; i++)
+            fds[n++] = (struct pollfd) { d->clients[i].fd, d->clients[i].out.len ? POLLOUT : POLLIN, 0 };
+        if (accepting)
+            fds[n++] = (struct pollfd) { server, POLLIN, 0 };
+
+        if (poll(fds, n, timeout) < 0) {
+            if (errno == EINTR)
+                continue;
+            perror(socket_path);
+            err = 1;
+            break;
+        }
+
+        // clients in reverse, closing one moves the last one into its slot
+        for (uint32_t i = d->client_count; i-- > 0 && !shutdown;) {
+            daemon_client_t *c = &d->clients[i];
+            uint8_t status = 0;
+
+            if (fds[i].revents & POLLOUT)
+                status = daemon_send(c);
+            else if (fds[i].revents & (POLLIN | POLLHUP | POLLERR))
+                status = daemon_receive(d, c);
+
+            shutdown = status == 2;
+            if (status)
+                daemon_close(d, c);
+        }
+
+        if (shutdown || !accepting || !(fds[n - 1].revents & POLLIN))
+            continue;
+
+        int client = accept4(server, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client >= 0) {
+            memset(&d->clients[d->client_count], 0, sizeof(daemon_client_t));
+            d->clients[d->client_count++].fd = client;
+        } else if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+            // out of descriptors or memory: stop accepting for a while instead of spinning on it
+            perror(socket_path);
+            resume = daemon_now_ms() + DIS_DAEMON_BACKOFF_MS;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNABORTED) {
+            perror(socket_path);
+            err = 1;
+        }
+    }
+
+    while (d->client_count)
+        daemon_close(d, &d->clients[0]);
+    for (uint32_t i = 0; i < DIS_DAEMON_PROGRAMS; i++)
+        daemon_program_free(&d->programs[i]);
+    dis_buffer_free(&d->response);
+    free(d);
+
+    close(server);
+    unlink(socket_path);
+    return err;
+}
@@ -0,0 +1,33 @@
+/*
+ * disassembler_daemon.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Long running server answering disassembly requests over a Unix socket.
+ *
+ * Every message is a 4 byte little endian payload length followed by the payload. Requests
+ * are tab separated fields:
+ *
+ *     FILE      path [default|alt|group]
+ *     FUNCTION  path function_path [default|alt]
+ *     RANGE     path start end          (absolute offsets, end excluded)
+ *     PING
+ *     SHUTDOWN
+ *
+ * The response payload is a status byte ('0' ok, '1' error) followed by the listing or
+ * the error message.
+ */
+
+#ifndef DISASSEMBLER_DAEMON_H_
+#define DISASSEMBLER_DAEMON_H_
+
+#include <stdint.h>
+
+#define DIS_DAEMON_PROGRAMS    64      // decoded programs kept, least recently used is dropped
+#define DIS_DAEMON_REQUEST_MAX 65536
+#define DIS_DAEMON_CLIENTS     64      // connections served at once, more wait in the backlog
+#define DIS_DAEMON_BACKOFF_MS  100     // pause in accepting after running out of descriptors
+
+uint8_t dis_daemon(const char *socket_path);
+
+#endif /* DISASSEMBLER_DAEMON_H_ */
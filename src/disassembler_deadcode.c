@@ -0,0 +1,270 @@
+/*
+ * disassembler_deadcode.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Reachability follows the same jump words dis_disassemble_section scans for labels: an
+ * unconditional JUMP or FN_RETURN ends the fallthrough. Literals are live when a reachable
+ * LITERAL/VAR_DECL/FN_DECL operand or the args/rets words reference them, directly or
+ * through the elements of a live array, dictionary or compound type.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "disassembler_utils.h"
+#include "disassembler_index.h"
+#include "disassembler_deadcode.h"
+
+static void dead_mark(const dis_function_t *f, bool *live, uint32_t *work, uint32_t *work_len, uint32_t literal) {
+    if (literal < f->literal_count && !live[literal]) {
+        live[literal] = true;
+        work[(*work_len)++] = literal;
+    }
+}
+
+static void dead_literals(const dis_index_t *idx, const dis_function_t *f, dis_deadcode_info_t *info) {
+    uint32_t *work = malloc((f->literal_count ? f->literal_count : 1) * sizeof(uint32_t)), work_len = 0;
+
+    for (uint32_t i = 0; i < info->count; i++) {
+        const dis_instruction_t *in = &info->ins[i];
+
+        if (!info->reachable[i])
+            continue;
+
+        switch (in->opcode) {
+            case DIS_OP_VAR_DECL:
+            case DIS_OP_VAR_DECL_LONG:
+            case DIS_OP_FN_DECL:
+            case DIS_OP_FN_DECL_LONG:
+                dead_mark(f, info->live, work, &work_len, in->arg[0]);
+                dead_mark(f, info->live, work, &work_len, in->arg[1]);
+                break;
+            case DIS_OP_LITERAL:
+            case DIS_OP_LITERAL_LONG:
+                dead_mark(f, info->live, work, &work_len, in->arg[0]);
+                break;
+        }
+    }
+
+    if (f->parent >= 0) {
+        dead_mark(f, info->live, work, &work_len, f->args);
+        dead_mark(f, info->live, work, &work_len, f->rets);
+    }
+
+    // compound literals hold indexes of other entries of the same cache
+    while (work_len) {
+        const dis_literal_t *lit = &f->literals[work[--work_len]];
+        const uint8_t *p = idx->program + lit->offset + 1;
+        uint16_t length = 0, element;
+
+        switch (lit->type) {
+            case DIS_LITERAL_ARRAY:
+            case DIS_LITERAL_ARRAY_INTERMEDIATE:
+            case DIS_LITERAL_DICTIONARY:
+            case DIS_LITERAL_DICTIONARY_INTERMEDIATE:
+                memcpy(&length, p, 2);
+                if (lit->type == DIS_LITERAL_DICTIONARY || lit->type == DIS_LITERAL_DICTIONARY_INTERMEDIATE)
+                    length &= ~1;
+                p += 2;
+                break;
+            case DIS_LITERAL_TYPE:
+            case DIS_LITERAL_TYPE_INTERMEDIATE:
+                length = p[0] == DIS_LITERAL_ARRAY ? 1 : p[0] == DIS_LITERAL_DICTIONARY ? 2 : 0;
+                p += 2;
+                break;
+        }
+
+        for (uint16_t e = 0; e < length; e++) {
+            memcpy(&element, p + 2 * e, 2);
+            dead_mark(f, info->live, work, &work_len, element);
+        }
+    }
+
+    free(work);
+}
+
+uint8_t dis_deadcode_analyze(const dis_index_t *idx, uint32_t fn, dis_deadcode_info_t *info) {
+    const dis_function_t *f = &idx->functions[fn];
+    uint32_t *work, work_len = 0;
+
+    memset(info, 0, sizeof(dis_deadcode_info_t));
+    if (dis_index_decode_function(idx, fn, &info->ins, &info->count))
+        return 1;
+
+    info->reachable = calloc(info->count ? info->count : 1, sizeof(bool));
+    info->live = calloc(f->literal_count ? f->literal_count : 1, sizeof(bool));
+    work = malloc((info->count ? info->count : 1) * sizeof(uint32_t));
+
+    if (info->count) {
+        info->reachable[0] = true;
+        work[work_len++] = 0;
+    }
+
+    while (work_len) {
+        uint32_t i = work[--work_len], next[2] = { i + 1, info->count };
+        const dis_instruction_t *in = &info->ins[i];
+
+        if (in->opcode == DIS_OP_SECTION_END || in->opcode == DIS_OP_EOF)
+            continue;
+
+        if (in->opcode < DIS_OP_END_OPCODES && idx->ops->args[in->opcode][2])
+            next[1] = dis_index_find_instruction(info->ins, info->count, f->code_start + in->arg[0]);
+        if (in->opcode == DIS_OP_JUMP || in->opcode == DIS_OP_FN_RETURN)
+            next[0] = info->count;
+
+        for (uint8_t n = 0; n < 2; n++) {
+            if (next[n] < info->count && !info->reachable[next[n]]) {
+                info->reachable[next[n]] = true;
+                work[work_len++] = next[n];
+            }
+        }
+    }
+    free(work);
+
+    for (uint32_t i = 0; i < info->count; i++)
+        if (!info->reachable[i] && info->ins[i].opcode != DIS_OP_SECTION_END && info->ins[i].opcode != DIS_OP_EOF)
+            info->dead_code_bytes += info->ins[i].size;
+
+    dead_literals(idx, f, info);
+
+    for (uint32_t l = 0; l < f->literal_count; l++) {
+        if (info->live[l])
+            continue;
+
+        ++info->dead_literals;
+        info->dead_literal_bytes += f->literals[l].size;
+    }
+
+    return 0;
+}
+
+void dis_deadcode_info_free(dis_deadcode_info_t *info) {
+    free(info->ins);
+    free(info->reachable);
+    free(info->live);
+    memset(info, 0, sizeof(dis_deadcode_info_t));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// body bytes of the function section a FUNCTION literal loads, size word included
+static uint32_t dead_function_bytes(const dis_index_t *idx, uint32_t fn, uint32_t literal) {
+    const dis_function_t *f = &idx->functions[fn];
+    uint32_t ordinal = 0;
+
+    for (uint32_t l = 0; l < literal; l++)
+        ordinal += f->literals[l].type == DIS_LITERAL_FUNCTION;
+
+    for (uint32_t c = fn + 1; c < idx->function_count && idx->functions[c].depth > f->depth; c++)
+        if (idx->functions[c].parent == (int32_t) fn && !ordinal--)
+            return idx->functions[c].end - idx->functions[c].start + 2;
+
+    return 0;
+}
+
+void dis_deadcode_report(char **files, uint32_t file_count, bool json) {
+    uint32_t printed = 0;
+
+    if (json)
+        printf("[");
+
+    for (uint32_t n = 0; n < file_count; n++) {
+        uint8_t *program = NULL;
+        uint32_t len = 0, wasted = 0;
+        dis_index_t idx;
+
+        if (dis_read_file(files[n], &program, &len) || dis_index_build(program, len, &idx)) {
+            fprintf(stderr, "%s: not able to decode the file\n", files[n]);
+            if (program != NULL)
+                dis_index_free(&idx);
+            free(program);
+            continue;
+        }
+
+        if (json) {
+            printf("%s\n  { \"file\": ", printed++ ? "," : "");
+            str_print_json(files[n]);
+            printf(", \"functions\": [");
+        } else
+            printf("\n.comment unreachable code and dead literals: %s\n", files[n]);
+
+        for (uint32_t i = 0, fn_printed = 0; i < idx.function_count; i++) {
+            const dis_function_t *f = &idx.functions[i];
+            dis_deadcode_info_t info;
+            uint32_t body_bytes = 0;
+
+            if (dis_deadcode_analyze(&idx, i, &info)) {
+                fprintf(stderr, "%s: %s: not able to decode the code section\n", files[n], f->path);
+                dis_deadcode_info_free(&info);
+                continue;
+            }
+
+            for (uint32_t l = 0; l < f->literal_count; l++)
+                if (!info.live[l] && f->literals[l].type == DIS_LITERAL_FUNCTION)
+                    body_bytes += dead_function_bytes(&idx, i, l);
+
+            wasted += info.dead_code_bytes + info.dead_literal_bytes + body_bytes;
+
+            if (json) {
+                printf("%s\n    { \"path\": ", fn_printed++ ? "," : "");
+                str_print_json(f->path);
+                printf(", \"code_bytes\": %u, \"dead_code_bytes\": %u, \"literals\": %u, \"dead_literals\": [", f->code_end - f->code_start,
+                        info.dead_code_bytes, f->literal_count);
+                for (uint32_t l = 0, first = 1; l < f->literal_count; l++) {
+                    if (info.live[l])
+                        continue;
+                    printf("%s%u", first ? "" : ", ", l);
+                    first = 0;
+                }
+                printf("], \"dead_literal_bytes\": %u, \"dead_function_bytes\": %u, \"unreachable\": [", info.dead_literal_bytes, body_bytes);
+            } else
+                printf("%s: unreachable: %u/%u code bytes, dead literals: %u/%u (%u bytes)%s", f->path, info.dead_code_bytes, f->code_end - f->code_start,
+                        info.dead_literals, f->literal_count, info.dead_literal_bytes, body_bytes ? "" : "\n");
+
+            if (!json && body_bytes)
+                printf(", unused function bodies: %u bytes\n", body_bytes);
+
+            // contiguous runs of unreachable instructions
+            for (uint32_t s = 0, runs = 0; s < info.count;) {
+                uint32_t e = s, bytes = 0;
+
+                while (e < info.count && !info.reachable[e] && info.ins[e].opcode != DIS_OP_SECTION_END && info.ins[e].opcode != DIS_OP_EOF)
+                    bytes += info.ins[e++].size;
+
+                if (e == s) {
+                    ++s;
+                    continue;
+                }
+
+                if (json)
+                    printf("%s{ \"offset\": %u, \"bytes\": %u }", runs++ ? ", " : "", info.ins[s].offset - f->code_start, bytes);
+                else
+                    printf("    [%05d] unreachable: %u bytes, %u instructions from %s\n", info.ins[s].offset - f->code_start, bytes, e - s,
+                            OP_STR[info.ins[s].opcode] + 7);
+                s = e;
+            }
+
+            if (json)
+                printf("] }");
+            else
+                for (uint32_t l = 0; l < f->literal_count; l++)
+                    if (!info.live[l])
+                        printf("    [%05d] dead literal: %s, %u bytes\n", l, LIT_STR[f->literals[l].type] + 12, f->literals[l].size);
+
+            dis_deadcode_info_free(&info);
+        }
+
+        if (json)
+            printf("\n  ], \"wasted_bytes\": %u }", wasted);
+        else
+            printf("wasted: %u of %u bytes\n", wasted, len);
+
+        dis_index_free(&idx);
+        free(program);
+    }
+
+    if (json)
+        printf("\n]\n");
+}
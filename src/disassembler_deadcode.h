@@ -0,0 +1,31 @@
+/*
+ * disassembler_deadcode.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Unreachable code and dead literal cache entries per function.
+ */
+
+#ifndef DISASSEMBLER_DEADCODE_H_
+#define DISASSEMBLER_DEADCODE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "disassembler_index.h"
+
+typedef struct dis_deadcode_info_s {
+    dis_instruction_t *ins;   //
+    uint32_t count;           //
+    bool *reachable;          // per instruction
+    bool *live;               // per literal cache entry
+    uint32_t dead_code_bytes; // SECTION_END/EOF markers excluded
+    uint32_t dead_literals;   //
+    uint32_t dead_literal_bytes;
+} dis_deadcode_info_t;
+
+uint8_t dis_deadcode_analyze(const dis_index_t *idx, uint32_t fn, dis_deadcode_info_t *info);
+void dis_deadcode_info_free(dis_deadcode_info_t *info);
+void dis_deadcode_report(char **files, uint32_t file_count, bool json);
+
+#endif /* DISASSEMBLER_DEADCODE_H_ */
@@ -0,0 +1,977 @@
+/*
+ * disassembler_decompile.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * The code section is walked once, each value on the operand stack is kept as the text of
+ * the expression that computed it. Statements are printed when an opcode consumes values
+ * without pushing (declarations, assignments, print...), values still on the stack when a
+ * block ends or at POP_STACK are expression statements. The compiler lays out control flow
+ * in a few fixed shapes:
+ *
+ *     if:       cond IF_FALSE_JUMP L  then               L:
+ *     if/else:  cond IF_FALSE_JUMP L  then  JUMP E  L:  else  E:
+ *     loop:  H: cond IF_FALSE_JUMP L  body  JUMP H  L:
+ *
+ * AND/OR keep their left operand aside until the instruction they jump to. Anything else
+ * is printed as a jump to its offset. Nested functions are printed where they are declared.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "disassembler_utils.h"
+#include "disassembler_index.h"
+#include "disassembler_string.h"
+#include "disassembler_decompile.h"
+
+#define DEC_NO_OFFSET UINT32_MAX
+#define DEC_LITERAL_DEPTH 32 // nesting shown for compound literals
+
+typedef enum DEC_PREC {
+    DEC_PREC_NONE,     //
+    DEC_PREC_TERNARY,  //
+    DEC_PREC_OR,       //
+    DEC_PREC_AND,      //
+    DEC_PREC_EQUALITY, //
+    DEC_PREC_COMPARE,  //
+    DEC_PREC_TERM,     //
+    DEC_PREC_FACTOR,   //
+    DEC_PREC_UNARY,    // negate, invert, typeof, casts
+    DEC_PREC_POSTFIX,  // calls, indexing, dot
+    DEC_PREC_PRIMARY,  //
+} dec_prec_t;
+
+typedef enum DEC_EXPR_KIND {
+    DEC_EXPR_VALUE,  //
+    DEC_EXPR_NULL,   // null literal, an absent index part
+    DEC_EXPR_BLANK,  // blank index part, arr[:]
+    DEC_EXPR_RAW,    // LITERAL_RAW, the value before a postfix increment
+    DEC_EXPR_HIDDEN, // compound kept by INDEX_ASSIGN_INTERMEDIATE
+} dec_expr_kind_t;
+
+typedef struct dec_expr_s {
+    char *text;      //
+    uint32_t offset; // first instruction of the expression, relative to the code start
+    uint8_t prec;    //
+    uint8_t kind;    //
+} dec_expr_t;
+
+typedef struct dec_pending_s {
+    dec_expr_t left; //
+    uint32_t target; // instruction the short-circuit jump lands on
+    uint8_t opcode;  // AND or OR
+} dec_pending_t;
+
+typedef struct dec_loop_s {
+    uint32_t head;  // instruction the back jump goes to
+    uint32_t latch; // the back jump
+    uint32_t exit;  // first instruction after the loop
+} dec_loop_t;
+
+typedef struct dec_state_s {
+    const dis_index_t *idx;
+    const dis_function_t *f;
+    uint32_t fn;
+    bool *done;              // functions already printed
+    dis_instruction_t *ins;  //
+    uint32_t count;          //
+    dec_expr_t *stack;       //
+    uint32_t depth;          //
+    dec_pending_t *pending;  //
+    uint32_t pending_count;  //
+    uint32_t indent;         //
+} dec_state_t;
+
+static const struct {
+    const char *text;
+    uint8_t prec;
+} BINARY[DIS_OP_END_OPCODES] = {
+        [DIS_OP_ADDITION]              = { "+",  DEC_PREC_TERM     },
+        [DIS_OP_SUBTRACTION]           = { "-",  DEC_PREC_TERM     },
+        [DIS_OP_MULTIPLICATION]        = { "*",  DEC_PREC_FACTOR   },
+        [DIS_OP_DIVISION]              = { "/",  DEC_PREC_FACTOR   },
+        [DIS_OP_MODULO]                = { "%",  DEC_PREC_FACTOR   },
+        [DIS_OP_COMPARE_EQUAL]         = { "==", DEC_PREC_EQUALITY },
+        [DIS_OP_COMPARE_NOT_EQUAL]     = { "!=", DEC_PREC_EQUALITY },
+        [DIS_OP_COMPARE_LESS]          = { "<",  DEC_PREC_COMPARE  },
+        [DIS_OP_COMPARE_LESS_EQUAL]    = { "<=", DEC_PREC_COMPARE  },
+        [DIS_OP_COMPARE_GREATER]       = { ">",  DEC_PREC_COMPARE  },
+        [DIS_OP_COMPARE_GREATER_EQUAL] = { ">=", DEC_PREC_COMPARE  },
+};
+
+static const char *ASSIGN[DIS_OP_END_OPCODES] = {
+        [DIS_OP_VAR_ASSIGN]                = "=",
+        [DIS_OP_VAR_ADDITION_ASSIGN]       = "+=",
+        [DIS_OP_VAR_SUBTRACTION_ASSIGN]    = "-=",
+        [DIS_OP_VAR_MULTIPLICATION_ASSIGN] = "*=",
+        [DIS_OP_VAR_DIVISION_ASSIGN]       = "/=",
+        [DIS_OP_VAR_MODULO_ASSIGN]         = "%=",
+};
+
+static const char *TYPE_NAMES[] = {
+        [DIS_LITERAL_NULL]       = "null",
+        [DIS_LITERAL_BOOLEAN]    = "bool",
+        [DIS_LITERAL_INTEGER]    = "int",
+        [DIS_LITERAL_FLOAT]      = "float",
+        [DIS_LITERAL_STRING]     = "string",
+        [DIS_LITERAL_FUNCTION]   = "fn",
+        [DIS_LITERAL_IDENTIFIER] = "identifier",
+        [DIS_LITERAL_TYPE]       = "type",
+        [DIS_LITERAL_OPAQUE]     = "opaque",
+        [DIS_LITERAL_ANY]        = "any",
+};
+
+static void dec_function(const dis_index_t *idx, uint32_t fn, bool *done, const char *name, uint32_t indent, uint32_t offset);
+
+static char* dec_format(const char *fmt, ...) {
+    va_list ap;
+    char *s;
+    int n;
+
+    va_start(ap, fmt);
+    n = vsnprintf(NULL, 0, fmt, ap);
+    va_end(ap);
+
+    s = malloc(n + 1);
+    va_start(ap, fmt);
+    vsnprintf(s, n + 1, fmt, ap);
+    va_end(ap);
+
+    return s;
+}
+
+static void dec_vline(uint32_t indent, uint32_t offset, const char *fmt, va_list ap) {
+    if (offset == DEC_NO_OFFSET)
+        printf("        %*s", (int) (4 * indent), "");
+    else
+        printf("[%05u] %*s", offset, (int) (4 * indent), "");
+
+    vprintf(fmt, ap);
+    printf("\n");
+}
+
+static void dec_line(uint32_t indent, uint32_t offset, const char *fmt, ...) {
+    va_list ap;
+
+    va_start(ap, fmt);
+    dec_vline(indent, offset, fmt, ap);
+    va_end(ap);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static uint16_t dec_word(const dis_index_t *idx, uint32_t offset) {
+    uint16_t word;
+
+    memcpy(&word, idx->program + offset, 2);
+    return word;
+}
+
+static bool dec_literal_is(const dis_function_t *f, uint32_t literal, uint8_t type) {
+    return literal < f->literal_count && f->literals[literal].type == type;
+}
+
+static char* dec_type_text(const dis_index_t *idx, const dis_function_t *f, uint32_t literal, uint32_t level) {
+    const uint8_t *p;
+    char *text, *a, *b;
+
+    if (literal >= f->literal_count || (f->literals[literal].type != DIS_LITERAL_TYPE && f->literals[literal].type != DIS_LITERAL_TYPE_INTERMEDIATE)
+            || level > DEC_LITERAL_DEPTH)
+        return strdup("?");
+
+    p = idx->program + f->literals[literal].offset + 1;
+    switch (p[0]) {
+        case DIS_LITERAL_ARRAY:
+            a = dec_type_text(idx, f, dec_word(idx, f->literals[literal].offset + 3), level + 1);
+            text = dec_format("[%s]", a);
+            free(a);
+            break;
+        case DIS_LITERAL_DICTIONARY:
+            a = dec_type_text(idx, f, dec_word(idx, f->literals[literal].offset + 3), level + 1);
+            b = dec_type_text(idx, f, dec_word(idx, f->literals[literal].offset + 5), level + 1);
+            text = dec_format("[%s: %s]", a, b);
+            free(a);
+            free(b);
+            break;
+        default:
+            text = strdup(p[0] < sizeof(TYPE_NAMES) / sizeof(TYPE_NAMES[0]) && TYPE_NAMES[p[0]] != NULL ? TYPE_NAMES[p[0]] : "?");
+            break;
+    }
+
+    if (p[1]) {
+        a = dec_format("%s const", text);
+        free(text);
+        text = a;
+    }
+
+    return text;
+}
+
+// ": type", empty for a plain any
+static char* dec_type_suffix(const dis_index_t *idx, const dis_function_t *f, uint32_t literal) {
+    char *type, *text;
+
+    if (literal < f->literal_count && f->literals[literal].type == DIS_LITERAL_TYPE) {
+        const uint8_t *p = idx->program + f->literals[literal].offset + 1;
+        if (p[0] == DIS_LITERAL_ANY && !p[1])
+            return strdup("");
+    }
+
+    type = dec_type_text(idx, f, literal, 0);
+    text = dec_format(": %s", type);
+    free(type);
+    return text;
+}
+
+static char* dec_literal_text(const dis_index_t *idx, const dis_function_t *f, uint32_t literal, uint32_t level) {
+    const dis_literal_t *lit;
+    uint16_t length;
+    char *text;
+
+    if (literal >= f->literal_count)
+        return dec_format("#%u?", literal);
+
+    lit = &f->literals[literal];
+    switch (lit->type) {
+        case DIS_LITERAL_ARRAY:
+        case DIS_LITERAL_ARRAY_INTERMEDIATE:
+        case DIS_LITERAL_DICTIONARY:
+        case DIS_LITERAL_DICTIONARY_INTERMEDIATE: {
+            bool dictionary = lit->type == DIS_LITERAL_DICTIONARY || lit->type == DIS_LITERAL_DICTIONARY_INTERMEDIATE;
+
+            length = dec_word(idx, lit->offset + 1);
+            if (dictionary)
+                length &= ~1;
+            if (!length)
+                return strdup(dictionary ? "[:]" : "[]");
+            if (level >= DEC_LITERAL_DEPTH)
+                return strdup("[...]");
+
+            text = strdup("[");
+            for (uint16_t i = 0; i < length; i++) {
+                char *element = dec_literal_text(idx, f, dec_word(idx, lit->offset + 3 + 2 * i), level + 1);
+
+                if (i)
+                    str_append(&text, dictionary && (i & 1) ? ": " : ", ");
+                str_append(&text, element);
+                free(element);
+            }
+            str_append(&text, "]");
+            return text;
+        }
+        case DIS_LITERAL_TYPE:
+        case DIS_LITERAL_TYPE_INTERMEDIATE:
+            return dec_type_text(idx, f, literal, level);
+        case DIS_LITERAL_FUNCTION:
+            return dec_format("fn#%u", dec_word(idx, lit->offset + 1));
+        case DIS_LITERAL_INDEX_BLANK:
+            return strdup("");
+        default:
+            text = malloc(DIS_ESCAPE_MAX(lit->size) + 8);
+            dis_index_literal_str(idx, f, literal, text, DIS_ESCAPE_MAX(lit->size) + 8);
+            return text;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void dec_push(dec_state_t *st, char *text, uint32_t offset, uint8_t prec, uint8_t kind) {
+    dec_expr_t *e = &st->stack[st->depth++];
+
+    e->text = text;
+    e->offset = offset;
+    e->prec = prec;
+    e->kind = kind;
+}
+
+// an empty stack gives "?", the listing shows the underflow
+static dec_expr_t dec_pop(dec_state_t *st, uint32_t offset) {
+    dec_expr_t e = { NULL, offset, DEC_PREC_PRIMARY, DEC_EXPR_VALUE };
+
+    if (!st->depth) {
+        e.text = strdup("?");
+        return e;
+    }
+
+    return st->stack[--st->depth];
+}
+
+// operand text, parenthesized when it binds weaker than prec. Takes the expression text
+static char* dec_operand(dec_expr_t e, uint8_t prec) {
+    char *text;
+
+    if (e.prec >= prec)
+        return e.text;
+
+    text = dec_format("(%s)", e.text);
+    free(e.text);
+    return text;
+}
+
+static uint32_t dec_min(uint32_t a, uint32_t b) {
+    return a < b ? a : b;
+}
+
+static void dec_literal(dec_state_t *st, uint32_t literal, uint32_t offset) {
+    uint8_t kind = DEC_EXPR_VALUE, prec = DEC_PREC_PRIMARY;
+    char *text = dec_literal_text(st->idx, st->f, literal, 0);
+
+    if (dec_literal_is(st->f, literal, DIS_LITERAL_NULL))
+        kind = DEC_EXPR_NULL;
+    else if (dec_literal_is(st->f, literal, DIS_LITERAL_INDEX_BLANK))
+        kind = DEC_EXPR_BLANK;
+    else if (text[0] == '-')
+        prec = DEC_PREC_UNARY;
+
+    dec_push(st, text, offset, prec, kind);
+}
+
+// pops compound, first, second and third, returns "compound[first]" or a slice
+static char* dec_index(dec_state_t *st, uint32_t offset, uint32_t *start) {
+    dec_expr_t third = dec_pop(st, offset), second = dec_pop(st, offset), first = dec_pop(st, offset), compound = dec_pop(st, offset);
+    char *c, *text;
+
+    *start = dec_min(compound.offset, first.offset);
+    c = dec_operand(compound, DEC_PREC_POSTFIX);
+
+    if (second.kind == DEC_EXPR_NULL && third.kind == DEC_EXPR_NULL)
+        text = dec_format("%s[%s]", c, first.kind == DEC_EXPR_NULL ? "" : first.text);
+    else if (third.kind == DEC_EXPR_NULL)
+        text = dec_format("%s[%s:%s]", c, first.kind == DEC_EXPR_NULL ? "" : first.text, second.kind == DEC_EXPR_NULL ? "" : second.text);
+    else
+        text = dec_format("%s[%s:%s:%s]", c, first.kind == DEC_EXPR_NULL ? "" : first.text, second.kind == DEC_EXPR_NULL ? "" : second.text,
+                third.text);
+
+    free(c);
+    free(first.text);
+    free(second.text);
+    free(third.text);
+    return text;
+}
+
+// argument count of FN_CALL/DOT, the integer literal pushed right before it
+static int32_t dec_argc(const dec_state_t *st, uint32_t i) {
+    int32_t argc;
+
+    if (i == 0 || (st->ins[i - 1].opcode != DIS_OP_LITERAL && st->ins[i - 1].opcode != DIS_OP_LITERAL_LONG)
+            || !dec_literal_is(st->f, st->ins[i - 1].arg[0], DIS_LITERAL_INTEGER))
+        return -1;
+
+    memcpy(&argc, st->idx->program + st->f->literals[st->ins[i - 1].arg[0]].offset + 1, 4);
+    return argc < 0 || (uint32_t) argc > st->depth ? -1 : argc;
+}
+
+// FN_CALL: callee args... argc, DOT: object method args... argc (the object counts as an argument)
+static void dec_call(dec_state_t *st, uint32_t i, uint32_t offset) {
+    int32_t argc = dec_argc(st, i);
+    uint32_t first = 0, start;
+    dec_expr_t callee;
+    char *args = strdup(""), *text;
+
+    free(dec_pop(st, offset).text);
+    if (argc < 0)
+        argc = 0;
+
+    // arguments come off the stack last first, the object of a DOT call is below the method name
+    dec_expr_t *list = malloc((argc ? argc : 1) * sizeof(dec_expr_t));
+    if (st->ins[i].opcode == DIS_OP_DOT && argc)
+        first = 1;
+    for (int32_t a = argc; a-- > (int32_t) first;)
+        list[a] = dec_pop(st, offset);
+
+    if (first) {
+        dec_expr_t method = dec_pop(st, offset);
+        char *object;
+
+        callee = dec_pop(st, offset);
+        start = callee.offset;
+        object = dec_operand(callee, DEC_PREC_POSTFIX);
+        text = dec_format("%s.%s", object, method.text);
+        free(object);
+        free(method.text);
+    } else {
+        callee = dec_pop(st, offset);
+        start = callee.offset;
+        text = dec_operand(callee, DEC_PREC_POSTFIX);
+    }
+
+    for (int32_t a = first; a < argc; a++) {
+        if (a > (int32_t) first)
+            str_append(&args, ", ");
+        str_append(&args, list[a].text);
+        free(list[a].text);
+    }
+
+    dec_push(st, dec_format("%s(%s)", text, args), start, DEC_PREC_POSTFIX, DEC_EXPR_VALUE);
+    free(text);
+    free(args);
+    free(list);
+}
+
+static void dec_binary(dec_state_t *st, uint8_t opcode, uint32_t offset) {
+    dec_expr_t right = dec_pop(st, offset), left = dec_pop(st, offset);
+    uint32_t start = dec_min(left.offset, right.offset);
+    char *l = dec_operand(left, BINARY[opcode].prec), *r = dec_operand(right, BINARY[opcode].prec + 1);
+
+    dec_push(st, dec_format("%s %s %s", l, BINARY[opcode].text, r), start, BINARY[opcode].prec, DEC_EXPR_VALUE);
+    free(l);
+    free(r);
+}
+
+static void dec_unary(dec_state_t *st, const char *op, uint32_t offset) {
+    dec_expr_t e = dec_pop(st, offset);
+    uint32_t start = e.offset;
+    char *text = dec_operand(e, DEC_PREC_UNARY);
+
+    dec_push(st, dec_format("%s%s", op, text), start, DEC_PREC_UNARY, DEC_EXPR_VALUE);
+    free(text);
+}
+
+// a && b: a AND L b L:, the left operand waits for the jump target
+static void dec_resolve(dec_state_t *st, uint32_t i) {
+    while (st->pending_count && st->pending[st->pending_count - 1].target <= i) {
+        dec_pending_t p = st->pending[--st->pending_count];
+        uint8_t prec = p.opcode == DIS_OP_AND ? DEC_PREC_AND : DEC_PREC_OR;
+        dec_expr_t right = dec_pop(st, p.left.offset);
+        uint32_t start = p.left.offset;
+        char *l = dec_operand(p.left, prec), *r = dec_operand(right, prec + 1);
+
+        dec_push(st, dec_format("%s %s %s", l, p.opcode == DIS_OP_AND ? "&&" : "||", r), start, prec, DEC_EXPR_VALUE);
+        free(l);
+        free(r);
+    }
+}
+
+// values left above base are expression statements
+static void dec_flush(dec_state_t *st, uint32_t base) {
+    for (uint32_t d = base; d < st->depth; d++) {
+        if (st->stack[d].kind != DEC_EXPR_HIDDEN)
+            dec_line(st->indent, st->stack[d].offset, "%s;", st->stack[d].text);
+        free(st->stack[d].text);
+    }
+
+    if (st->depth > base)
+        st->depth = base;
+}
+
+// values under the operands of a statement were left by earlier expression statements
+static void dec_statement(dec_state_t *st, uint32_t offset, const char *fmt, ...) {
+    va_list ap;
+
+    dec_flush(st, 0);
+    va_start(ap, fmt);
+    dec_vline(st->indent, offset, fmt, ap);
+    va_end(ap);
+}
+
+static uint32_t dec_target(const dec_state_t *st, uint32_t i) {
+    return dis_index_find_instruction(st->ins, st->count, st->f->code_start + st->ins[i].arg[0]);
+}
+
+// nested function declared by a FUNCTION literal, by its order among the FUNCTION literals
+static int32_t dec_child(const dis_index_t *idx, uint32_t fn, uint32_t literal) {
+    const dis_function_t *f = &idx->functions[fn];
+    uint32_t ordinal = 0;
+
+    if (!dec_literal_is(f, literal, DIS_LITERAL_FUNCTION))
+        return -1;
+
+    for (uint32_t l = 0; l < literal; l++)
+        ordinal += f->literals[l].type == DIS_LITERAL_FUNCTION;
+
+    for (uint32_t c = fn + 1; c < idx->function_count && idx->functions[c].depth > f->depth; c++)
+        if (idx->functions[c].parent == (int32_t) fn && !ordinal--)
+            return c;
+
+    return -1;
+}
+
+// only end markers follow instruction i
+static bool dec_last(const dec_state_t *st, uint32_t i) {
+    while (++i < st->count)
+        if (st->ins[i].opcode != DIS_OP_SECTION_END && st->ins[i].opcode != DIS_OP_EOF)
+            return false;
+    return true;
+}
+
+// break lands after the SCOPE_END that closes the loop scope
+static bool dec_break(const dec_state_t *st, const dec_loop_t *loop, uint32_t target) {
+    uint32_t i = loop->exit;
+
+    while (i < target && st->ins[i].opcode == DIS_OP_SCOPE_END)
+        ++i;
+    return i == target;
+}
+
+// continue in a for loop lands on the increment, at most one assignment before the back jump
+static bool dec_continue(const dec_state_t *st, const dec_loop_t *loop, uint32_t from, uint32_t target) {
+    uint32_t assignments = 0;
+
+    if (target == loop->head)
+        return true;
+    if (target <= from || target > loop->latch)
+        return false;
+
+    for (uint32_t i = target; i < loop->latch; i++) {
+        uint8_t op = st->ins[i].opcode;
+
+        if (op >= DIS_OP_VAR_ASSIGN && op <= DIS_OP_VAR_MODULO_ASSIGN)
+            ++assignments;
+        else if (op >= DIS_OP_END_OPCODES || OP_ARGS[op][2] || (OP_STACK[op][1] == 0 && OP_STACK[op][0] != 0))
+            return false;
+    }
+
+    return assignments <= 1;
+}
+
+static void dec_block(dec_state_t *st, uint32_t lo, uint32_t hi, const dec_loop_t *loop);
+
+static void dec_branch(dec_state_t *st, uint32_t *i, uint32_t lo, uint32_t hi, const dec_loop_t *loop, uint32_t offset) {
+    uint32_t t = dec_target(st, *i);
+    dec_expr_t cond = dec_pop(st, offset);
+
+    if (t <= *i || t > hi) {
+        dec_statement(st, cond.offset, "if (!(%s)) jump [%05u];", cond.text, st->ins[*i].arg[0]);
+        free(cond.text);
+        ++*i;
+        return;
+    }
+
+    if (t - 1 > *i && st->ins[t - 1].opcode == DIS_OP_JUMP) {
+        uint32_t j = dec_target(st, t - 1);
+
+        if (j <= *i && j >= lo) {
+            dec_loop_t body = { j, t - 1, t };
+
+            dec_statement(st, cond.offset, "while (%s) {", cond.text);
+            ++st->indent;
+            dec_block(st, *i + 1, t - 1, &body);
+            --st->indent;
+            dec_line(st->indent, DEC_NO_OFFSET, "}");
+            free(cond.text);
+            *i = t;
+            return;
+        }
+
+        if (j > t && j <= hi) {
+            dec_statement(st, cond.offset, "if (%s) {", cond.text);
+            ++st->indent;
+            dec_block(st, *i + 1, t - 1, loop);
+            --st->indent;
+            dec_line(st->indent, DEC_NO_OFFSET, "} else {");
+            ++st->indent;
+            dec_block(st, t, j, loop);
+            --st->indent;
+            dec_line(st->indent, DEC_NO_OFFSET, "}");
+            free(cond.text);
+            *i = j;
+            return;
+        }
+    }
+
+    dec_statement(st, cond.offset, "if (%s) {", cond.text);
+    ++st->indent;
+    dec_block(st, *i + 1, t, loop);
+    --st->indent;
+    dec_line(st->indent, DEC_NO_OFFSET, "}");
+    free(cond.text);
+    *i = t;
+}
+
+static void dec_block(dec_state_t *st, uint32_t lo, uint32_t hi, const dec_loop_t *loop) {
+    uint32_t base = st->depth;
+
+    for (uint32_t i = lo; i < hi;) {
+        const dis_instruction_t *in = &st->ins[i];
+        uint32_t offset = in->offset - st->f->code_start, start;
+        dec_expr_t a, b, c;
+        char *text, *type;
+
+        dec_resolve(st, i);
+        if (st->depth < base)
+            base = st->depth;
+
+        switch (in->opcode) {
+            case DIS_OP_LITERAL:
+            case DIS_OP_LITERAL_LONG:
+                dec_literal(st, in->arg[0], offset);
+                break;
+
+            case DIS_OP_LITERAL_RAW:
+                a = dec_pop(st, offset);
+                dec_push(st, a.text, a.offset, a.prec, DEC_EXPR_RAW);
+                break;
+
+            case DIS_OP_NEGATE:
+                dec_unary(st, "-", offset);
+                break;
+            case DIS_OP_INVERT:
+                dec_unary(st, "!", offset);
+                break;
+            case DIS_OP_TYPE_OF:
+                dec_unary(st, "typeof ", offset);
+                break;
+
+            case DIS_OP_TYPE_CAST:
+                b = dec_pop(st, offset);
+                a = dec_pop(st, offset);
+                start = dec_min(a.offset, b.offset);
+                text = dec_operand(b, DEC_PREC_UNARY);
+                dec_push(st, dec_format("%s %s", a.text, text), start, DEC_PREC_UNARY, DEC_EXPR_VALUE);
+                free(a.text);
+                free(text);
+                break;
+
+            case DIS_OP_ADDITION:
+            case DIS_OP_SUBTRACTION:
+            case DIS_OP_MULTIPLICATION:
+            case DIS_OP_DIVISION:
+            case DIS_OP_MODULO:
+            case DIS_OP_COMPARE_EQUAL:
+            case DIS_OP_COMPARE_NOT_EQUAL:
+            case DIS_OP_COMPARE_LESS:
+            case DIS_OP_COMPARE_LESS_EQUAL:
+            case DIS_OP_COMPARE_GREATER:
+            case DIS_OP_COMPARE_GREATER_EQUAL:
+                dec_binary(st, in->opcode, offset);
+                break;
+
+            case DIS_OP_GROUPING_END:
+                if (st->depth) {
+                    dec_expr_t *e = &st->stack[st->depth - 1];
+                    text = dec_format("(%s)", e->text);
+                    free(e->text);
+                    e->text = text;
+                    e->prec = DEC_PREC_PRIMARY;
+                }
+                break;
+
+            case DIS_OP_TERNARY:
+                c = dec_pop(st, offset);
+                b = dec_pop(st, offset);
+                a = dec_pop(st, offset);
+                start = a.offset;
+                {
+                    char *x = dec_operand(a, DEC_PREC_OR), *y = dec_operand(b, DEC_PREC_TERNARY), *z = dec_operand(c, DEC_PREC_TERNARY);
+                    dec_push(st, dec_format("%s ? %s : %s", x, y, z), start, DEC_PREC_TERNARY, DEC_EXPR_VALUE);
+                    free(x);
+                    free(y);
+                    free(z);
+                }
+                break;
+
+            case DIS_OP_INDEX:
+                text = dec_index(st, offset, &start);
+                dec_push(st, text, start, DEC_PREC_POSTFIX, DEC_EXPR_VALUE);
+                break;
+
+            case DIS_OP_INDEX_ASSIGN_INTERMEDIATE:
+                text = dec_index(st, offset, &start);
+                dec_push(st, strdup(""), start, DEC_PREC_PRIMARY, DEC_EXPR_HIDDEN);
+                dec_push(st, text, start, DEC_PREC_POSTFIX, DEC_EXPR_VALUE);
+                break;
+
+            case DIS_OP_INDEX_ASSIGN:
+                b = dec_pop(st, offset);
+                text = dec_index(st, offset, &start);
+                dec_statement(st, start, "%s %s %s;", text, in->arg[0] < DIS_OP_END_OPCODES && ASSIGN[in->arg[0]] ? ASSIGN[in->arg[0]] : "=", b.text);
+                free(text);
+                free(b.text);
+                while (st->depth && st->stack[st->depth - 1].kind == DEC_EXPR_HIDDEN)
+                    free(st->stack[--st->depth].text);
+                break;
+
+            case DIS_OP_FN_CALL:
+            case DIS_OP_DOT:
+                dec_call(st, i, offset);
+                break;
+
+            case DIS_OP_AND:
+            case DIS_OP_OR: {
+                uint32_t t = dec_target(st, i);
+
+                if (t <= i || t >= st->count)
+                    break;
+                st->pending[st->pending_count].left = dec_pop(st, offset);
+                st->pending[st->pending_count].target = t;
+                st->pending[st->pending_count++].opcode = in->opcode;
+            }
+                break;
+
+            case DIS_OP_VAR_DECL:
+            case DIS_OP_VAR_DECL_LONG:
+                a = dec_pop(st, offset);
+                text = dec_literal_text(st->idx, st->f, in->arg[0], 0);
+                type = dec_type_suffix(st->idx, st->f, in->arg[1]);
+                dec_statement(st, dec_min(a.offset, offset), "var %s%s = %s;", text, type, a.text);
+                free(text);
+                free(type);
+                free(a.text);
+                break;
+
+            case DIS_OP_FN_DECL:
+            case DIS_OP_FN_DECL_LONG: {
+                int32_t child = dec_child(st->idx, st->fn, in->arg[1]);
+
+                dec_flush(st, 0);
+                text = dec_literal_text(st->idx, st->f, in->arg[0], 0);
+                if (child < 0)
+                    dec_statement(st, offset, "fn %s(?) {}", text);
+                else
+                    dec_function(st->idx, child, st->done, text, st->indent, offset);
+                free(text);
+            }
+                break;
+
+            case DIS_OP_VAR_ASSIGN:
+            case DIS_OP_VAR_ADDITION_ASSIGN:
+            case DIS_OP_VAR_SUBTRACTION_ASSIGN:
+            case DIS_OP_VAR_MULTIPLICATION_ASSIGN:
+            case DIS_OP_VAR_DIVISION_ASSIGN:
+            case DIS_OP_VAR_MODULO_ASSIGN:
+                b = dec_pop(st, offset);
+                a = dec_pop(st, offset);
+
+                // i++ is "LITERAL i, LITERAL_RAW" then i = i + 1, the raw value stays
+                if (in->opcode == DIS_OP_VAR_ASSIGN && st->depth && st->stack[st->depth - 1].kind == DEC_EXPR_RAW
+                        && !strcmp(st->stack[st->depth - 1].text, a.text)) {
+                    text = dec_format("%s + 1", a.text);
+                    type = dec_format("%s - 1", a.text);
+                    if (!strcmp(b.text, text) || !strcmp(b.text, type)) {
+                        dec_expr_t *e = &st->stack[st->depth - 1];
+                        char *postfix = dec_format("%s%s", e->text, strcmp(b.text, text) ? "--" : "++");
+
+                        free(e->text);
+                        e->text = postfix;
+                        e->prec = DEC_PREC_POSTFIX;
+                        e->kind = DEC_EXPR_VALUE;
+                        free(text);
+                        free(type);
+                        free(a.text);
+                        free(b.text);
+                        break;
+                    }
+                    free(text);
+                    free(type);
+                }
+
+                dec_statement(st, a.offset, "%s %s %s;", a.text, ASSIGN[in->opcode], b.text);
+                free(a.text);
+                free(b.text);
+                break;
+
+            case DIS_OP_IMPORT:
+                b = dec_pop(st, offset);
+                a = dec_pop(st, offset);
+                if (b.kind == DEC_EXPR_NULL)
+                    dec_statement(st, a.offset, "import %s;", a.text);
+                else
+                    dec_statement(st, a.offset, "import %s as %s;", a.text, b.text);
+                free(a.text);
+                free(b.text);
+                break;
+
+            case DIS_OP_PRINT:
+                a = dec_pop(st, offset);
+                dec_statement(st, a.offset, "print %s;", a.text);
+                free(a.text);
+                break;
+
+            case DIS_OP_ASSERT:
+                b = dec_pop(st, offset);
+                a = dec_pop(st, offset);
+                dec_statement(st, a.offset, "assert %s, %s;", a.text, b.text);
+                free(a.text);
+                free(b.text);
+                break;
+
+            case DIS_OP_FN_RETURN: {
+                uint32_t n = in->arg[0] < st->depth ? in->arg[0] : st->depth;
+                char *values = strdup("");
+
+                // the compiler adds a bare return at the end of every function
+                if (!n && dec_last(st, i))
+                    break;
+
+                start = offset;
+                for (uint32_t v = st->depth - n; v < st->depth; v++) {
+                    str_append(&values, v > st->depth - n ? ", " : " ");
+                    str_append(&values, st->stack[v].text);
+                    start = dec_min(start, st->stack[v].offset);
+                    free(st->stack[v].text);
+                }
+                st->depth -= n;
+                dec_statement(st, start, "return%s;", values);
+                free(values);
+            }
+                break;
+
+            case DIS_OP_POP_STACK:
+                dec_flush(st, 0);
+                break;
+
+            case DIS_OP_IF_FALSE_JUMP:
+                dec_branch(st, &i, lo, hi, loop, offset);
+                continue;
+
+            case DIS_OP_JUMP: {
+                uint32_t t = dec_target(st, i);
+
+                if (loop != NULL && dec_break(st, loop, t))
+                    dec_statement(st, offset, "break;");
+                else if (loop != NULL && dec_continue(st, loop, i, t))
+                    dec_statement(st, offset, "continue;");
+                else
+                    dec_statement(st, offset, "jump [%05u];", in->arg[0]);
+            }
+                break;
+
+            case DIS_OP_PASS:
+                dec_statement(st, offset, "pass;");
+                break;
+
+            case DIS_OP_GROUPING_BEGIN:
+            case DIS_OP_SCOPE_BEGIN:
+            case DIS_OP_SCOPE_END:
+            case DIS_OP_FN_END:
+            case DIS_OP_SECTION_END:
+            case DIS_OP_EOF:
+                break;
+
+            default:
+                dec_statement(st, offset, "// %s", in->opcode < DIS_OP_END_OPCODES && OP_STR[in->opcode] ? OP_STR[in->opcode] + 7 : "(OP UNKNOWN)");
+                break;
+        }
+
+        ++i;
+    }
+
+    dec_resolve(st, hi);
+    dec_flush(st, st->depth < base ? st->depth : base);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// "name: type" pairs of the args literal, "...name" for the rest parameter
+static char* dec_params(const dis_index_t *idx, const dis_function_t *f) {
+    char *params = strdup("");
+    uint16_t length;
+
+    if (!dec_literal_is(f, f->args, DIS_LITERAL_ARRAY))
+        return params;
+
+    length = dec_word(idx, f->literals[f->args].offset + 1);
+    for (uint16_t i = 0; i + 1 < length; i += 2) {
+        uint16_t name = dec_word(idx, f->literals[f->args].offset + 3 + 2 * i), type = dec_word(idx, f->literals[f->args].offset + 5 + 2 * i);
+        char *n = dec_literal_text(idx, f, name, 0), *t;
+
+        if (i)
+            str_append(&params, ", ");
+        if (dec_literal_is(f, type, DIS_LITERAL_FUNCTION_ARG_REST)) {
+            str_append(&params, "...");
+            str_append(&params, n);
+        } else {
+            t = dec_type_suffix(idx, f, type);
+            str_append(&params, n);
+            str_append(&params, t);
+            free(t);
+        }
+        free(n);
+    }
+
+    return params;
+}
+
+static char* dec_returns(const dis_index_t *idx, const dis_function_t *f) {
+    char *rets = strdup("");
+    uint16_t length;
+
+    if (!dec_literal_is(f, f->rets, DIS_LITERAL_ARRAY))
+        return rets;
+
+    length = dec_word(idx, f->literals[f->rets].offset + 1);
+    for (uint16_t i = 0; i < length; i++) {
+        char *t = dec_type_text(idx, f, dec_word(idx, f->literals[f->rets].offset + 3 + 2 * i), 0);
+
+        str_append(&rets, i ? ", " : ": ");
+        str_append(&rets, t);
+        free(t);
+    }
+
+    return rets;
+}
+
+// name NULL prints MAIN without a header, offset is where the parent declares the function
+static void dec_function(const dis_index_t *idx, uint32_t fn, bool *done, const char *name, uint32_t indent, uint32_t offset) {
+    dec_state_t st = { 0 };
+
+    done[fn] = true;
+    st.idx = idx;
+    st.f = &idx->functions[fn];
+    st.fn = fn;
+    st.done = done;
+    st.indent = indent;
+
+    if (name != NULL) {
+        char *params = dec_params(idx, st.f), *rets = dec_returns(idx, st.f);
+
+        dec_line(indent, offset, "fn %s(%s)%s {", name, params, rets);
+        free(params);
+        free(rets);
+        ++st.indent;
+    }
+
+    if (dis_index_decode_function(idx, fn, &st.ins, &st.count))
+        dec_line(st.indent, DEC_NO_OFFSET, "// not able to decode the code section of %s", st.f->path);
+
+    // an instruction pushes at most two values, plus one when a parked AND/OR operand is resolved
+    st.stack = malloc((3 * st.count + 1) * sizeof(dec_expr_t));
+    st.pending = malloc((st.count + 1) * sizeof(dec_pending_t));
+
+    dec_block(&st, 0, st.count, NULL);
+    for (uint32_t p = 0; p < st.pending_count; p++)
+        free(st.pending[p].left.text);
+
+    if (name != NULL)
+        dec_line(indent, DEC_NO_OFFSET, "}");
+
+    free(st.stack);
+    free(st.pending);
+    free(st.ins);
+}
+
+void dis_decompile_report(char **files, uint32_t file_count) {
+    for (uint32_t n = 0; n < file_count; n++) {
+        uint8_t *program = NULL;
+        uint32_t len = 0;
+        dis_index_t idx;
+
+        if (dis_read_file(files[n], &program, &len) || dis_index_build(program, len, &idx)) {
+            fprintf(stderr, "%s: not able to decode the file\n", files[n]);
+            if (program != NULL)
+                dis_index_free(&idx);
+            free(program);
+            continue;
+        }
+
+        bool *done = calloc(idx.function_count ? idx.function_count : 1, sizeof(bool));
+
+        printf("\n.comment decompiled: %s\n", files[n]);
+        dec_function(&idx, 0, done, NULL, 0, 0);
+
+        // functions only used as values are not declared anywhere
+        for (uint32_t i = 1; i < idx.function_count; i++) {
+            if (done[i])
+                continue;
+            printf("\n.comment %s\n", idx.functions[i].path);
+            dec_function(&idx, i, done, idx.functions[i].path, 0, DEC_NO_OFFSET);
+        }
+
+        free(done);
+        dis_index_free(&idx);
+        free(program);
+    }
+}
@@ -0,0 +1,18 @@
+/*
+ * disassembler_decompile.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Toy-like pseudo source rebuilt from the operand stack: expressions, calls, assignments,
+ * index/dot chains, if/else and loops. Every statement carries the code offset of its first
+ * instruction so it can be read next to the listing.
+ */
+
+#ifndef DISASSEMBLER_DECOMPILE_H_
+#define DISASSEMBLER_DECOMPILE_H_
+
+#include <stdint.h>
+
+void dis_decompile_report(char **files, uint32_t file_count);
+
+#endif /* DISASSEMBLER_DECOMPILE_H_ */
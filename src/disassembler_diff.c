@@ -0,0 +1,401 @@
+/*
+ * disassembler_diff.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Functions are paired by tree path and compared by hashes of their literal cache and code
+ * first, so only functions that actually changed are decoded. Changed sections are rendered
+ * as offset independent tokens: literal operands by value and jump targets as labels
+ * numbered in code order, so an insertion does not show up as a change of every later jump.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "disassembler_utils.h"
+#include "disassembler_index.h"
+#include "disassembler_diff.h"
+
+#define DIFF_TEXT_MAX 96
+#define DIFF_LCS_MAX  (1 << 22) // cells of the LCS table before falling back to a block replace
+
+typedef struct diff_token_s {
+    uint64_t hash;               //
+    uint32_t offset;             // code offset or literal index, shown in the listing
+    char text[DIFF_TEXT_MAX];    //
+} diff_token_t;
+
+typedef struct diff_stats_s {
+    uint32_t same;
+    uint32_t changed;
+    uint32_t added;
+    uint32_t removed;
+} diff_stats_t;
+
+typedef struct diff_file_s {
+    const char *rel; // path below the corpus root
+    char *full;      //
+} diff_file_t;
+
+static void diff_line(char sign, const diff_token_t *t) {
+    printf("    %c [%05u] %s\n", sign, t->offset, t->text);
+}
+
+// prints the edit script between a and b, common prefix and suffix are never put in the table
+static uint32_t diff_tokens(const diff_token_t *a, uint32_t na, const diff_token_t *b, uint32_t nb) {
+    uint32_t pre = 0, suf = 0, n, m, changes = 0, i = 0, j = 0;
+    uint32_t *lcs = NULL;
+
+#define SAME(x, y) ((x)->hash == (y)->hash && !strcmp((x)->text, (y)->text))
+    while (pre < na && pre < nb && SAME(&a[pre], &b[pre]))
+        ++pre;
+    while (suf < na - pre && suf < nb - pre && SAME(&a[na - 1 - suf], &b[nb - 1 - suf]))
+        ++suf;
+
+    a += pre;
+    b += pre;
+    n = na - pre - suf;
+    m = nb - pre - suf;
+
+    if ((uint64_t) (n + 1) * (m + 1) <= DIFF_LCS_MAX) {
+        lcs = calloc((size_t) (n + 1) * (m + 1), sizeof(uint32_t));
+
+#define LCS(x, y) lcs[(size_t) (x) * (m + 1) + (y)]
+        for (uint32_t x = n; x-- > 0;)
+            for (uint32_t y = m; y-- > 0;)
+                LCS(x, y) = SAME(&a[x], &b[y]) ? LCS(x + 1, y + 1) + 1 :
+                            LCS(x + 1, y) >= LCS(x, y + 1) ? LCS(x + 1, y) : LCS(x, y + 1);
+
+        while (i < n && j < m) {
+            if (SAME(&a[i], &b[j])) {
+                ++i;
+                ++j;
+            } else if (LCS(i + 1, j) >= LCS(i, j + 1)) {
+                diff_line('-', &a[i++]);
+                ++changes;
+            } else {
+                diff_line('+', &b[j++]);
+                ++changes;
+            }
+        }
+#undef LCS
+        free(lcs);
+    }
+#undef SAME
+
+    for (; i < n; i++, changes++)
+        diff_line('-', &a[i]);
+    for (; j < m; j++, changes++)
+        diff_line('+', &b[j]);
+
+    return changes;
+}
+
+static void diff_token_hash(diff_token_t *t) {
+    t->hash = dis_hash(t->text, strlen(t->text), DIS_HASH_SEED);
+}
+
+static diff_token_t* diff_literal_tokens(const dis_index_t *idx, const dis_function_t *f) {
+    diff_token_t *tokens = malloc((f->literal_count ? f->literal_count : 1) * sizeof(diff_token_t));
+
+    for (uint32_t l = 0; l < f->literal_count; l++) {
+        tokens[l].offset = l;
+        dis_index_literal_str(idx, f, l, tokens[l].text, DIFF_TEXT_MAX);
+        diff_token_hash(&tokens[l]);
+    }
+
+    return tokens;
+}
+
+static int diff_cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t*) a, y = *(const uint32_t*) b;
+    return x < y ? -1 : x > y;
+}
+
+static diff_token_t* diff_code_tokens(const dis_index_t *idx, uint32_t fn, uint32_t *count) {
+    const dis_function_t *f = &idx->functions[fn];
+    dis_instruction_t *ins = NULL;
+    diff_token_t *tokens;
+    uint32_t *labels, label_count = 0;
+    char s[2][DIFF_TEXT_MAX / 3];
+
+    dis_index_decode_function(idx, fn, &ins, count);
+    tokens = malloc((*count ? *count : 1) * sizeof(diff_token_t));
+    labels = malloc((*count ? *count : 1) * sizeof(uint32_t));
+
+    for (uint32_t i = 0; i < *count; i++)
+        if (ins[i].opcode < DIS_OP_END_OPCODES && OP_ARGS[ins[i].opcode][2])
+            labels[label_count++] = ins[i].arg[0];
+    qsort(labels, label_count, sizeof(uint32_t), diff_cmp_u32);
+    for (uint32_t i = 0, unique = 0; i < label_count; i++) {
+        if (!unique || labels[i] != labels[unique - 1])
+            labels[unique++] = labels[i];
+        if (i == label_count - 1)
+            label_count = unique;
+    }
+
+    for (uint32_t i = 0; i < *count; i++) {
+        const dis_instruction_t *in = &ins[i];
+        diff_token_t *t = &tokens[i];
+        uint32_t *label;
+
+        t->offset = in->offset - f->code_start;
+
+        if (in->opcode == DIS_OP_SECTION_END)
+            snprintf(t->text, DIFF_TEXT_MAX, "SECTION_END");
+        else if (in->opcode >= DIS_OP_END_OPCODES)
+            snprintf(t->text, DIFF_TEXT_MAX, "0x%02x", in->opcode);
+        else if (OP_ARGS[in->opcode][2]) {
+            label = bsearch(&in->arg[0], labels, label_count, sizeof(uint32_t), diff_cmp_u32);
+            snprintf(t->text, DIFF_TEXT_MAX, "%-16s L%u", OP_STR[in->opcode] + 7, (uint32_t) (label - labels));
+        } else {
+            switch (in->opcode) {
+                case DIS_OP_LITERAL:
+                case DIS_OP_LITERAL_LONG:
+                    dis_index_literal_str(idx, f, in->arg[0], s[0], sizeof(s[0]));
+                    snprintf(t->text, DIFF_TEXT_MAX, "%-16s %s", "LITERAL", s[0]);
+                    break;
+                case DIS_OP_VAR_DECL:
+                case DIS_OP_VAR_DECL_LONG:
+                case DIS_OP_FN_DECL:
+                case DIS_OP_FN_DECL_LONG:
+                    dis_index_literal_str(idx, f, in->arg[0], s[0], sizeof(s[0]));
+                    dis_index_literal_str(idx, f, in->arg[1], s[1], sizeof(s[1]));
+                    snprintf(t->text, DIFF_TEXT_MAX, "%-16s %s: %s",
+                            in->opcode == DIS_OP_VAR_DECL || in->opcode == DIS_OP_VAR_DECL_LONG ? "VAR_DECL" : "FN_DECL", s[0], s[1]);
+                    break;
+                default:
+                    if (OP_ARGS[in->opcode][1] != DIS_ARG_NONE)
+                        snprintf(t->text, DIFF_TEXT_MAX, "%-16s %u %u", OP_STR[in->opcode] + 7, in->arg[0], in->arg[1]);
+                    else if (OP_ARGS[in->opcode][0] != DIS_ARG_NONE)
+                        snprintf(t->text, DIFF_TEXT_MAX, "%-16s %u", OP_STR[in->opcode] + 7, in->arg[0]);
+                    else
+                        snprintf(t->text, DIFF_TEXT_MAX, "%s", OP_STR[in->opcode] + 7);
+                    break;
+            }
+        }
+
+        diff_token_hash(t);
+    }
+
+    // labels are shown where they land
+    for (uint32_t i = 0, l = 0; i < *count && l < label_count; i++) {
+        while (l < label_count && labels[l] < tokens[i].offset)
+            ++l;
+        if (l < label_count && labels[l] == tokens[i].offset) {
+            size_t used = strlen(tokens[i].text);
+            snprintf(tokens[i].text + used, DIFF_TEXT_MAX - used, "  ; L%u:", l);
+            diff_token_hash(&tokens[i]);
+        }
+    }
+
+    free(labels);
+    free(ins);
+    return tokens;
+}
+
+static uint64_t diff_hash_literals(const dis_index_t *idx, const dis_function_t *f) {
+    return dis_hash(idx->program + f->start, f->lit_end - f->start, DIS_HASH_SEED);
+}
+
+static uint64_t diff_hash_code(const dis_index_t *idx, const dis_function_t *f) {
+    uint64_t hash = dis_hash(&f->args, sizeof(f->args), DIS_HASH_SEED);
+
+    hash = dis_hash(&f->rets, sizeof(f->rets), hash);
+    return dis_hash(idx->program + f->code_start, f->code_end - f->code_start, hash);
+}
+
+static int diff_cmp_path(const void *a, const void *b) {
+    return strcmp((*(const dis_function_t* const*) a)->path, (*(const dis_function_t* const*) b)->path);
+}
+
+static void diff_function(const dis_index_t *a, uint32_t fa, const dis_index_t *b, uint32_t fb, diff_stats_t *stats) {
+    const dis_function_t *x = &a->functions[fa], *y = &b->functions[fb];
+    uint64_t lit[2] = { diff_hash_literals(a, x), diff_hash_literals(b, y) };
+    uint64_t code[2] = { diff_hash_code(a, x), diff_hash_code(b, y) };
+    uint32_t changes = 0;
+
+    if (lit[0] == lit[1] && code[0] == code[1]) {
+        ++stats->same;
+        return;
+    }
+
+    ++stats->changed;
+    printf("~ %s: %u -> %u literals, %u -> %u code bytes\n", x->path, x->literal_count, y->literal_count, x->code_end - x->code_start,
+            y->code_end - y->code_start);
+
+    if (lit[0] != lit[1]) {
+        diff_token_t *ta = diff_literal_tokens(a, x), *tb = diff_literal_tokens(b, y);
+
+        printf("    .comment literals\n");
+        changes += diff_tokens(ta, x->literal_count, tb, y->literal_count);
+        free(ta);
+        free(tb);
+    }
+
+    if (code[0] != code[1]) {
+        uint32_t na, nb;
+        diff_token_t *ta = diff_code_tokens(a, fa, &na), *tb = diff_code_tokens(b, fb, &nb);
+
+        printf("    .comment code\n");
+        changes += diff_tokens(ta, na, tb, nb);
+        free(ta);
+        free(tb);
+    }
+
+    if (!changes)
+        printf("    .comment literal indexes renumbered only\n");
+}
+
+static uint8_t diff_file(const char *na, const char *nb, bool quiet) {
+    uint8_t *pa = NULL, *pb = NULL, ret = 0;
+    uint32_t la = 0, lb = 0;
+    dis_index_t a, b;
+    diff_stats_t stats = { 0, 0, 0, 0 };
+    const dis_function_t **sorted;
+
+    if (dis_read_file(na, &pa, &la) || dis_read_file(nb, &pb, &lb)) {
+        fprintf(stderr, "%s: not able to read the file\n", pa == NULL ? na : nb);
+        free(pa);
+        return 1;
+    }
+
+    // identical files never get decoded
+    if (la == lb && !memcmp(pa, pb, la)) {
+        if (!quiet)
+            printf(".comment identical: %s %s\n", na, nb);
+        free(pa);
+        free(pb);
+        return 0;
+    }
+
+    printf("\n.comment diff: %s -> %s\n", na, nb);
+
+    if (dis_index_build(pa, la, &a) | dis_index_build(pb, lb, &b)) {
+        printf(".comment not able to decode, files differ\n");
+        dis_index_free(&a);
+        dis_index_free(&b);
+        free(pa);
+        free(pb);
+        return 1;
+    }
+
+    if (a.major != b.major || a.minor != b.minor || a.patch != b.patch || strcmp(a.build, b.build))
+        printf(".comment header: %d.%d.%d \"%s\" -> %d.%d.%d \"%s\"\n", a.major, a.minor, a.patch, a.build, b.major, b.minor, b.patch, b.build);
+
+    sorted = malloc(b.function_count * sizeof(dis_function_t*));
+    for (uint32_t i = 0; i < b.function_count; i++)
+        sorted[i] = &b.functions[i];
+    qsort(sorted, b.function_count, sizeof(dis_function_t*), diff_cmp_path);
+
+    bool *matched = calloc(b.function_count, sizeof(bool));
+
+    for (uint32_t i = 0; i < a.function_count; i++) {
+        const dis_function_t *key = &a.functions[i];
+        const dis_function_t **found = bsearch(&key, sorted, b.function_count, sizeof(dis_function_t*), diff_cmp_path);
+
+        if (found == NULL) {
+            printf("- %s: removed, %u code bytes\n", key->path, key->code_end - key->code_start);
+            ++stats.removed;
+            continue;
+        }
+
+        matched[*found - b.functions] = true;
+        diff_function(&a, i, &b, *found - b.functions, &stats);
+    }
+
+    for (uint32_t i = 0; i < b.function_count; i++) {
+        if (matched[i])
+            continue;
+        printf("+ %s: added, %u code bytes\n", b.functions[i].path, b.functions[i].code_end - b.functions[i].code_start);
+        ++stats.added;
+    }
+
+    printf(".comment functions: %u identical, %u changed, %u added, %u removed\n", stats.same, stats.changed, stats.added, stats.removed);
+    ret = 1;
+
+    free(matched);
+    free(sorted);
+    dis_index_free(&a);
+    dis_index_free(&b);
+    free(pa);
+    free(pb);
+    return ret;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static int diff_cmp_rel(const void *a, const void *b) {
+    return strcmp(((const diff_file_t*) a)->rel, ((const diff_file_t*) b)->rel);
+}
+
+static diff_file_t* diff_collect(const char *root, uint32_t *count) {
+    char **files = NULL;
+    diff_file_t *list;
+    size_t root_len = strlen(root);
+
+    *count = 0;
+    dis_collect_files(root, ".tb", &files, count);
+    list = malloc((*count ? *count : 1) * sizeof(diff_file_t));
+
+    for (uint32_t i = 0; i < *count; i++) {
+        list[i].full = files[i];
+        list[i].rel = files[i] + root_len;
+        while (*list[i].rel == '/')
+            ++list[i].rel;
+    }
+
+    free(files);
+    qsort(list, *count, sizeof(diff_file_t), diff_cmp_rel);
+    return list;
+}
+
+uint8_t dis_diff(const char *a, const char *b) {
+    struct stat sa, sb;
+    diff_file_t *la, *lb;
+    uint32_t ca, cb, i = 0, j = 0, same = 0, changed = 0, only_a = 0, only_b = 0;
+
+    if (stat(a, &sa) != 0 || stat(b, &sb) != 0 || S_ISDIR(sa.st_mode) != S_ISDIR(sb.st_mode)) {
+        fprintf(stderr, "diff needs two files or two directories\n");
+        return 1;
+    }
+
+    if (!S_ISDIR(sa.st_mode))
+        return diff_file(a, b, false);
+
+    // corpus: pair files by path below each root
+    la = diff_collect(a, &ca);
+    lb = diff_collect(b, &cb);
+
+    while (i < ca || j < cb) {
+        int cmp = i == ca ? 1 : j == cb ? -1 : strcmp(la[i].rel, lb[j].rel);
+
+        if (cmp < 0) {
+            printf(".comment only in %s: %s\n", a, la[i++].rel);
+            ++only_a;
+        } else if (cmp > 0) {
+            printf(".comment only in %s: %s\n", b, lb[j++].rel);
+            ++only_b;
+        } else {
+            if (diff_file(la[i].full, lb[j].full, true))
+                ++changed;
+            else
+                ++same;
+            ++i;
+            ++j;
+        }
+    }
+
+    printf("\n.comment files: %u identical, %u changed, %u only in %s, %u only in %s\n", same, changed, only_a, a, only_b, b);
+
+    for (i = 0; i < ca; i++)
+        free(la[i].full);
+    for (j = 0; j < cb; j++)
+        free(lb[j].full);
+    free(la);
+    free(lb);
+
+    return changed || only_a || only_b;
+}
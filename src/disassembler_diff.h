@@ -0,0 +1,16 @@
+/*
+ * disassembler_diff.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Structural diff of two bytecode files (or two directories of them) by function path.
+ */
+
+#ifndef DISASSEMBLER_DIFF_H_
+#define DISASSEMBLER_DIFF_H_
+
+#include <stdint.h>
+
+uint8_t dis_diff(const char *a, const char *b);
+
+#endif /* DISASSEMBLER_DIFF_H_ */
@@ -0,0 +1,364 @@
+/*
+ * disassembler_dupes.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * A function body (literal cache, nested functions, args/rets and code) doesn't depend on
+ * where the function sits in the tree: jumps are relative to its code and literal operands
+ * index its own cache. So every function other than MAIN is hashed as is for the exact
+ * groups, and once more with the values of scalar literals (booleans, numbers, strings and
+ * identifiers) left out for the near groups: same code over different constants or names.
+ *
+ * The first copy met of an exact group is kept, every later one is duplicated bytes
+ * unless it sits inside a copy already counted.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "disassembler_utils.h"
+#include "disassembler_index.h"
+#include "disassembler_dupes.h"
+
+typedef struct dupe_member_s {
+    uint32_t file;   //
+    char *path;      //
+    uint32_t size;   // body bytes, size word included
+    int32_t parent;  // member of the enclosing function, -1 under MAIN
+    uint32_t exact;  // exact group
+    uint32_t near;   // near group
+    bool redundant;  // a later copy of its exact group
+    bool inside;     // within a redundant copy
+    int32_t next[2]; // next member of the same exact and near group, -1 ends
+} dupe_member_t;
+
+typedef struct dupe_group_s {
+    uint64_t key;      // body hash
+    uint32_t count;    // members linked
+    uint32_t seen;     // every function hashed to it, nested ones included
+    uint32_t variants; // exact groups within a near group
+    bool linked;       // exact group already counted as a variant
+    uint32_t min_size, max_size;
+    uint64_t bytes;    // duplicated (exact) or foldable (near) bytes
+    int32_t first, last;
+} dupe_group_t;
+
+typedef struct dupe_table_s {
+    uint8_t list;         // member next[] used by the table
+    uint32_t *slots;      // group + 1, 0 is an empty slot
+    uint32_t capacity;    // power of two
+    dupe_group_t *groups; //
+    uint32_t count;       //
+    uint32_t group_capacity;
+} dupe_table_t;
+
+typedef struct dupes_s {
+    char **files;
+    uint32_t file_count;
+    dupe_member_t *members;
+    uint32_t member_count;
+    uint32_t member_capacity;
+    dupe_table_t exact;
+    dupe_table_t near;
+} dupes_t;
+
+static inline uint32_t dupe_slot(uint64_t key, uint32_t mask) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (uint32_t) key & mask;
+}
+
+static void dupe_grow(dupe_table_t *table) {
+    uint32_t *old = table->slots, old_capacity = table->capacity;
+
+    table->capacity = old_capacity ? old_capacity * 2 : 4096;
+    table->slots = calloc(table->capacity, sizeof(uint32_t));
+
+    for (uint32_t i = 0; i < old_capacity; i++) {
+        if (!old[i])
+            continue;
+
+        uint32_t slot = dupe_slot(table->groups[old[i] - 1].key, table->capacity - 1);
+        while (table->slots[slot])
+            slot = (slot + 1) & (table->capacity - 1);
+        table->slots[slot] = old[i];
+    }
+
+    free(old);
+}
+
+// group of key, created empty the first time
+static uint32_t dupe_group(dupe_table_t *table, uint64_t key) {
+    if ((table->count + 1) * 10 >= table->capacity * 7)
+        dupe_grow(table);
+
+    uint32_t slot = dupe_slot(key, table->capacity - 1);
+    while (table->slots[slot] && table->groups[table->slots[slot] - 1].key != key)
+        slot = (slot + 1) & (table->capacity - 1);
+
+    if (table->slots[slot])
+        return table->slots[slot] - 1;
+
+    if (table->count == table->group_capacity) {
+        table->group_capacity = table->group_capacity ? table->group_capacity * 2 : 1024;
+        table->groups = realloc(table->groups, table->group_capacity * sizeof(dupe_group_t));
+    }
+
+    dupe_group_t *g = &table->groups[table->count];
+    memset(g, 0, sizeof(dupe_group_t));
+    g->key = key;
+    g->first = g->last = -1;
+    table->slots[slot] = ++table->count;
+
+    return table->count - 1;
+}
+
+static void dupe_link(dupe_table_t *table, uint32_t group, dupe_member_t *members, uint32_t m) {
+    dupe_group_t *g = &table->groups[group];
+
+    members[m].next[table->list] = -1;
+    if (g->last < 0)
+        g->first = m;
+    else
+        members[g->last].next[table->list] = m;
+    g->last = m;
+
+    if (!g->count++ || members[m].size < g->min_size)
+        g->min_size = members[m].size;
+    if (members[m].size > g->max_size)
+        g->max_size = members[m].size;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// literal cache, args/rets and code of fn and every function nested in it, scalar values left out
+static uint64_t dupe_shape(const dis_index_t *idx, uint32_t fn) {
+    uint64_t hash = DIS_HASH_SEED;
+
+    for (uint32_t j = fn; j < idx->function_count && (j == fn || idx->functions[j].depth > idx->functions[fn].depth); j++) {
+        const dis_function_t *f = &idx->functions[j];
+
+        hash = dis_hash(&f->literal_count, sizeof(f->literal_count), hash);
+        for (uint32_t l = 0; l < f->literal_count; l++) {
+            const dis_literal_t *lit = &f->literals[l];
+
+            switch (lit->type) {
+                case DIS_LITERAL_BOOLEAN:
+                case DIS_LITERAL_INTEGER:
+                case DIS_LITERAL_FLOAT:
+                case DIS_LITERAL_STRING:
+                case DIS_LITERAL_IDENTIFIER:
+                    hash = dis_hash(&lit->type, 1, hash);
+                    break;
+                default:
+                    hash = dis_hash(idx->program + lit->offset, lit->size, hash);
+                    break;
+            }
+        }
+
+        hash = dis_hash(&f->args, sizeof(f->args), hash);
+        hash = dis_hash(&f->rets, sizeof(f->rets), hash);
+        hash = dis_hash(idx->program + f->code_start, f->code_end - f->code_start, hash);
+    }
+
+    return hash;
+}
+
+static void dupe_add_file(dupes_t *d, uint32_t file, const dis_index_t *idx) {
+    uint32_t base = d->member_count;
+
+    for (uint32_t i = 1; i < idx->function_count; i++) {
+        const dis_function_t *f = &idx->functions[i];
+        dupe_member_t *m;
+
+        if (d->member_count == d->member_capacity) {
+            d->member_capacity = d->member_capacity ? d->member_capacity * 2 : 1024;
+            d->members = realloc(d->members, d->member_capacity * sizeof(dupe_member_t));
+        }
+
+        m = &d->members[d->member_count];
+        m->file = file;
+        m->path = malloc(strlen(f->path) + 1);
+        strcpy(m->path, f->path);
+        m->size = f->end - f->start + 2;
+        m->parent = f->parent > 0 ? (int32_t) (base + f->parent - 1) : -1;
+
+        m->exact = dupe_group(&d->exact, dis_hash(idx->program + f->start, f->end - f->start, DIS_HASH_SEED));
+        m->redundant = d->exact.groups[m->exact].count > 0;
+        m->inside = m->parent >= 0 && (d->members[m->parent].redundant || d->members[m->parent].inside);
+        dupe_link(&d->exact, m->exact, d->members, d->member_count);
+
+        m->near = dupe_group(&d->near, dupe_shape(idx, i));
+        ++d->near.groups[m->near].seen;
+
+        ++d->member_count;
+    }
+}
+
+// linked once the whole corpus is hashed, so nesting is judged on final counts
+static void dupe_near_groups(dupes_t *d) {
+    for (uint32_t m = 0; m < d->member_count; m++) {
+        dupe_member_t *mb = &d->members[m];
+        dupe_group_t *g = &d->near.groups[mb->near];
+
+        // nested in a function that already has a near copy
+        if (mb->parent >= 0 && d->near.groups[d->members[mb->parent].near].seen > 1)
+            continue;
+
+        if (!d->exact.groups[mb->exact].linked) {
+            d->exact.groups[mb->exact].linked = true;
+            ++g->variants;
+        }
+        if (g->count && !mb->inside)
+            g->bytes += mb->size;
+        dupe_link(&d->near, mb->near, d->members, m);
+    }
+}
+
+static int dupe_compare(const void *a, const void *b) {
+    const dupe_group_t *x = *(const dupe_group_t* const*) a, *y = *(const dupe_group_t* const*) b;
+
+    if (x->bytes != y->bytes)
+        return x->bytes < y->bytes ? 1 : -1;
+    return x->first < y->first ? -1 : x->first > y->first;
+}
+
+// groups worth reporting, largest first
+static dupe_group_t** dupe_sorted(dupe_table_t *table, bool near, uint32_t *count) {
+    dupe_group_t **sorted = malloc((table->count ? table->count : 1) * sizeof(dupe_group_t*));
+
+    *count = 0;
+    for (uint32_t i = 0; i < table->count; i++) {
+        dupe_group_t *g = &table->groups[i];
+
+        if (g->count < 2 || !g->bytes || (near && g->variants < 2))
+            continue;
+        sorted[(*count)++] = g;
+    }
+
+    qsort(sorted, *count, sizeof(dupe_group_t*), dupe_compare);
+    return sorted;
+}
+
+static void dupe_print_group(const dupes_t *d, const dupe_group_t *g, bool near, bool json, bool first) {
+    uint32_t shown = 0;
+
+    if (json) {
+        printf("%s\n    { \"copies\": %u, ", first ? "" : ",", g->count);
+        if (near)
+            printf("\"variants\": %u, \"min_bytes\": %u, \"max_bytes\": %u, \"foldable_bytes\": %llu, \"functions\": [", g->variants, g->min_size,
+                    g->max_size, (unsigned long long) g->bytes);
+        else
+            printf("\"bytes\": %u, \"duplicated_bytes\": %llu, \"functions\": [", g->min_size, (unsigned long long) g->bytes);
+    } else if (near)
+        printf("near: %u copies in %u variants, %u..%u bytes, %llu foldable bytes\n", g->count, g->variants, g->min_size, g->max_size,
+                (unsigned long long) g->bytes);
+    else
+        printf("exact: %u copies, %u bytes, %llu duplicated bytes\n", g->count, g->min_size, (unsigned long long) g->bytes);
+
+    for (int32_t m = g->first; m >= 0; m = d->members[m].next[near]) {
+        const dupe_member_t *mb = &d->members[m];
+
+        if (json) {
+            printf("%s{ \"file\": ", shown++ ? ", " : "");
+            str_print_json(d->files[mb->file]);
+            printf(", \"path\": ");
+            str_print_json(mb->path);
+            printf(" }");
+        } else if (shown++ < DIS_DUPES_SHOWN)
+            printf("    %s:%s%s\n", d->files[mb->file], mb->path, near ? "" : mb->redundant ? "" : " (kept)");
+    }
+
+    if (json)
+        printf("] }");
+    else if (shown > DIS_DUPES_SHOWN)
+        printf("    ( %u more )\n", shown - DIS_DUPES_SHOWN);
+}
+
+void dis_dupes_report(char **paths, uint32_t path_count, uint32_t top, bool json) {
+    dupes_t d;
+    uint32_t decoded = 0, exact_count, near_count;
+    uint64_t corpus_bytes = 0, duplicated = 0;
+    struct timespec t0, t1;
+
+    memset(&d, 0, sizeof(dupes_t));
+    d.near.list = 1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    for (uint32_t i = 0; i < path_count; i++)
+        dis_collect_files(paths[i], ".tb", &d.files, &d.file_count);
+
+    for (uint32_t i = 0; i < d.file_count; i++) {
+        uint8_t *program = NULL;
+        uint32_t len = 0;
+        dis_index_t idx;
+
+        if (dis_read_file(d.files[i], &program, &len)) {
+            fprintf(stderr, "%s: not able to read the file\n", d.files[i]);
+            continue;
+        }
+
+        if (dis_index_build(program, len, &idx))
+            fprintf(stderr, "%s: malformed bytecode, skipped\n", d.files[i]);
+        else {
+            dupe_add_file(&d, i, &idx);
+            corpus_bytes += len;
+            ++decoded;
+        }
+
+        dis_index_free(&idx);
+        free(program);
+    }
+
+    for (uint32_t m = 0; m < d.member_count; m++) {
+        const dupe_member_t *mb = &d.members[m];
+        if (mb->redundant && !mb->inside) {
+            d.exact.groups[mb->exact].bytes += mb->size;
+            duplicated += mb->size;
+        }
+    }
+
+    dupe_near_groups(&d);
+
+    dupe_group_t **exact = dupe_sorted(&d.exact, false, &exact_count);
+    dupe_group_t **near = dupe_sorted(&d.near, true, &near_count);
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    if (json) {
+        printf("{ \"files\": %u, \"decoded\": %u, \"functions\": %u, \"bytes\": %llu, \"duplicated_bytes\": %llu, \"exact\": [", d.file_count, decoded,
+                d.member_count, (unsigned long long) corpus_bytes, (unsigned long long) duplicated);
+        for (uint32_t i = 0; i < exact_count && i < top; i++)
+            dupe_print_group(&d, exact[i], false, true, !i);
+        printf("\n  ], \"near\": [");
+        for (uint32_t i = 0; i < near_count && i < top; i++)
+            dupe_print_group(&d, near[i], true, true, !i);
+        printf("\n  ] }\n");
+    } else {
+        printf("\n.comment duplicate functions: files: %u/%u, functions: %u, exact groups: %u, near groups: %u, time: %.3fs\n", decoded, d.file_count,
+                d.member_count, exact_count, near_count, (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9);
+        printf(".comment duplicated: %llu of %llu bytes (%.2f%%)\n", (unsigned long long) duplicated, (unsigned long long) corpus_bytes,
+                corpus_bytes ? 100.0 * duplicated / corpus_bytes : 0.0);
+
+        for (uint32_t i = 0; i < exact_count && i < top; i++)
+            dupe_print_group(&d, exact[i], false, false, !i);
+        for (uint32_t i = 0; i < near_count && i < top; i++)
+            dupe_print_group(&d, near[i], true, false, !i);
+    }
+
+    free(exact);
+    free(near);
+    for (uint32_t m = 0; m < d.member_count; m++)
+        free(d.members[m].path);
+    free(d.members);
+    for (uint32_t i = 0; i < d.file_count; i++)
+        free(d.files[i]);
+    free(d.files);
+    free(d.exact.slots);
+    free(d.exact.groups);
+    free(d.near.slots);
+    free(d.near.groups);
+}
@@ -0,0 +1,20 @@
+/*
+ * disassembler_dupes.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Corpus wide detection of identical and near-identical functions, to find helpers worth
+ * moving into a shared imported module.
+ */
+
+#ifndef DISASSEMBLER_DUPES_H_
+#define DISASSEMBLER_DUPES_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DIS_DUPES_SHOWN 8 // members listed per group
+
+void dis_dupes_report(char **paths, uint32_t path_count, uint32_t top, bool json);
+
+#endif /* DISASSEMBLER_DUPES_H_ */
@@ -0,0 +1,467 @@
+/*
+ * disassembler_fuzz.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Inputs take the path batch mode takes: dis_index_build first, then the listings for what
+ * it accepts. The CLI refuses what the index rejects but disassemble_buffer does not, so the
+ * listings also run on rejected inputs, in a child process where an exit() from the listing
+ * is the expected outcome and only a signal or a sanitizer report is a finding.
+ *
+ * The stand-alone mode mutates a seed corpus and keeps the mutants that reach new decode
+ * features (literal type and opcode pairs, analysis outcomes), a cheap stand-in for compiler
+ * coverage. For real coverage the same entry point links with libFuzzer:
+ *
+ *     clang -g -O1 -fsanitize=fuzzer,address -DDIS_LIBFUZZER -Isrc $(find src -name '*.c' ! -name main.c)
+ *
+ * A crash, an exit() from the listing code on an accepted input or an input running over
+ * FUZZ_TIMEOUT seconds is saved as fuzz-crash-HASH.tb, fuzz-exit-HASH.tb or fuzz-hang-HASH.tb.
+ * An input slower per byte than FUZZ_SLOW_FACTOR times the seed median is kept as
+ * fuzz-slow-HASH.tb: decoding should stay linear in size.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "disassembler.h"
+#include "disassembler_utils.h"
+#include "disassembler_index.h"
+#include "disassembler_stack.h"
+#include "disassembler_deadcode.h"
+#include "disassembler_fuzz.h"
+
+#define FUZZ_MAX_LEN (1 << 20)
+#define FUZZ_FEATURES (1 << 16)
+#define FUZZ_TIMEOUT 5           // seconds
+#define FUZZ_SLOW_FACTOR 20      // over the seed median ns/byte
+#define FUZZ_SLOW_MIN_NS 1000000 // shorter runs are timer noise
+#define FUZZ_CHILD_EXIT 3        // a rejected input ended the listing through exit()
+
+typedef struct fuzz_input_s {
+    uint8_t *data;
+    uint32_t len;
+} fuzz_input_t;
+
+typedef struct fuzz_s {
+    fuzz_input_t *corpus;   //
+    uint32_t count;         //
+    uint32_t capacity;      //
+    uint8_t *features;      // bitmap of FUZZ_FEATURES
+    uint32_t feature_count; //
+    uint32_t fresh;         // features first seen by the current input
+    uint64_t rng;           // xorshift64, fixed seed so runs repeat
+    double baseline;        // median ns per byte over the seeds
+    uint32_t slow;          //
+} fuzz_t;
+
+static FILE *fuzz_null = NULL;
+static const uint8_t *volatile fuzz_data = NULL;
+static volatile uint32_t fuzz_len = 0;
+static char fuzz_stack[1 << 16];
+static volatile sig_atomic_t fuzz_child = 0;
+static uint64_t fuzz_child_ns = 0; // spent on rejected inputs in the child, not part of the decode time
+
+// only async-signal-safe calls from here on
+static void fuzz_save(const char *kind) {
+    static const char HEX[] = "0123456789abcdef";
+    char name[48];
+    uint64_t hash = dis_hash((const void*) fuzz_data, fuzz_len, DIS_HASH_SEED);
+    uint32_t n = strlen(kind);
+    int fd;
+
+    memcpy(name, kind, n);
+    for (int i = 15; i >= 0; i--, hash >>= 4)
+        name[n + i] = HEX[hash & 15];
+    memcpy(name + n + 16, ".tb", 4);
+
+    if ((fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644)) >= 0) {
+        if (write(fd, (const void*) fuzz_data, fuzz_len) < 0)
+            (void) 0;
+        close(fd);
+    }
+
+    if (write(STDERR_FILENO, "input saved as ", 15) < 0 || write(STDERR_FILENO, name, n + 19) < 0 || write(STDERR_FILENO, "\n", 1) < 0)
+        (void) 0;
+}
+
+static void fuzz_signal(int sig) {
+    fuzz_save(sig == SIGALRM ? "fuzz-hang-" : "fuzz-crash-");
+    _exit(sig == SIGALRM ? 2 : 1);
+}
+
+// the listing code still exits on some malformed input
+static void fuzz_exit(void) {
+    if (fuzz_child)
+        _exit(FUZZ_CHILD_EXIT);
+    if (fuzz_data != NULL)
+        fuzz_save("fuzz-exit-");
+}
+
+static void fuzz_signals(void) {
+    static const int SIGNALS[] = { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT, SIGALRM };
+    struct sigaction sa;
+    stack_t ss = { .ss_sp = fuzz_stack, .ss_size = sizeof(fuzz_stack), .ss_flags = 0 };
+
+    // deep recursion overflows the normal stack, the handler needs its own
+    sigaltstack(&ss, NULL);
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = fuzz_signal;
+    sa.sa_flags = SA_ONSTACK;
+    sigemptyset(&sa.sa_mask);
+    for (uint32_t i = 0; i < sizeof(SIGNALS) / sizeof(SIGNALS[0]); i++)
+        sigaction(SIGNALS[i], &sa, NULL);
+}
+
+static void fuzz_feature(fuzz_t *fz, uint32_t kind, uint32_t a, uint32_t b) {
+    uint32_t bit = ((kind * 0x9E3779B1u) ^ (a * 0x85EBCA6Bu) ^ (b * 0xC2B2AE35u)) & (FUZZ_FEATURES - 1);
+
+    if (fz == NULL || fz->features[bit / 8] & (1 << (bit % 8)))
+        return;
+
+    fz->features[bit / 8] |= 1 << (bit % 8);
+    ++fz->feature_count;
+    ++fz->fresh;
+}
+
+static void fuzz_listings(const uint8_t *data, uint32_t len) {
+    options_t config = { false, false, NULL, NULL, false, false, NULL };
+
+    disassemble_buffer("fuzz", data, len, config, fuzz_null);
+    config.hex_flag = true;
+    disassemble_buffer("fuzz", data, len, config, fuzz_null);
+    config.hex_flag = false;
+    config.alt_format_flag = true;
+    disassemble_buffer("fuzz", data, len, config, fuzz_null);
+    config.group_flag = true;
+    disassemble_buffer("fuzz", data, len, config, fuzz_null);
+}
+
+static void fuzz_rejected(const uint8_t *data, uint32_t len) {
+    static const int SIGNALS[] = { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT, SIGALRM };
+    const uint8_t *saved = fuzz_data;
+    uint32_t saved_len = fuzz_len;
+    struct timespec t0, t1;
+    int status;
+    pid_t pid;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    // the child exits through stdio, nothing buffered here may be written twice
+    fflush(NULL);
+
+    pid = fork();
+    if (pid < 0)
+        return;
+
+    if (pid == 0) {
+        fuzz_child = 1;
+        for (uint32_t i = 0; i < sizeof(SIGNALS) / sizeof(SIGNALS[0]); i++)
+            signal(SIGNALS[i], SIG_DFL);
+        alarm(FUZZ_TIMEOUT);
+        fuzz_listings(data, len);
+        _exit(0);
+    }
+
+    while (waitpid(pid, &status, 0) < 0)
+        if (errno != EINTR)
+            return;
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    fuzz_child_ns += (uint64_t) (t1.tv_sec - t0.tv_sec) * 1000000000ULL + t1.tv_nsec - t0.tv_nsec;
+
+    fuzz_data = data;
+    fuzz_len = len;
+    if (WIFSIGNALED(status))
+        fuzz_save(WTERMSIG(status) == SIGALRM ? "fuzz-hang-" : "fuzz-crash-");
+    else if (WEXITSTATUS(status) != 0 && WEXITSTATUS(status) != FUZZ_CHILD_EXIT)
+        fuzz_save("fuzz-crash-");
+    fuzz_data = saved;
+    fuzz_len = saved_len;
+}
+
+static void fuzz_run(const uint8_t *data, uint32_t len, fuzz_t *fz) {
+    dis_index_t idx;
+
+    if (dis_index_build(data, len, &idx)) {
+        fuzz_feature(fz, 0, idx.function_count, 0);
+        dis_index_free(&idx);
+        fuzz_rejected(data, len);
+        return;
+    }
+
+    for (uint32_t fn = 0; fn < idx.function_count; fn++) {
+        const dis_function_t *f = &idx.functions[fn];
+        dis_stack_info_t stack;
+        dis_deadcode_info_t dead;
+
+        fuzz_feature(fz, 1, f->depth, f->parent >= 0);
+        for (uint32_t l = 0; l < f->literal_count; l++)
+            fuzz_feature(fz, 2, l ? f->literals[l - 1].type : 255, f->literals[l].type);
+
+        if (dis_stack_analyze(&idx, fn, &stack))
+            fuzz_feature(fz, 3, 0, 0);
+        else {
+            for (uint32_t i = 0; i < stack.count; i++)
+                fuzz_feature(fz, 4, i ? stack.ins[i - 1].opcode : 255, stack.ins[i].opcode);
+            fuzz_feature(fz, 5, stack.conflict_count > 0, stack.underflow_count > 0);
+            fuzz_feature(fz, 6, stack.unknown_calls > 0, stack.max_depth > 8);
+        }
+        dis_stack_info_free(&stack);
+
+        if (dis_deadcode_analyze(&idx, fn, &dead) == 0)
+            fuzz_feature(fz, 7, dead.dead_code_bytes > 0, dead.dead_literals > 0);
+        dis_deadcode_info_free(&dead);
+    }
+
+    fuzz_listings(data, len);
+    dis_index_free(&idx);
+}
+
+// one input through every decoder, also the libFuzzer entry
+int dis_fuzz_one(const uint8_t *data, size_t len) {
+    if (len > FUZZ_MAX_LEN)
+        return 0;
+
+    if (fuzz_null == NULL && (fuzz_null = fopen("/dev/null", "w")) == NULL)
+        return 0;
+
+    fuzz_run(data, len, NULL);
+    return 0;
+}
+
+#ifdef DIS_LIBFUZZER
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    return dis_fuzz_one(data, size);
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+static uint64_t fuzz_rand(fuzz_t *fz) {
+    fz->rng ^= fz->rng << 13;
+    fz->rng ^= fz->rng >> 7;
+    fz->rng ^= fz->rng << 17;
+    return fz->rng;
+}
+
+static void fuzz_add(fuzz_t *fz, const uint8_t *data, uint32_t len) {
+    if (fz->count == fz->capacity) {
+        fz->capacity = fz->capacity ? fz->capacity * 2 : 64;
+        fz->corpus = realloc(fz->corpus, fz->capacity * sizeof(fuzz_input_t));
+    }
+
+    fz->corpus[fz->count].data = malloc(len ? len : 1);
+    memcpy(fz->corpus[fz->count].data, data, len);
+    fz->corpus[fz->count++].len = len;
+}
+
+// out holds FUZZ_MAX_LEN bytes
+static uint32_t fuzz_mutate(fuzz_t *fz, const fuzz_input_t *in, uint8_t *out) {
+    static const uint8_t INTERESTING[] = { 0, 1, 2, 0x7f, 0x80, 0xfe, 0xff, DIS_OP_LITERAL_LONG, DIS_OP_JUMP, DIS_OP_FN_RETURN, DIS_OP_FN_END,
+            DIS_OP_END_OPCODES };
+    uint32_t len = in->len, rounds = 1 + fuzz_rand(fz) % 4;
+
+    memcpy(out, in->data, len);
+
+    for (uint32_t r = 0; r < rounds; r++) {
+        uint32_t pos = len ? fuzz_rand(fz) % len : 0, n;
+        uint16_t word;
+
+        switch (fuzz_rand(fz) % 8) {
+            case 0:
+                if (len)
+                    out[pos] ^= 1 << (fuzz_rand(fz) % 8);
+                break;
+            case 1:
+                if (len)
+                    out[pos] = fuzz_rand(fz);
+                break;
+            case 2:
+                if (len)
+                    out[pos] = INTERESTING[fuzz_rand(fz) % sizeof(INTERESTING)];
+                break;
+            case 3:
+                // size and count words
+                word = fuzz_rand(fz) % 3 == 0 ? 0xffff : fuzz_rand(fz) % 3 == 0 ? 0 : fuzz_rand(fz) % (len + 16);
+                if (pos + 2 <= len)
+                    memcpy(out + pos, &word, 2);
+                break;
+            case 4:
+                if (len < FUZZ_MAX_LEN) {
+                    memmove(out + pos + 1, out + pos, len - pos);
+                    out[pos] = fuzz_rand(fz);
+                    ++len;
+                }
+                break;
+            case 5:
+                if (len) {
+                    memmove(out + pos, out + pos + 1, len - pos - 1);
+                    --len;
+                }
+                break;
+            case 6: {
+                // duplicate a block, nested sections grow this way
+                uint8_t block[256];
+
+                n = len ? fuzz_rand(fz) % (len - pos < sizeof(block) ? len - pos : sizeof(block)) + 1 : 0;
+                if (n && len + n <= FUZZ_MAX_LEN) {
+                    uint32_t at = fuzz_rand(fz) % (len + 1);
+
+                    memcpy(block, out + pos, n);
+                    memmove(out + at + n, out + at, len - at);
+                    memcpy(out + at, block, n);
+                    len += n;
+                }
+            }
+                break;
+            case 7: {
+                const fuzz_input_t *other = &fz->corpus[fuzz_rand(fz) % fz->count];
+                uint32_t from = other->len ? fuzz_rand(fz) % other->len : 0;
+
+                n = other->len - from;
+                if (pos + n > FUZZ_MAX_LEN)
+                    n = FUZZ_MAX_LEN - pos;
+                memcpy(out + pos, other->data + from, n);
+                len = pos + n;
+            }
+                break;
+        }
+    }
+
+    return len;
+}
+
+static uint64_t fuzz_time(fuzz_t *fz, const uint8_t *data, uint32_t len) {
+    uint64_t child = fuzz_child_ns;
+    struct timespec t0, t1;
+
+    fuzz_data = data;
+    fuzz_len = len;
+    alarm(FUZZ_TIMEOUT);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    fz->fresh = 0;
+    fuzz_run(data, len, fz);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    alarm(0);
+    fuzz_data = NULL;
+    return (uint64_t) (t1.tv_sec - t0.tv_sec) * 1000000000ULL + t1.tv_nsec - t0.tv_nsec - (fuzz_child_ns - child);
+}
+
+static int fuzz_cmp_double(const void *a, const void *b) {
+    double x = *(const double*) a, y = *(const double*) b;
+    return x < y ? -1 : x > y;
+}
+
+static void fuzz_slow(fuzz_t *fz, const uint8_t *data, uint32_t len, uint64_t ns) {
+    double per_byte = (double) ns / (len ? len : 1);
+    char name[48];
+
+    if (ns < FUZZ_SLOW_MIN_NS || per_byte < FUZZ_SLOW_FACTOR * fz->baseline)
+        return;
+
+    // one slow run is often the scheduler, the fastest of three has to be slow as well
+    for (uint32_t i = 0; i < 2; i++) {
+        uint64_t again = fuzz_time(fz, data, len);
+        ns = again < ns ? again : ns;
+    }
+
+    per_byte = (double) ns / (len ? len : 1);
+    if (ns < FUZZ_SLOW_MIN_NS || per_byte < FUZZ_SLOW_FACTOR * fz->baseline)
+        return;
+
+    snprintf(name, sizeof(name), "fuzz-slow-%016llx.tb", (unsigned long long) dis_hash(data, len, DIS_HASH_SEED));
+    dis_write_file(name, data, len);
+    ++fz->slow;
+    printf(".comment slow %s: %u bytes, %.2f ms, %.1f ns/byte (%.1fx the seed median)\n", name, len, ns / 1e6, per_byte, per_byte / fz->baseline);
+    fflush(stdout);
+}
+
+uint8_t dis_fuzz(char **files, uint32_t file_count, uint32_t runs) {
+    fuzz_t fz = { .rng = 0x9E3779B97F4A7C15ULL };
+    char **seeds = NULL;
+    uint32_t seed_count = 0;
+    double *per_byte;
+    uint8_t *buf;
+    struct timespec t0, t1;
+
+    for (uint32_t i = 0; i < file_count; i++)
+        dis_collect_files(files[i], ".tb", &seeds, &seed_count);
+
+    if (seed_count == 0) {
+        fprintf(stderr, "fuzz needs at least one seed .tb file\n");
+        return 1;
+    }
+
+    if ((fuzz_null = fopen("/dev/null", "w")) == NULL) {
+        perror("/dev/null");
+        return 1;
+    }
+
+    fuzz_signals();
+    atexit(fuzz_exit);
+    fz.features = calloc(FUZZ_FEATURES / 8, 1);
+    per_byte = malloc(seed_count * sizeof(double));
+    buf = malloc(FUZZ_MAX_LEN);
+
+    printf("\n.comment fuzz: %u seeds, %u runs\n", seed_count, runs);
+    for (uint32_t i = 0; i < seed_count; i++) {
+        uint8_t *program = NULL;
+        uint32_t len = 0;
+        uint64_t ns;
+
+        if (dis_read_file(seeds[i], &program, &len) || len > FUZZ_MAX_LEN) {
+            fprintf(stderr, "%s: not able to read the file\n", seeds[i]);
+            per_byte[i] = 0;
+            free(program);
+            continue;
+        }
+
+        ns = fuzz_time(&fz, program, len);
+        per_byte[i] = (double) ns / (len ? len : 1);
+        printf(".comment seed %s: %u bytes, %.3f ms, %.1f ns/byte, %u new features\n", seeds[i], len, ns / 1e6, per_byte[i], fz.fresh);
+        fflush(stdout);
+        fuzz_add(&fz, program, len);
+        free(program);
+    }
+
+    qsort(per_byte, seed_count, sizeof(double), fuzz_cmp_double);
+    fz.baseline = per_byte[seed_count / 2] > 0 ? per_byte[seed_count / 2] : 1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (uint32_t r = 0; r < runs && fz.count; r++) {
+        uint32_t len = fuzz_mutate(&fz, &fz.corpus[fuzz_rand(&fz) % fz.count], buf);
+        uint64_t ns = fuzz_time(&fz, buf, len);
+
+        if (fz.fresh)
+            fuzz_add(&fz, buf, len);
+        fuzz_slow(&fz, buf, len, ns);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    double seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    printf(".comment fuzz: %u runs in %.2f s (%.0f/s), corpus %u, features %u, slow %u, no crashes or hangs\n", runs, seconds,
+            seconds > 0 ? runs / seconds : 0, fz.count, fz.feature_count, fz.slow);
+
+    for (uint32_t i = 0; i < fz.count; i++)
+        free(fz.corpus[i].data);
+    for (uint32_t i = 0; i < seed_count; i++)
+        free(seeds[i]);
+    free(seeds);
+    free(fz.corpus);
+    free(fz.features);
+    free(per_byte);
+    free(buf);
+    fclose(fuzz_null);
+    fuzz_null = NULL;
+    return 0;
+}
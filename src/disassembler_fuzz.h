@@ -0,0 +1,20 @@
+/*
+ * disassembler_fuzz.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * In-process fuzzing of the buffer decode path: the index, the analyses built on it and
+ * the listing formats, with per-input timing so slow inputs are reported next to
+ * crashes and hangs.
+ */
+
+#ifndef DISASSEMBLER_FUZZ_H_
+#define DISASSEMBLER_FUZZ_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+int dis_fuzz_one(const uint8_t *data, size_t len);
+uint8_t dis_fuzz(char **files, uint32_t file_count, uint32_t runs);
+
+#endif /* DISASSEMBLER_FUZZ_H_ */
@@ -0,0 +1,305 @@
+/*
+ * disassembler_index.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Structural (non printing) decoder for Toy bytecode.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "disassembler_string.h"
+#include "disassembler_index.h"
+
+static uint8_t idx_word(const uint8_t *program, uint32_t end, uint32_t *pc, uint16_t *ret) {
+    if (*pc + 2 > end)
+        return 1;
+
+    memcpy(ret, program + *pc, 2);
+    *pc += 2;
+    return 0;
+}
+
+static uint8_t idx_string(const uint8_t *program, uint32_t end, uint32_t pc, uint32_t *size) {
+    const uint8_t *nul = memchr(program + pc, '\0', end - pc);
+
+    if (nul == NULL)
+        return 1;
+
+    *size = (uint32_t) (nul - (program + pc)) + 1;
+    return 0;
+}
+
+static int32_t idx_add_function(dis_index_t *idx) {
+    if (idx->function_count == idx->function_capacity) {
+        idx->function_capacity = idx->function_capacity ? idx->function_capacity * 2 : 16;
+        idx->functions = realloc(idx->functions, idx->function_capacity * sizeof(dis_function_t));
+    }
+
+    memset(&idx->functions[idx->function_count], 0, sizeof(dis_function_t));
+    return idx->function_count++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+uint8_t dis_index_decode_function(const dis_index_t *idx, uint32_t fn, dis_instruction_t **ins, uint32_t *count) {
+    const dis_function_t *f = &idx->functions[fn];
+    uint32_t capacity = 64;
+
+    *count = 0;
+    *ins = malloc(capacity * sizeof(dis_instruction_t));
+
+    for (uint32_t pc = f->code_start; pc < f->code_end; pc += (*ins)[(*count)++].size) {
+        if (*count == capacity) {
+            capacity *= 2;
+            *ins = realloc(*ins, capacity * sizeof(dis_instruction_t));
+        }
+
+        if (idx->ops->decode(idx->program, pc, f->code_end, &(*ins)[*count]))
+            return 1;
+    }
+
+    return 0;
+}
+
+// binary search by absolute offset, count if no instruction starts there
+uint32_t dis_index_find_instruction(const dis_instruction_t *ins, uint32_t count, uint32_t offset) {
+    uint32_t lo = 0, hi = count;
+
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (ins[mid].offset < offset)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo < count && ins[lo].offset == offset ? lo : count;
+}
+
+// short one line rendering of a literal cache entry, compound literals are not expanded
+void dis_index_literal_str(const dis_index_t *idx, const dis_function_t *f, uint32_t literal, char *s, uint32_t size) {
+    const dis_literal_t *lit;
+    const uint8_t *p;
+    int32_t integer;
+    float fl;
+    uint16_t word;
+
+    if (literal >= f->literal_count) {
+        snprintf(s, size, "#%u?", literal);
+        return;
+    }
+
+    lit = &f->literals[literal];
+    p = idx->program + lit->offset + 1;
+
+    switch (lit->type) {
+        case DIS_LITERAL_NULL:
+            snprintf(s, size, "null");
+            break;
+        case DIS_LITERAL_BOOLEAN:
+            snprintf(s, size, "%s", p[0] ? "true" : "false");
+            break;
+        case DIS_LITERAL_INTEGER:
+            memcpy(&integer, p, 4);
+            snprintf(s, size, "%d", integer);
+            break;
+        case DIS_LITERAL_FLOAT:
+            memcpy(&fl, p, 4);
+            snprintf(s, size, "%.9g", fl);
+            break;
+        case DIS_LITERAL_STRING:
+        case DIS_LITERAL_IDENTIFIER: {
+            // only what fits in s is escaped
+            uint32_t n = lit->size - 2 < size ? lit->size - 2 : size;
+            char *e = malloc(DIS_ESCAPE_MAX(n));
+
+            dis_escape(p, n, e, lit->type == DIS_LITERAL_IDENTIFIER);
+            snprintf(s, size, lit->type == DIS_LITERAL_STRING ? "\"%s\"" : "%s", e);
+            free(e);
+        }
+            break;
+        case DIS_LITERAL_FUNCTION:
+        case DIS_LITERAL_ARRAY:
+        case DIS_LITERAL_ARRAY_INTERMEDIATE:
+        case DIS_LITERAL_DICTIONARY:
+        case DIS_LITERAL_DICTIONARY_INTERMEDIATE:
+            memcpy(&word, p, 2);
+            snprintf(s, size, "%s %u", LIT_STR[lit->type] + 12, word);
+            break;
+        case DIS_LITERAL_TYPE:
+        case DIS_LITERAL_TYPE_INTERMEDIATE:
+            snprintf(s, size, "%s %s%s", LIT_STR[lit->type] + 12, p[0] <= DIS_LITERAL_INDEX_BLANK ? LIT_STR[p[0]] + 12 : "?", p[1] ? " const" : "");
+            break;
+        default:
+            snprintf(s, size, "%s", lit->type <= DIS_LITERAL_INDEX_BLANK ? LIT_STR[lit->type] + 12 : "?");
+            break;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static uint8_t idx_read_function(dis_index_t *idx, int32_t fn, bool lazy);
+
+// lazy: children get their path, parent, start and end only, dis_index_expand reads the rest
+static uint8_t idx_read_sections(dis_index_t *idx, int32_t fn, uint32_t *pc, uint32_t end, bool lazy) {
+    const uint8_t *program = idx->program;
+    dis_function_t *f = &idx->functions[fn];
+    uint16_t literal_count, function_count, function_size;
+    uint32_t fcnt = 0;
+
+    f->start = *pc;
+    if (idx_word(program, end, pc, &literal_count))
+        return 1;
+
+    f->literal_count = literal_count;
+    f->literals = malloc((literal_count ? literal_count : 1) * sizeof(dis_literal_t));
+
+    for (uint32_t i = 0; i < literal_count; i++) {
+        dis_literal_t *lit = &f->literals[i];
+
+        lit->offset = *pc;
+        if (dis_literal_size(program, *pc, end, &lit->size))
+            return 1;
+        lit->type = program[*pc];
+        *pc += lit->size;
+    }
+
+    if (*pc >= end || program[(*pc)++] != DIS_OP_SECTION_END)
+        return 1;
+    f->lit_end = *pc;
+
+    if (idx_word(program, end, pc, &function_count) || idx_word(program, end, pc, &function_size))
+        return 1;
+
+    if (function_count) {
+        for (uint32_t i = 0; i < literal_count; i++) {
+            uint16_t size;
+            int32_t child;
+
+            // f may move while children are appended
+            if (idx->functions[fn].literals[i].type != DIS_LITERAL_FUNCTION)
+                continue;
+
+            if (idx_word(program, end, pc, &size) || size < 5 || *pc + size > end)
+                return 1;
+
+            if (program[*pc + size - 1] != DIS_OP_FN_END)
+                return 1;
+
+            char path[DIS_PATH_MAX + 16];
+            if (fn == 0)
+                sprintf(path, "%u", fcnt);
+            else
+                sprintf(path, "%s_%u", idx->functions[fn].path, fcnt);
+            if (strlen(path) >= DIS_PATH_MAX)
+                return 1;
+
+            child = idx_add_function(idx);
+            f = &idx->functions[fn];
+            strcpy(idx->functions[child].path, path);
+            idx->functions[child].parent = fn;
+            idx->functions[child].depth = f->depth + 1;
+            idx->functions[child].start = *pc;
+            idx->functions[child].end = *pc + size;
+
+            if (!lazy && idx_read_function(idx, child, false))
+                return 1;
+
+            fcnt++;
+            *pc += size;
+        }
+    }
+
+    f = &idx->functions[fn];
+    if (*pc >= end || program[(*pc)++] != DIS_OP_SECTION_END)
+        return 1;
+    f->fn_end = *pc;
+
+    // the code section of a function ends at FN_END, MAIN runs to the end of the file
+    f->code_start = *pc;
+    f->code_end = end;
+    f->end = end;
+    f->scanned = true;
+
+    return 0;
+}
+
+// sections of a child function, then the args/rets words opening its code
+static uint8_t idx_read_function(dis_index_t *idx, int32_t fn, bool lazy) {
+    uint32_t pc = idx->functions[fn].start, end = idx->functions[fn].end;
+    dis_function_t *f;
+
+    if (idx_read_sections(idx, fn, &pc, end - 1, lazy))
+        return 1;
+
+    f = &idx->functions[fn];
+    if (idx_word(idx->program, f->code_end, &pc, &f->args) || idx_word(idx->program, f->code_end, &pc, &f->rets))
+        return 1;
+    f->code_start = pc;
+    f->end = end;
+
+    return 0;
+}
+
+static uint8_t idx_open(const uint8_t *program, uint32_t len, dis_index_t *idx, bool lazy) {
+    uint32_t pc = 0, slen;
+
+    memset(idx, 0, sizeof(dis_index_t));
+    idx->program = program;
+    idx->len = len;
+    idx->ops = dis_opset_latest();
+
+    if (len < 4 || idx_string(program, len, 3, &slen))
+        return 1;
+
+    idx->major = program[0];
+    idx->minor = program[1];
+    idx->patch = program[2];
+    idx->build = (const char*) program + 3;
+    if ((idx->ops = dis_opset_select(idx->major)) == NULL) {
+        idx->ops = dis_opset_latest();
+        return 1;
+    }
+    pc = 3 + slen;
+
+    if (pc >= len || program[pc++] != DIS_OP_SECTION_END)
+        return 1;
+    idx->header_end = pc;
+
+    int32_t main_fn = idx_add_function(idx);
+    strcpy(idx->functions[main_fn].path, "MAIN");
+    idx->functions[main_fn].parent = -1;
+
+    return idx_read_sections(idx, main_fn, &pc, len, lazy);
+}
+
+uint8_t dis_index_build(const uint8_t *program, uint32_t len, dis_index_t *idx) {
+    return idx_open(program, len, idx, false);
+}
+
+// the header and MAIN only, children are walked over with their size words
+uint8_t dis_index_open(const uint8_t *program, uint32_t len, dis_index_t *idx) {
+    return idx_open(program, len, idx, true);
+}
+
+// children of a lazily opened index, appended after every function read so far
+uint8_t dis_index_expand(dis_index_t *idx, uint32_t fn) {
+    if (idx->functions[fn].scanned)
+        return 0;
+
+    free(idx->functions[fn].literals);
+    idx->functions[fn].literals = NULL;
+    return idx_read_function(idx, fn, true);
+}
+
+void dis_index_free(dis_index_t *idx) {
+    for (uint32_t i = 0; i < idx->function_count; i++)
+        free(idx->functions[i].literals);
+
+    free(idx->functions);
+    idx->functions = NULL;
+    idx->function_count = idx->function_capacity = 0;
+}
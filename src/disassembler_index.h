@@ -0,0 +1,74 @@
+/*
+ * disassembler_index.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Structural (non printing) decoder for Toy bytecode. Builds a flat index of every
+ * function section so analysis passes don't have to re-implement the file walk.
+ */
+
+#ifndef DISASSEMBLER_INDEX_H_
+#define DISASSEMBLER_INDEX_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "disassembler.h"
+#include "disassembler_version.h"
+
+#define DIS_PATH_MAX 256
+
+typedef struct dis_literal_s {
+    uint32_t offset; // offset of the literal type byte
+    uint32_t size;   // bytes used, type byte included
+    uint8_t type;    //
+} dis_literal_t;
+
+typedef struct dis_function_s {
+    char path[DIS_PATH_MAX]; // "MAIN" or tree path in alt format style ("0_1")
+    int32_t parent;          // index of parent function, -1 for MAIN
+    uint32_t depth;          //
+    uint32_t start;          // first byte of the section (literal count word)
+    uint32_t end;            // one past the last byte (FN_END included)
+    uint32_t lit_end;        // one past the literal section SECTION_END
+    uint32_t fn_end;         // one past the function section SECTION_END
+    uint32_t code_start;     // first opcode (after args/rets in functions)
+    uint32_t code_end;       // one past the last opcode (FN_END excluded)
+    uint16_t args;           //
+    uint16_t rets;           //
+    uint16_t literal_count;  //
+    dis_literal_t *literals; //
+    bool scanned;            // false for the children of a lazily opened index until expanded
+} dis_function_t;
+
+typedef struct dis_index_s {
+    const uint8_t *program;
+    uint32_t len;
+    uint8_t major;
+    uint8_t minor;
+    uint8_t patch;
+    const char *build;
+    const dis_opset_t *ops;       // tables picked from the header version
+    uint32_t header_end;          // offset of the first section
+    uint32_t function_count;      //
+    uint32_t function_capacity;   //
+    dis_function_t *functions;    // pre-order (expansion order when opened lazily), [0] is MAIN
+} dis_index_t;
+
+typedef struct dis_instruction_s {
+    uint32_t offset; // absolute offset of the opcode
+    uint8_t opcode;  //
+    uint8_t size;    // opcode included
+    uint32_t arg[2]; // decoded arguments (offset of the string for DIS_ARG_STRING)
+} dis_instruction_t;
+
+uint8_t dis_index_build(const uint8_t *program, uint32_t len, dis_index_t *idx);
+uint8_t dis_index_open(const uint8_t *program, uint32_t len, dis_index_t *idx);
+uint8_t dis_index_expand(dis_index_t *idx, uint32_t fn);
+void dis_index_free(dis_index_t *idx);
+uint8_t dis_index_decode_function(const dis_index_t *idx, uint32_t fn, dis_instruction_t **ins, uint32_t *count);
+uint32_t dis_index_find_instruction(const dis_instruction_t *ins, uint32_t count, uint32_t offset);
+uint8_t dis_literal_size(const uint8_t *program, uint32_t pc, uint32_t end, uint32_t *size);
+void dis_index_literal_str(const dis_index_t *idx, const dis_function_t *f, uint32_t literal, char *s, uint32_t size);
+
+#endif /* DISASSEMBLER_INDEX_H_ */
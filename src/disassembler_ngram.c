@@ -0,0 +1,193 @@
+/*
+ * disassembler_ngram.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Opcode n-grams are counted per basic block: a window never spans a jump target or
+ * continues past a jump/return, since a superinstruction could not be formed there.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "disassembler_utils.h"
+#include "disassembler_index.h"
+#include "disassembler_ngram.h"
+
+typedef struct ngram_entry_s {
+    uint64_t key;   // opcodes packed one per byte, 0 is an empty slot
+    uint64_t count; //
+} ngram_entry_t;
+
+typedef struct ngram_table_s {
+    ngram_entry_t *entries;
+    uint32_t capacity; // power of two
+    uint32_t used;
+} ngram_table_t;
+
+static inline uint32_t ngram_slot(uint64_t key, uint32_t mask) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (uint32_t) key & mask;
+}
+
+static void ngram_grow(ngram_table_t *table) {
+    ngram_entry_t *old = table->entries;
+    uint32_t old_capacity = table->capacity;
+
+    table->capacity = old_capacity ? old_capacity * 2 : 4096;
+    table->entries = calloc(table->capacity, sizeof(ngram_entry_t));
+
+    for (uint32_t i = 0; i < old_capacity; i++) {
+        if (!old[i].key)
+            continue;
+
+        uint32_t slot = ngram_slot(old[i].key, table->capacity - 1);
+        while (table->entries[slot].key)
+            slot = (slot + 1) & (table->capacity - 1);
+        table->entries[slot] = old[i];
+    }
+
+    free(old);
+}
+
+static void ngram_add(ngram_table_t *table, uint64_t key) {
+    if ((table->used + 1) * 10 >= table->capacity * 7)
+        ngram_grow(table);
+
+    uint32_t slot = ngram_slot(key, table->capacity - 1);
+    while (table->entries[slot].key && table->entries[slot].key != key)
+        slot = (slot + 1) & (table->capacity - 1);
+
+    if (!table->entries[slot].key) {
+        table->entries[slot].key = key;
+        ++table->used;
+    }
+
+    ++table->entries[slot].count;
+}
+
+static int ngram_compare(const void *a, const void *b) {
+    const ngram_entry_t *ea = a, *eb = b;
+
+    if (ea->count != eb->count)
+        return ea->count < eb->count ? 1 : -1;
+    return ea->key < eb->key ? -1 : ea->key > eb->key;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static uint64_t ngram_count_function(const dis_index_t *idx, const dis_function_t *fn, uint8_t n, ngram_table_t *table) {
+    const uint8_t *program = idx->program;
+    uint32_t code_len = fn->code_end - fn->code_start;
+    uint8_t *target = calloc(code_len + 1, sizeof(uint8_t));
+    dis_instruction_t ins;
+    uint64_t window = 0, mask = n == 8 ? ~0ULL : (1ULL << (8 * n)) - 1, total = 0;
+    uint8_t filled = 0;
+
+    // first pass: jump targets start a new basic block
+    for (uint32_t pc = fn->code_start; pc < fn->code_end; pc += ins.size) {
+        if (idx->ops->decode(program, pc, fn->code_end, &ins))
+            break;
+        if (ins.opcode < DIS_OP_END_OPCODES && idx->ops->args[ins.opcode][2] && ins.arg[0] <= code_len)
+            target[ins.arg[0]] = 1;
+    }
+
+    for (uint32_t pc = fn->code_start; pc < fn->code_end; pc += ins.size) {
+        if (idx->ops->decode(program, pc, fn->code_end, &ins))
+            break;
+
+        if (ins.opcode == DIS_OP_SECTION_END || ins.opcode == DIS_OP_EOF) {
+            filled = 0;
+            continue;
+        }
+
+        if (target[pc - fn->code_start])
+            filled = 0;
+
+        window = ((window << 8) | ins.opcode) & mask;
+        if (filled < n)
+            ++filled;
+
+        if (filled == n) {
+            ngram_add(table, window);
+            ++total;
+        }
+
+        if (idx->ops->args[ins.opcode][2] || ins.opcode == DIS_OP_FN_RETURN)
+            filled = 0;
+    }
+
+    free(target);
+    return total;
+}
+
+void dis_ngram_corpus(char **paths, uint32_t path_count, uint8_t n, uint32_t top) {
+    ngram_table_t table = { NULL, 0, 0 };
+    char **files = NULL;
+    uint32_t file_count = 0, decoded = 0, functions = 0;
+    uint64_t total = 0;
+    struct timespec t0, t1;
+
+    if (n < 1 || n > DIS_NGRAM_MAX) {
+        fprintf(stderr, "n-gram length must be between 1 and %d\n", DIS_NGRAM_MAX);
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    ngram_grow(&table);
+
+    for (uint32_t i = 0; i < path_count; i++)
+        dis_collect_files(paths[i], ".tb", &files, &file_count);
+
+    for (uint32_t i = 0; i < file_count; i++) {
+        uint8_t *program = NULL;
+        uint32_t len = 0;
+        dis_index_t idx;
+
+        if (dis_read_file(files[i], &program, &len)) {
+            fprintf(stderr, "%s: not able to read the file\n", files[i]);
+            free(files[i]);
+            continue;
+        }
+
+        if (dis_index_build(program, len, &idx))
+            fprintf(stderr, "%s: malformed bytecode, skipped\n", files[i]);
+        else {
+            for (uint32_t f = 0; f < idx.function_count; f++)
+                total += ngram_count_function(&idx, &idx.functions[f], n, &table);
+            functions += idx.function_count;
+            ++decoded;
+        }
+
+        dis_index_free(&idx);
+        free(program);
+        free(files[i]);
+    }
+    free(files);
+
+    ngram_entry_t *sorted = malloc((table.used ? table.used : 1) * sizeof(ngram_entry_t));
+    uint32_t used = 0;
+    for (uint32_t i = 0; i < table.capacity; i++)
+        if (table.entries[i].key)
+            sorted[used++] = table.entries[i];
+    qsort(sorted, used, sizeof(ngram_entry_t), ngram_compare);
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    printf("\n.comment n-gram: %u, files: %u/%u, functions: %u, sequences: %llu, distinct: %u, time: %.3fs\n", n, decoded, file_count, functions,
+            (unsigned long long) total, used, (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9);
+
+    for (uint32_t i = 0; i < used && i < top; i++) {
+        printf("%10llu %6.2f%%  ", (unsigned long long) sorted[i].count, total ? 100.0 * sorted[i].count / total : 0.0);
+        for (int8_t b = n - 1; b >= 0; b--)
+            printf(" %s", OP_STR[(sorted[i].key >> (8 * b)) & 0xff] + 7);
+        printf("\n");
+    }
+
+    free(sorted);
+    free(table.entries);
+}
@@ -0,0 +1,18 @@
+/*
+ * disassembler_ngram.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Corpus wide opcode n-gram counting, used to pick VM superinstruction candidates.
+ */
+
+#ifndef DISASSEMBLER_NGRAM_H_
+#define DISASSEMBLER_NGRAM_H_
+
+#include <stdint.h>
+
+#define DIS_NGRAM_MAX 8
+
+void dis_ngram_corpus(char **paths, uint32_t path_count, uint8_t n, uint32_t top);
+
+#endif /* DISASSEMBLER_NGRAM_H_ */
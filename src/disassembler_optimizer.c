@@ -0,0 +1,443 @@
+/*
+ * disassembler_optimizer.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Passes run to a fixed point per function:
+ *  - DIS_OP_PASS removal
+ *  - GROUPING_BEGIN/GROUPING_END pairs around straight-line code
+ *  - jump-to-jump chains collapsed, jumps to the next instruction removed
+ *  - LITERAL LITERAL <arith> and LITERAL NEGATE folded when both literals are numbers
+ *
+ * Every fold interns its result, the ones a longer chain folded further are dropped once
+ * the passes settle. Literals of the input left unreferenced stay, -C removes those.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+#include "disassembler_utils.h"
+#include "disassembler_index.h"
+#include "disassembler_rewrite.h"
+#include "disassembler_optimizer.h"
+
+typedef struct opt_function_s {
+    dis_rewrite_t *rw;
+    uint32_t fn;
+    dis_rw_instr_t *ins;
+    uint32_t count;
+    uint32_t len;
+    bool *target;          // instruction is the (forwarded) destination of a jump
+    uint32_t *lit_offset;  // literal entry offsets inside rw->literals[fn]
+    uint32_t lit_capacity; //
+} opt_function_t;
+
+typedef struct opt_stats_s {
+    uint32_t pass;
+    uint32_t grouping;
+    uint32_t jumps;
+    uint32_t folded;
+} opt_stats_t;
+
+static uint32_t opt_next(const opt_function_t *of, uint32_t i) {
+    for (++i; i < of->count && of->ins[i].removed; i++)
+        ;
+    return i;
+}
+
+static uint32_t opt_find(const opt_function_t *of, uint32_t offset) {
+    uint32_t lo = 0, hi = of->count;
+
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (of->ins[mid].offset < offset)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo < of->count && of->ins[lo].offset != offset)
+        return of->count;
+
+    // removed instructions forward to the next surviving one
+    while (lo < of->count && of->ins[lo].removed)
+        ++lo;
+    return lo;
+}
+
+static void opt_mark_targets(opt_function_t *of) {
+    memset(of->target, 0, of->count * sizeof(bool));
+
+    for (uint32_t i = 0; i < of->count; i++) {
+        if (of->ins[i].removed || of->ins[i].opcode >= DIS_OP_END_OPCODES || !OP_ARGS[of->ins[i].opcode][2])
+            continue;
+
+        uint32_t t = opt_find(of, of->ins[i].arg[0]);
+        if (t < of->count)
+            of->target[t] = true;
+    }
+}
+
+static bool opt_is_control(uint8_t opcode) {
+    return opcode < DIS_OP_END_OPCODES && (OP_ARGS[opcode][2] || opcode == DIS_OP_FN_RETURN);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static bool opt_pass(opt_function_t *of, opt_stats_t *stats) {
+    bool changed = false;
+
+    for (uint32_t i = 0; i < of->count; i++) {
+        if (!of->ins[i].removed && of->ins[i].opcode == DIS_OP_PASS) {
+            of->ins[i].removed = true;
+            ++stats->pass;
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+
+static bool opt_grouping(opt_function_t *of, opt_stats_t *stats) {
+    uint32_t *open = malloc((of->count ? of->count : 1) * sizeof(uint32_t));
+    uint32_t depth = 0;
+    bool changed = false;
+
+    opt_mark_targets(of);
+
+    for (uint32_t i = 0; i < of->count; i = opt_next(of, i)) {
+        if (of->ins[i].removed)
+            continue;
+
+        if (of->ins[i].opcode == DIS_OP_GROUPING_BEGIN)
+            open[depth++] = i;
+        else if (of->ins[i].opcode == DIS_OP_GROUPING_END && depth) {
+            uint32_t b = open[--depth];
+            bool straight = true;
+
+            for (uint32_t j = opt_next(of, b); j <= i && straight; j = opt_next(of, j))
+                if (of->target[j] || (j < i && opt_is_control(of->ins[j].opcode)))
+                    straight = false;
+
+            if (straight) {
+                of->ins[b].removed = of->ins[i].removed = true;
+                ++stats->grouping;
+                changed = true;
+            }
+        }
+    }
+
+    free(open);
+    return changed;
+}
+
+static bool opt_jumps(opt_function_t *of, opt_stats_t *stats) {
+    bool changed = false;
+
+    for (uint32_t i = 0; i < of->count; i++) {
+        dis_rw_instr_t *in = &of->ins[i];
+        uint32_t hops = 0, t;
+
+        if (in->removed || in->opcode >= DIS_OP_END_OPCODES || !OP_ARGS[in->opcode][2])
+            continue;
+
+        // follow unconditional jumps, bounded to survive jump cycles
+        while ((t = opt_find(of, in->arg[0])) < of->count && t != i && of->ins[t].opcode == DIS_OP_JUMP && of->ins[t].arg[0] != in->arg[0]
+                && hops++ < of->count) {
+            in->arg[0] = of->ins[t].arg[0];
+            ++stats->jumps;
+            changed = true;
+        }
+
+        if (in->opcode == DIS_OP_JUMP && opt_find(of, in->arg[0]) == opt_next(of, i)) {
+            in->removed = true;
+            ++stats->jumps;
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static bool opt_number(const opt_function_t *of, const dis_rw_instr_t *in, uint8_t *type, int32_t *ival, float *fval) {
+    const dis_buffer_t *lits = &of->rw->literals[of->fn];
+
+    if (in->opcode != DIS_OP_LITERAL && in->opcode != DIS_OP_LITERAL_LONG)
+        return false;
+    if (in->arg[0] >= of->rw->literal_count[of->fn])
+        return false;
+
+    const uint8_t *lit = lits->data + of->lit_offset[in->arg[0]];
+    *type = lit[0];
+    if (*type == DIS_LITERAL_INTEGER)
+        memcpy(ival, lit + 1, 4);
+    else if (*type == DIS_LITERAL_FLOAT)
+        memcpy(fval, lit + 1, 4);
+    else
+        return false;
+
+    return true;
+}
+
+static uint32_t opt_literal(opt_function_t *of, uint8_t type, const void *value) {
+    dis_buffer_t *lits = &of->rw->literals[of->fn];
+    uint16_t *lit_count = &of->rw->literal_count[of->fn];
+
+    for (uint32_t i = 0; i < *lit_count; i++)
+        if (lits->data[of->lit_offset[i]] == type && !memcmp(lits->data + of->lit_offset[i] + 1, value, 4))
+            return i;
+
+    if (*lit_count == UINT16_MAX)
+        return UINT32_MAX;
+
+    if (*lit_count == of->lit_capacity) {
+        of->lit_capacity *= 2;
+        of->lit_offset = realloc(of->lit_offset, of->lit_capacity * sizeof(uint32_t));
+    }
+
+    of->lit_offset[*lit_count] = lits->len;
+    dis_buffer_byte(lits, type);
+    dis_buffer_append(lits, value, 4);
+    return (*lit_count)++;
+}
+
+static bool opt_fold_int(uint8_t op, int32_t a, int32_t b, int32_t *r) {
+    int64_t v;
+
+    switch (op) {
+        case DIS_OP_ADDITION:
+            v = (int64_t) a + b;
+            break;
+        case DIS_OP_SUBTRACTION:
+            v = (int64_t) a - b;
+            break;
+        case DIS_OP_MULTIPLICATION:
+            v = (int64_t) a * b;
+            break;
+        case DIS_OP_DIVISION:
+            if (b == 0 || (a == INT32_MIN && b == -1))
+                return false;
+            v = a / b;
+            break;
+        case DIS_OP_MODULO:
+            if (b == 0 || (a == INT32_MIN && b == -1))
+                return false;
+            v = a % b;
+            break;
+        default:
+            return false;
+    }
+
+    if (v < INT32_MIN || v > INT32_MAX)
+        return false;
+
+    *r = (int32_t) v;
+    return true;
+}
+
+static bool opt_fold_float(uint8_t op, float a, float b, float *r) {
+    switch (op) {
+        case DIS_OP_ADDITION:
+            *r = a + b;
+            break;
+        case DIS_OP_SUBTRACTION:
+            *r = a - b;
+            break;
+        case DIS_OP_MULTIPLICATION:
+            *r = a * b;
+            break;
+        case DIS_OP_DIVISION:
+            if (b == 0)
+                return false;
+            *r = a / b;
+            break;
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+static bool opt_fold(opt_function_t *of, opt_stats_t *stats) {
+    bool changed = false;
+
+    opt_mark_targets(of);
+
+    for (uint32_t i = opt_next(of, (uint32_t) -1); i < of->count; i = opt_next(of, i)) {
+        uint32_t j = opt_next(of, i), k = j < of->count ? opt_next(of, j) : of->count;
+        uint8_t ta, tb, type;
+        int32_t ia = 0, ib = 0, ir = 0;
+        float fa = 0, fb = 0, fr = 0;
+        uint32_t lit;
+
+        if (j >= of->count || of->target[j] || !opt_number(of, &of->ins[i], &ta, &ia, &fa))
+            continue;
+
+        if (of->ins[j].opcode == DIS_OP_NEGATE) {
+            if (ta == DIS_LITERAL_INTEGER) {
+                if (ia == INT32_MIN)
+                    continue;
+                ir = -ia;
+            } else
+                fr = -fa;
+            type = ta;
+            k = j;
+        } else {
+            if (k >= of->count || of->target[k] || !opt_number(of, &of->ins[j], &tb, &ib, &fb) || ta != tb)
+                continue;
+
+            if (ta == DIS_LITERAL_INTEGER ? !opt_fold_int(of->ins[k].opcode, ia, ib, &ir) : !opt_fold_float(of->ins[k].opcode, fa, fb, &fr))
+                continue;
+            type = ta;
+            of->ins[j].removed = true;
+        }
+
+        lit = opt_literal(of, type, type == DIS_LITERAL_INTEGER ? (void*) &ir : (void*) &fr);
+        if (lit == UINT32_MAX) {
+            of->ins[j].removed = false;
+            continue;
+        }
+
+        of->ins[i].opcode = lit <= UINT8_MAX ? DIS_OP_LITERAL : DIS_OP_LITERAL_LONG;
+        of->ins[i].arg[0] = lit;
+        of->ins[k].removed = true;
+        ++stats->folded;
+        changed = true;
+    }
+
+    return changed;
+}
+
+// literals appended by folds a longer chain folded again are dropped, the others renumbered
+static void opt_drop_literals(opt_function_t *of, uint16_t base) {
+    dis_buffer_t *lits = &of->rw->literals[of->fn];
+    uint16_t *lit_count = &of->rw->literal_count[of->fn];
+    uint32_t *map, kept = base, end;
+
+    if (*lit_count == base)
+        return;
+
+    map = calloc(*lit_count - base, sizeof(uint32_t));
+    for (uint32_t i = 0; i < of->count; i++)
+        if (!of->ins[i].removed && (of->ins[i].opcode == DIS_OP_LITERAL || of->ins[i].opcode == DIS_OP_LITERAL_LONG) && of->ins[i].arg[0] >= base)
+            map[of->ins[i].arg[0] - base] = 1;
+
+    end = of->lit_offset[base];
+    for (uint32_t i = base; i < *lit_count; i++) {
+        if (!map[i - base])
+            continue;
+
+        // appended entries are all a type byte and 4 value bytes
+        memmove(lits->data + end, lits->data + of->lit_offset[i], 5);
+        of->lit_offset[kept] = end;
+        end += 5;
+        map[i - base] = kept++;
+    }
+    lits->len = end;
+    *lit_count = kept;
+
+    for (uint32_t i = 0; i < of->count; i++) {
+        dis_rw_instr_t *in = &of->ins[i];
+
+        if (in->removed || (in->opcode != DIS_OP_LITERAL && in->opcode != DIS_OP_LITERAL_LONG) || in->arg[0] < base)
+            continue;
+        in->arg[0] = map[in->arg[0] - base];
+        in->opcode = in->arg[0] <= UINT8_MAX ? DIS_OP_LITERAL : DIS_OP_LITERAL_LONG;
+    }
+
+    free(map);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static uint8_t opt_function(dis_rewrite_t *rw, uint32_t fn, opt_stats_t *stats) {
+    opt_function_t of = { .rw = rw, .fn = fn, .len = rw->code[fn].len };
+    dis_buffer_t code = { NULL, 0, 0 };
+    uint16_t base = rw->literal_count[fn];
+    uint32_t pc = 0;
+
+    if (dis_rewrite_decode(rw->idx->ops, rw->code[fn].data, rw->code[fn].len, &of.ins, &of.count))
+        return 1;
+
+    of.target = malloc((of.count ? of.count : 1) * sizeof(bool));
+    of.lit_capacity = rw->literal_count[fn] ? rw->literal_count[fn] * 2 : 16;
+    of.lit_offset = malloc(of.lit_capacity * sizeof(uint32_t));
+    for (uint32_t i = 0; i < rw->literal_count[fn]; i++) {
+        uint32_t size = 0;
+        of.lit_offset[i] = pc;
+        dis_literal_size(rw->literals[fn].data, pc, rw->literals[fn].len, &size);
+        pc += size;
+    }
+
+    while (opt_pass(&of, stats) | opt_grouping(&of, stats) | opt_jumps(&of, stats) | opt_fold(&of, stats))
+        ;
+    opt_drop_literals(&of, base);
+
+    uint8_t ret = dis_rewrite_encode(rw->idx->ops, of.ins, of.count, of.len, &code);
+    if (!ret) {
+        dis_buffer_free(&rw->code[fn]);
+        rw->code[fn] = code;
+    } else
+        dis_buffer_free(&code);
+
+    free(of.ins);
+    free(of.target);
+    free(of.lit_offset);
+    return ret;
+}
+
+uint8_t dis_optimize(const char *filename, const char *output) {
+    uint8_t *program = NULL;
+    uint32_t len = 0;
+    dis_index_t idx;
+    dis_rewrite_t rw;
+    dis_buffer_t out = { NULL, 0, 0 };
+    uint8_t ret = 0;
+
+    if (dis_read_file(filename, &program, &len)) {
+        printf("Not able to open the file.\n");
+        return 1;
+    }
+
+    if (dis_index_build(program, len, &idx)) {
+        printf("ERROR: malformed bytecode in %s\n", filename);
+        dis_index_free(&idx);
+        free(program);
+        return 1;
+    }
+
+    dis_rewrite_init(&rw, &idx);
+
+    printf("\n.comment optimize %s -> %s\n", filename, output);
+    for (uint32_t i = 0; i < idx.function_count; i++) {
+        opt_stats_t stats = { 0, 0, 0, 0 };
+        uint32_t before = rw.code[i].len;
+
+        if (opt_function(&rw, i, &stats)) {
+            printf(".comment %s: not optimized (unable to re-encode)\n", idx.functions[i].path);
+            continue;
+        }
+
+        printf(".comment %s: code %u -> %u bytes (pass: %u, grouping: %u, jumps: %u, folded: %u)\n", idx.functions[i].path, before, rw.code[i].len,
+                stats.pass, stats.grouping, stats.jumps, stats.folded);
+    }
+
+    if (dis_rewrite_emit(&rw, &out) || dis_rewrite_verify(out.data, out.len)) {
+        printf("ERROR: optimized bytecode failed verification, nothing written\n");
+        ret = 1;
+    } else if (dis_write_file(output, out.data, out.len)) {
+        printf("ERROR: not able to write %s\n", output);
+        ret = 1;
+    } else
+        printf(".comment size: %u -> %u bytes\n", len, out.len);
+
+    dis_buffer_free(&out);
+    dis_rewrite_free(&rw);
+    dis_index_free(&idx);
+    free(program);
+    return ret;
+}
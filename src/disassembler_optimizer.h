@@ -0,0 +1,16 @@
+/*
+ * disassembler_optimizer.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Peephole bytecode optimizer: rewrites each function code section and writes a new .tb.
+ */
+
+#ifndef DISASSEMBLER_OPTIMIZER_H_
+#define DISASSEMBLER_OPTIMIZER_H_
+
+#include <stdint.h>
+
+uint8_t dis_optimize(const char *filename, const char *output);
+
+#endif /* DISASSEMBLER_OPTIMIZER_H_ */
@@ -0,0 +1,210 @@
+/*
+ * disassembler_profile.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Profile lines are "OFFSET COUNT" (absolute file offset), "PATH:OFFSET COUNT" (offset
+ * relative to the code start, as printed in the listings) or "PATH: COUNT" for hits only
+ * known per function. Offsets inside an instruction are credited to that instruction.
+ * A block is credited with the hits of all its instructions, so sampled profiles add up
+ * to 100% as well as instrumented ones.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "disassembler_index.h"
+#include "disassembler_symbolize.h"
+#include "disassembler_profile.h"
+
+#define PROFILE_TOP_BLOCKS 20
+
+typedef struct profile_block_s {
+    uint32_t fn;
+    uint32_t offset; // absolute
+    uint64_t hits;
+} profile_block_t;
+
+static int32_t profile_find_path(const dis_index_t *idx, const char *path) {
+    for (uint32_t i = 0; i < idx->function_count; i++)
+        if (!strcmp(idx->functions[i].path, path))
+            return i;
+
+    return -1;
+}
+
+static void profile_blocks(dis_profile_t *profile, uint32_t fn) {
+    const dis_function_t *f = &profile->idx.functions[fn];
+    dis_instruction_t *ins = NULL;
+    uint32_t count = 0, leader = f->code_start;
+
+    dis_index_decode_function(&profile->idx, fn, &ins, &count);
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (ins[i].opcode < DIS_OP_END_OPCODES && OP_ARGS[ins[i].opcode][2] && f->code_start + ins[i].arg[0] < f->code_end)
+            profile->leader[f->code_start + ins[i].arg[0]] = true;
+        if ((ins[i].opcode < DIS_OP_END_OPCODES && OP_ARGS[ins[i].opcode][2]) || ins[i].opcode == DIS_OP_FN_RETURN)
+            if (i + 1 < count)
+                profile->leader[ins[i + 1].offset] = true;
+    }
+    if (count)
+        profile->leader[f->code_start] = true;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (profile->leader[ins[i].offset])
+            leader = ins[i].offset;
+        profile->blocks[leader] += profile->counts[ins[i].offset];
+        profile->fn_hits[fn] += profile->counts[ins[i].offset];
+    }
+
+    free(ins);
+}
+
+uint8_t dis_profile_load(const char *filename, const uint8_t *program, uint32_t len, dis_profile_t *profile) {
+    dis_symbolizer_t sym;
+    FILE *f;
+    char line[DIS_PATH_MAX + 64];
+    uint64_t *path_hits;
+
+    memset(profile, 0, sizeof(dis_profile_t));
+
+    if (dis_index_build(program, len, &profile->idx) || dis_symbolizer_build(&profile->idx, &sym)) {
+        dis_index_free(&profile->idx);
+        return 1;
+    }
+
+    f = fopen(filename, "r");
+    if (f == NULL) {
+        dis_symbolizer_free(&sym);
+        dis_index_free(&profile->idx);
+        return 1;
+    }
+
+    profile->len = len;
+    profile->counts = calloc(len + 1, sizeof(uint64_t));
+    profile->blocks = calloc(len + 1, sizeof(uint64_t));
+    profile->leader = calloc(len + 1, sizeof(bool));
+    profile->fn_hits = calloc(profile->idx.function_count, sizeof(uint64_t));
+    path_hits = calloc(profile->idx.function_count, sizeof(uint64_t));
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        char path[DIS_PATH_MAX];
+        unsigned long long offset, hits;
+        const dis_symbol_t *s;
+        int32_t fn = 0;
+        uint32_t base = 0;
+
+        if (line[0] == '#' || line[0] == '\n')
+            continue;
+
+        int n = sscanf(line, "%255[^: \t]:%lli %llu", path, &offset, &hits);
+
+        if (n == 2 && (line[strlen(path) + 1] == ' ' || line[strlen(path) + 1] == '\t')) {
+            // "PATH: COUNT"
+            fn = profile_find_path(&profile->idx, path);
+            if (fn >= 0) {
+                path_hits[fn] += offset;
+                profile->total += offset;
+            } else
+                profile->unmapped += offset;
+            continue;
+        } else if (n == 3) {
+            fn = profile_find_path(&profile->idx, path);
+            base = fn >= 0 ? profile->idx.functions[fn].code_start : len;
+        } else if (sscanf(line, "%lli %llu", &offset, &hits) != 2)
+            continue;
+
+        s = base + offset < len ? dis_symbolize(&sym, base + offset) : NULL;
+        if (s == NULL || s->kind != DIS_SYMBOL_CODE) {
+            profile->unmapped += hits;
+            continue;
+        }
+
+        profile->counts[s->offset] += hits;
+        profile->total += hits;
+    }
+    fclose(f);
+
+    for (uint32_t i = 0; i < profile->idx.function_count; i++) {
+        profile_blocks(profile, i);
+        profile->fn_hits[i] += path_hits[i];
+    }
+
+    free(path_hits);
+    dis_symbolizer_free(&sym);
+    return 0;
+}
+
+void dis_profile_free(dis_profile_t *profile) {
+    free(profile->counts);
+    free(profile->blocks);
+    free(profile->leader);
+    free(profile->fn_hits);
+    dis_index_free(&profile->idx);
+    memset(profile, 0, sizeof(dis_profile_t));
+}
+
+double dis_profile_percent(const dis_profile_t *profile, uint64_t hits) {
+    return profile->total ? 100.0 * hits / profile->total : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static int profile_cmp_block(const void *a, const void *b) {
+    const profile_block_t *x = a, *y = b;
+
+    if (x->hits != y->hits)
+        return x->hits < y->hits ? 1 : -1;
+
+    return x->offset < y->offset ? -1 : x->offset > y->offset;
+}
+
+void dis_profile_summary(const dis_profile_t *profile, FILE *out) {
+    const dis_index_t *idx = &profile->idx;
+    profile_block_t *list;
+    uint32_t count = 0, blocks = 0;
+
+    for (uint32_t o = 0; o < profile->len; o++)
+        blocks += profile->leader[o];
+
+    count = idx->function_count > blocks ? idx->function_count : blocks;
+    list = malloc((count ? count : 1) * sizeof(profile_block_t));
+
+    fprintf(out, "\n.comment profile: %llu hits, %llu unmapped\n", (unsigned long long) profile->total, (unsigned long long) profile->unmapped);
+
+    // hottest functions first
+    for (uint32_t i = 0; i < idx->function_count; i++) {
+        list[i].fn = i;
+        list[i].offset = idx->functions[i].code_start;
+        list[i].hits = profile->fn_hits[i];
+    }
+    qsort(list, idx->function_count, sizeof(profile_block_t), profile_cmp_block);
+
+    fprintf(out, ".comment functions:\n");
+    for (uint32_t i = 0; i < idx->function_count && list[i].hits; i++)
+        fprintf(out, ".comment   %-16s %12llu %6.2f%%\n", idx->functions[list[i].fn].path, (unsigned long long) list[i].hits,
+                dis_profile_percent(profile, list[i].hits));
+
+    count = 0;
+    for (uint32_t i = 0; i < idx->function_count; i++) {
+        const dis_function_t *f = &idx->functions[i];
+
+        for (uint32_t o = f->code_start; o < f->code_end; o++) {
+            if (!profile->leader[o] || !profile->blocks[o])
+                continue;
+
+            list[count].fn = i;
+            list[count].offset = o;
+            list[count++].hits = profile->blocks[o];
+        }
+    }
+    qsort(list, count, sizeof(profile_block_t), profile_cmp_block);
+
+    fprintf(out, ".comment hot blocks:\n");
+    for (uint32_t i = 0; i < count && i < PROFILE_TOP_BLOCKS; i++)
+        fprintf(out, ".comment   %-16s [%05d] %12llu %6.2f%%\n", idx->functions[list[i].fn].path, list[i].offset - idx->functions[list[i].fn].code_start,
+                (unsigned long long) list[i].hits, dis_profile_percent(profile, list[i].hits));
+
+    free(list);
+}
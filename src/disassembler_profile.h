@@ -0,0 +1,34 @@
+/*
+ * disassembler_profile.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Execution counts from a VM profile, merged into the disassembly listings.
+ */
+
+#ifndef DISASSEMBLER_PROFILE_H_
+#define DISASSEMBLER_PROFILE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "disassembler_index.h"
+
+typedef struct dis_profile_s {
+    dis_index_t idx;       //
+    uint32_t len;          //
+    uint64_t *counts;      // per absolute instruction offset
+    uint64_t *blocks;      // per absolute block leader offset, hits of the whole block
+    bool *leader;          // per absolute offset
+    uint64_t *fn_hits;     // per function, instruction hits plus PATH only entries
+    uint64_t total;        // every hit mapped to the file
+    uint64_t unmapped;     // hits whose offset or path is not in the file
+} dis_profile_t;
+
+uint8_t dis_profile_load(const char *filename, const uint8_t *program, uint32_t len, dis_profile_t *profile);
+void dis_profile_free(dis_profile_t *profile);
+double dis_profile_percent(const dis_profile_t *profile, uint64_t hits);
+void dis_profile_summary(const dis_profile_t *profile, FILE *out);
+
+#endif /* DISASSEMBLER_PROFILE_H_ */
@@ -0,0 +1,295 @@
+/*
+ * disassembler_rewrite.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Bytecode re-encoding support.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "disassembler_rewrite.h"
+
+// with a program-less index (built by the assembler) the buffers start empty
+void dis_rewrite_init(dis_rewrite_t *rw, const dis_index_t *idx) {
+    rw->idx = idx;
+    rw->header = (dis_buffer_t) { NULL, 0, 0 };
+    rw->function_count = calloc(idx->function_count, sizeof(uint16_t));
+    rw->literals = calloc(idx->function_count, sizeof(dis_buffer_t));
+    rw->literal_count = calloc(idx->function_count, sizeof(uint16_t));
+    rw->code = calloc(idx->function_count, sizeof(dis_buffer_t));
+    rw->args = calloc(idx->function_count, sizeof(uint16_t));
+    rw->rets = calloc(idx->function_count, sizeof(uint16_t));
+
+    for (uint32_t i = 0; i < idx->function_count; i++) {
+        rw->args[i] = idx->functions[i].args;
+        rw->rets[i] = idx->functions[i].rets;
+    }
+
+    if (idx->program == NULL)
+        return;
+
+    dis_buffer_append(&rw->header, idx->program, idx->header_end);
+    for (uint32_t i = 0; i < idx->function_count; i++) {
+        const dis_function_t *f = &idx->functions[i];
+
+        memcpy(&rw->function_count[i], idx->program + f->lit_end, 2);
+        rw->literal_count[i] = f->literal_count;
+        // literal entries run from after the count word up to the SECTION_END
+        dis_buffer_append(&rw->literals[i], idx->program + f->start + 2, f->lit_end - 1 - (f->start + 2));
+        dis_buffer_append(&rw->code[i], idx->program + f->code_start, f->code_end - f->code_start);
+    }
+}
+
+void dis_rewrite_free(dis_rewrite_t *rw) {
+    for (uint32_t i = 0; i < rw->idx->function_count; i++) {
+        dis_buffer_free(&rw->literals[i]);
+        dis_buffer_free(&rw->code[i]);
+    }
+
+    dis_buffer_free(&rw->header);
+    free(rw->function_count);
+    free(rw->literals);
+    free(rw->literal_count);
+    free(rw->code);
+    free(rw->args);
+    free(rw->rets);
+}
+
+static uint8_t rw_emit_section(const dis_rewrite_t *rw, uint32_t fn, dis_buffer_t *out) {
+    const dis_index_t *idx = rw->idx;
+    const dis_function_t *f = &idx->functions[fn];
+    uint16_t word;
+    uint32_t size_pos;
+
+    dis_buffer_word(out, rw->literal_count[fn]);
+    dis_buffer_append(out, rw->literals[fn].data, rw->literals[fn].len);
+    dis_buffer_byte(out, DIS_OP_SECTION_END);
+
+    dis_buffer_word(out, rw->function_count[fn]);
+    size_pos = out->len;
+    dis_buffer_word(out, 0);
+
+    // children follow their parent in the pre-order index
+    for (uint32_t c = fn + 1; c < idx->function_count && idx->functions[c].depth > f->depth; c++) {
+        const dis_function_t *child = &idx->functions[c];
+        uint32_t pos;
+
+        if (child->parent != (int32_t) fn)
+            continue;
+
+        pos = out->len;
+        dis_buffer_word(out, 0);
+
+        if (rw_emit_section(rw, c, out))
+            return 1;
+
+        dis_buffer_word(out, rw->args[c]);
+        dis_buffer_word(out, rw->rets[c]);
+        dis_buffer_append(out, rw->code[c].data, rw->code[c].len);
+        dis_buffer_byte(out, DIS_OP_FN_END);
+
+        if (out->len - pos - 2 > UINT16_MAX)
+            return 1;
+        word = out->len - pos - 2;
+        memcpy(out->data + pos, &word, 2);
+    }
+
+    if (out->len - size_pos - 2 > UINT16_MAX)
+        return 1;
+    word = out->len - size_pos - 2;
+    memcpy(out->data + size_pos, &word, 2);
+
+    dis_buffer_byte(out, DIS_OP_SECTION_END);
+    return 0;
+}
+
+uint8_t dis_rewrite_emit(const dis_rewrite_t *rw, dis_buffer_t *out) {
+    dis_buffer_append(out, rw->header.data, rw->header.len);
+
+    if (rw_emit_section(rw, 0, out))
+        return 1;
+
+    dis_buffer_append(out, rw->code[0].data, rw->code[0].len);
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+uint8_t dis_rewrite_size(const dis_opset_t *ops, uint8_t opcode) {
+    uint8_t size = 1;
+
+    if (opcode >= DIS_OP_END_OPCODES)
+        return size;
+
+    for (uint8_t n = 0; n < 2; n++) {
+        switch (ops->args[opcode][n]) {
+            case DIS_ARG_BYTE:
+                size += 1;
+                break;
+            case DIS_ARG_WORD:
+                size += 2;
+                break;
+            case DIS_ARG_INTEGER:
+            case DIS_ARG_FLOAT:
+                size += 4;
+                break;
+        }
+    }
+
+    return size;
+}
+
+uint8_t dis_rewrite_decode(const dis_opset_t *ops, const uint8_t *code, uint32_t len, dis_rw_instr_t **ins, uint32_t *count) {
+    dis_instruction_t di;
+    uint32_t capacity = 64;
+
+    *count = 0;
+    *ins = malloc(capacity * sizeof(dis_rw_instr_t));
+
+    for (uint32_t pc = 0; pc < len; pc += di.size) {
+        if (ops->decode(code, pc, len, &di) || (di.opcode < DIS_OP_END_OPCODES && ops->args[di.opcode][0] == DIS_ARG_STRING)) {
+            free(*ins);
+            *ins = NULL;
+            return 1;
+        }
+
+        if (*count == capacity) {
+            capacity *= 2;
+            *ins = realloc(*ins, capacity * sizeof(dis_rw_instr_t));
+        }
+
+        (*ins)[*count].offset = pc;
+        (*ins)[*count].opcode = di.opcode;
+        (*ins)[*count].arg[0] = di.arg[0];
+        (*ins)[*count].arg[1] = di.arg[1];
+        (*ins)[*count].removed = false;
+        ++(*count);
+    }
+
+    return 0;
+}
+
+static uint8_t rw_map_target(const dis_rw_instr_t *ins, const uint32_t *new_offset, uint32_t count, uint32_t len, uint32_t new_len, uint32_t target,
+        uint32_t *mapped) {
+    uint32_t lo = 0, hi = count;
+
+    if (target == len) {
+        *mapped = new_len;
+        return 0;
+    }
+
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (ins[mid].offset < target)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == count || ins[lo].offset != target)
+        return 1;
+
+    // a removed instruction forwards to the next surviving one
+    while (lo < count && ins[lo].removed)
+        ++lo;
+
+    *mapped = lo < count ? new_offset[lo] : new_len;
+    return 0;
+}
+
+uint8_t dis_rewrite_encode(const dis_opset_t *ops, const dis_rw_instr_t *ins, uint32_t count, uint32_t len, dis_buffer_t *code) {
+    uint32_t *new_offset = malloc((count ? count : 1) * sizeof(uint32_t));
+    uint32_t new_len = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        new_offset[i] = new_len;
+        if (!ins[i].removed)
+            new_len += dis_rewrite_size(ops, ins[i].opcode);
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t opcode = ins[i].opcode;
+
+        if (ins[i].removed)
+            continue;
+
+        dis_buffer_byte(code, opcode);
+        if (opcode >= DIS_OP_END_OPCODES)
+            continue;
+
+        for (uint8_t n = 0; n < 2; n++) {
+            uint32_t arg = ins[i].arg[n];
+
+            if (n == 0 && ops->args[opcode][2] && rw_map_target(ins, new_offset, count, len, new_len, arg, &arg)) {
+                free(new_offset);
+                return 1;
+            }
+
+            switch (ops->args[opcode][n]) {
+                case DIS_ARG_BYTE:
+                    if (arg > UINT8_MAX) {
+                        free(new_offset);
+                        return 1;
+                    }
+                    dis_buffer_byte(code, arg);
+                    break;
+                case DIS_ARG_WORD:
+                    if (arg > UINT16_MAX) {
+                        free(new_offset);
+                        return 1;
+                    }
+                    dis_buffer_word(code, arg);
+                    break;
+                case DIS_ARG_INTEGER:
+                case DIS_ARG_FLOAT:
+                    dis_buffer_append(code, &arg, 4);
+                    break;
+            }
+        }
+    }
+
+    free(new_offset);
+    return 0;
+}
+
+uint8_t dis_rewrite_verify(const uint8_t *program, uint32_t len) {
+    dis_index_t idx;
+    uint8_t ret = 0;
+
+    if (dis_index_build(program, len, &idx)) {
+        dis_index_free(&idx);
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < idx.function_count && !ret; i++) {
+        const dis_function_t *f = &idx.functions[i];
+        uint32_t code_len = f->code_end - f->code_start;
+        uint8_t *boundary = calloc(code_len + 1, sizeof(uint8_t));
+        dis_rw_instr_t *ins;
+        uint32_t count;
+
+        if (dis_rewrite_decode(idx.ops, program + f->code_start, code_len, &ins, &count)) {
+            free(boundary);
+            ret = 1;
+            break;
+        }
+
+        boundary[code_len] = 1;
+        for (uint32_t n = 0; n < count; n++)
+            boundary[ins[n].offset] = 1;
+
+        // every jump must land on an instruction boundary
+        for (uint32_t n = 0; n < count; n++)
+            if (ins[n].opcode < DIS_OP_END_OPCODES && idx.ops->args[ins[n].opcode][2] && (ins[n].arg[0] > code_len || !boundary[ins[n].arg[0]]))
+                ret = 1;
+
+        free(ins);
+        free(boundary);
+    }
+
+    dis_index_free(&idx);
+    return ret;
+}
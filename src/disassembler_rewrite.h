@@ -0,0 +1,46 @@
+/*
+ * disassembler_rewrite.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Bytecode re-encoding support: editable per-function literal and code buffers built
+ * from an index, and serialization back to a .tb with all size words recomputed.
+ */
+
+#ifndef DISASSEMBLER_REWRITE_H_
+#define DISASSEMBLER_REWRITE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "disassembler_utils.h"
+#include "disassembler_index.h"
+
+typedef struct dis_rewrite_s {
+    const dis_index_t *idx;   // function tree (path, parent, depth)
+    dis_buffer_t header;      // version bytes, build string and the first SECTION_END
+    uint16_t *function_count; // per function, as stored in its function section
+    dis_buffer_t *literals;  // raw literal entries per function (count word and SECTION_END excluded)
+    uint16_t *literal_count; //
+    dis_buffer_t *code;      // raw code per function (args/rets and FN_END excluded)
+    uint16_t *args;          // args/rets literal indexes per function, emitted before the code
+    uint16_t *rets;          //
+} dis_rewrite_t;
+
+typedef struct dis_rw_instr_s {
+    uint32_t offset; // original offset, relative to the code start
+    uint8_t opcode;  //
+    uint32_t arg[2]; // jump arguments hold original relative offsets until encoded
+    bool removed;    //
+} dis_rw_instr_t;
+
+void dis_rewrite_init(dis_rewrite_t *rw, const dis_index_t *idx);
+void dis_rewrite_free(dis_rewrite_t *rw);
+uint8_t dis_rewrite_emit(const dis_rewrite_t *rw, dis_buffer_t *out);
+
+uint8_t dis_rewrite_decode(const dis_opset_t *ops, const uint8_t *code, uint32_t len, dis_rw_instr_t **ins, uint32_t *count);
+uint8_t dis_rewrite_encode(const dis_opset_t *ops, const dis_rw_instr_t *ins, uint32_t count, uint32_t len, dis_buffer_t *code);
+uint8_t dis_rewrite_size(const dis_opset_t *ops, uint8_t opcode);
+uint8_t dis_rewrite_verify(const uint8_t *program, uint32_t len);
+
+#endif /* DISASSEMBLER_REWRITE_H_ */
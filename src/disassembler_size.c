@@ -0,0 +1,204 @@
+/*
+ * disassembler_size.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * A function owns its size word in the parent's function section, its literal cache,
+ * the count words and SECTION_END markers of both sections, args/rets, its code and
+ * FN_END. Nested function bodies belong to the nested function, so the header plus the
+ * self bytes of every function add up to the file size. SECTION_END and EOF opcodes
+ * inside a code section are counted as markers, like the trailing ones.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "disassembler_utils.h"
+#include "disassembler_index.h"
+#include "disassembler_size.h"
+
+typedef struct size_entry_s {
+    uint32_t key; //
+    uint32_t fn;  //
+} size_entry_t;
+
+static const char *SORT_NAMES[] = { "total", "self", "code", "literals", "tree" };
+
+static int size_compare(const void *a, const void *b) {
+    const size_entry_t *x = a, *y = b;
+
+    if (x->key != y->key)
+        return x->key < y->key ? 1 : -1;
+    return x->fn < y->fn ? -1 : x->fn > y->fn;
+}
+
+dis_size_t* dis_size_analyze(const dis_index_t *idx) {
+    dis_size_t *sizes = calloc(idx->function_count ? idx->function_count : 1, sizeof(dis_size_t));
+
+    for (uint32_t i = 0; i < idx->function_count; i++) {
+        const dis_function_t *f = &idx->functions[i];
+        dis_size_t *s = &sizes[i];
+        dis_instruction_t *ins;
+        uint32_t count;
+
+        s->self = f->end - f->start + (f->parent >= 0 ? 2 : 0);
+        s->markers = f->parent >= 0 ? 3 : 2;
+
+        for (uint32_t l = 0; l < f->literal_count; l++) {
+            s->literals += f->literals[l].size;
+            s->by_type[f->literals[l].type] += f->literals[l].size;
+        }
+
+        // instructions after a decode error stay code
+        dis_index_decode_function(idx, i, &ins, &count);
+        for (uint32_t n = 0; n < count; n++)
+            if (ins[n].opcode == DIS_OP_SECTION_END || ins[n].opcode == DIS_OP_EOF)
+                s->markers += ins[n].size;
+        free(ins);
+
+        s->code = f->code_end - f->code_start - (s->markers - (f->parent >= 0 ? 3 : 2));
+    }
+
+    // children come after their parent in pre-order
+    for (uint32_t i = idx->function_count; i-- > 1;) {
+        const dis_function_t *f = &idx->functions[i];
+        sizes[f->parent].self -= f->end - f->start + 2;
+    }
+
+    for (uint32_t i = 0; i < idx->function_count; i++) {
+        dis_size_t *s = &sizes[i];
+        s->overhead = s->self - s->literals - s->code - s->markers;
+        s->total = s->self;
+    }
+
+    for (uint32_t i = idx->function_count; i-- > 1;)
+        sizes[idx->functions[i].parent].total += sizes[i].total;
+
+    return sizes;
+}
+
+uint8_t dis_size_sort_key(const char *name, dis_size_sort_t *sort) {
+    for (uint32_t i = 0; i < sizeof(SORT_NAMES) / sizeof(SORT_NAMES[0]); i++) {
+        if (!strcmp(name, SORT_NAMES[i])) {
+            *sort = i;
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static double size_percent(uint32_t bytes, uint32_t len) {
+    return len ? 100.0 * bytes / len : 0.0;
+}
+
+static void size_print_file(const char *file, const dis_index_t *idx, const dis_size_t *sizes, const size_entry_t *order, uint32_t shown, dis_size_sort_t sort,
+        bool json) {
+    uint32_t literals = 0, overhead = 0, code = 0, markers = 0, by_type[256] = { 0 };
+
+    for (uint32_t i = 0; i < idx->function_count; i++) {
+        literals += sizes[i].literals;
+        overhead += sizes[i].overhead;
+        code += sizes[i].code;
+        markers += sizes[i].markers;
+        for (uint32_t t = 0; t < 256; t++)
+            by_type[t] += sizes[i].by_type[t];
+    }
+
+    if (json) {
+        printf("{ \"file\": ");
+        str_print_json(file);
+        printf(", \"bytes\": %u, \"header\": %u, \"literals\": { \"total\": %u", idx->len, idx->header_end, literals);
+        for (uint32_t t = 0; t <= DIS_LITERAL_INDEX_BLANK; t++)
+            if (by_type[t])
+                printf(", \"%s\": %u", LIT_STR[t] + 12, by_type[t]);
+        printf(" }, \"overhead\": %u, \"code\": %u, \"markers\": %u, \"sort\": \"%s\", \"functions\": [", overhead, code, markers, SORT_NAMES[sort]);
+
+        for (uint32_t i = 0; i < shown; i++) {
+            const dis_size_t *s = &sizes[order[i].fn];
+            printf("%s\n    { \"path\": ", i ? "," : "");
+            str_print_json(idx->functions[order[i].fn].path);
+            printf(", \"total\": %u, \"self\": %u, \"code\": %u, \"literals\": %u, \"overhead\": %u, \"markers\": %u }", s->total, s->self, s->code,
+                    s->literals, s->overhead, s->markers);
+        }
+        printf("\n  ] }");
+        return;
+    }
+
+    printf("\n.comment size attribution: %s, %u bytes\n", file, idx->len);
+    printf("header                      %10u %6.2f%%\n", idx->header_end, size_percent(idx->header_end, idx->len));
+    printf("literal cache               %10u %6.2f%%\n", literals, size_percent(literals, idx->len));
+
+    // literal types largest first
+    for (;;) {
+        uint32_t t = 0;
+        for (uint32_t n = 1; n <= DIS_LITERAL_INDEX_BLANK; n++)
+            if (by_type[n] > by_type[t])
+                t = n;
+        if (!by_type[t])
+            break;
+        printf("    %-24s%10u %6.2f%%\n", LIT_STR[t] + 12, by_type[t], size_percent(by_type[t], idx->len));
+        by_type[t] = 0;
+    }
+
+    printf("section overhead            %10u %6.2f%%\n", overhead, size_percent(overhead, idx->len));
+    printf("code                        %10u %6.2f%%\n", code, size_percent(code, idx->len));
+    printf("end markers                 %10u %6.2f%%\n", markers, size_percent(markers, idx->len));
+
+    printf("\n.comment functions by %s%s\n", SORT_NAMES[sort], sort == DIS_SIZE_SORT_TOTAL ? " (function and nested functions)" : "");
+    printf("     total       self       code   literals   overhead    markers  path\n");
+    for (uint32_t i = 0; i < shown; i++) {
+        const dis_size_t *s = &sizes[order[i].fn];
+        const dis_function_t *f = &idx->functions[order[i].fn];
+
+        printf("%10u %10u %10u %10u %10u %10u  %*s%s\n", s->total, s->self, s->code, s->literals, s->overhead, s->markers,
+                sort == DIS_SIZE_SORT_TREE ? 2 * f->depth : 0, "", f->path);
+    }
+    if (shown < idx->function_count)
+        printf("( %u more functions )\n", idx->function_count - shown);
+}
+
+void dis_size_report(char **files, uint32_t file_count, dis_size_sort_t sort, uint32_t top, bool json) {
+    uint32_t printed = 0;
+
+    if (json)
+        printf("[");
+
+    for (uint32_t n = 0; n < file_count; n++) {
+        uint8_t *program = NULL;
+        uint32_t len = 0;
+        dis_index_t idx;
+
+        if (dis_read_file(files[n], &program, &len) || dis_index_build(program, len, &idx)) {
+            fprintf(stderr, "%s: not able to decode the file\n", files[n]);
+            if (program != NULL)
+                dis_index_free(&idx);
+            free(program);
+            continue;
+        }
+
+        dis_size_t *sizes = dis_size_analyze(&idx);
+        size_entry_t *order = malloc(idx.function_count * sizeof(size_entry_t));
+
+        for (uint32_t i = 0; i < idx.function_count; i++) {
+            order[i].fn = i;
+            order[i].key = sort == DIS_SIZE_SORT_TOTAL ? sizes[i].total : sort == DIS_SIZE_SORT_SELF ? sizes[i].self :
+                           sort == DIS_SIZE_SORT_CODE ? sizes[i].code : sort == DIS_SIZE_SORT_LITERALS ? sizes[i].literals : 0;
+        }
+        if (sort != DIS_SIZE_SORT_TREE)
+            qsort(order, idx.function_count, sizeof(size_entry_t), size_compare);
+
+        if (json)
+            printf("%s\n  ", printed++ ? "," : "");
+        size_print_file(files[n], &idx, sizes, order, top < idx.function_count ? top : idx.function_count, sort, json);
+
+        free(order);
+        free(sizes);
+        dis_index_free(&idx);
+        free(program);
+    }
+
+    if (json)
+        printf("\n]\n");
+}
@@ -0,0 +1,41 @@
+/*
+ * disassembler_size.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Attribution of every byte of a bytecode file to the header, literal caches by type,
+ * section overhead, code and end markers, per function and rolled up the function tree.
+ */
+
+#ifndef DISASSEMBLER_SIZE_H_
+#define DISASSEMBLER_SIZE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "disassembler_index.h"
+
+typedef enum DIS_SIZE_SORT {
+    DIS_SIZE_SORT_TOTAL,    // function and its subtree, largest first
+    DIS_SIZE_SORT_SELF,     //
+    DIS_SIZE_SORT_CODE,     //
+    DIS_SIZE_SORT_LITERALS, //
+    DIS_SIZE_SORT_TREE,     // pre-order, indented by depth
+} dis_size_sort_t;
+
+typedef struct dis_size_s {
+    uint32_t self;           // bytes owned by the function, its size word included
+    uint32_t total;          // self plus every nested function
+    uint32_t code;           // opcodes and operands
+    uint32_t literals;       // literal cache entries
+    uint32_t overhead;       // count, size and args/rets words
+    uint32_t markers;        // SECTION_END, FN_END and EOF bytes
+    uint32_t by_type[256];   // literal bytes per DIS_LITERAL_* type
+} dis_size_t;
+
+// one entry per function, in index order
+dis_size_t* dis_size_analyze(const dis_index_t *idx);
+uint8_t dis_size_sort_key(const char *name, dis_size_sort_t *sort);
+void dis_size_report(char **files, uint32_t file_count, dis_size_sort_t sort, uint32_t top, bool json);
+
+#endif /* DISASSEMBLER_SIZE_H_ */
@@ -0,0 +1,345 @@
+/*
+ * disassembler_stack.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Depths are propagated along fallthrough and jump edges with a worklist. Arguments are
+ * bound to names when a function is called, so every code section starts at depth 0; the
+ * args/rets words only give the declared parameter and return counts.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "disassembler_utils.h"
+#include "disassembler_index.h"
+#include "disassembler_stack.h"
+
+static void stack_event(dis_stack_event_t **events, uint32_t *count, uint32_t offset, int32_t a, int32_t b) {
+    if (!(*count & (*count - 1)))
+        *events = realloc(*events, (*count ? *count * 2 : 1) * sizeof(dis_stack_event_t));
+
+    (*events)[*count].offset = offset;
+    (*events)[*count].depth[0] = a;
+    (*events)[*count].depth[1] = b;
+    ++(*count);
+}
+
+static uint16_t stack_list_length(const dis_index_t *idx, const dis_function_t *f, uint16_t literal) {
+    uint16_t length;
+
+    if (literal >= f->literal_count)
+        return 0;
+
+    const dis_literal_t *lit = &f->literals[literal];
+    if (lit->type != DIS_LITERAL_ARRAY && lit->type != DIS_LITERAL_ARRAY_INTERMEDIATE)
+        return 0;
+
+    memcpy(&length, idx->program + lit->offset + 1, 2);
+    return length;
+}
+
+// argument count of FN_CALL/DOT, the integer literal pushed right before it
+static int32_t stack_call_args(const dis_index_t *idx, const dis_function_t *f, const dis_stack_info_t *info, uint32_t i) {
+    int32_t argc;
+
+    if (i == 0 || (info->ins[i - 1].opcode != DIS_OP_LITERAL && info->ins[i - 1].opcode != DIS_OP_LITERAL_LONG))
+        return -1;
+    if (info->ins[i - 1].arg[0] >= f->literal_count || f->literals[info->ins[i - 1].arg[0]].type != DIS_LITERAL_INTEGER)
+        return -1;
+
+    memcpy(&argc, idx->program + f->literals[info->ins[i - 1].arg[0]].offset + 1, 4);
+    return argc < 0 ? -1 : argc;
+}
+
+static bool stack_literal_is(const dis_index_t *idx, const dis_function_t *f, uint32_t literal, uint8_t type, const char *name) {
+    if (literal >= f->literal_count || f->literals[literal].type != type)
+        return false;
+    return name == NULL || !strcmp((const char*) idx->program + f->literals[literal].offset + 1, name);
+}
+
+// values left by a call to a function declared in this file, the largest FN_RETURN count
+static int32_t stack_declared_returns(const dis_index_t *idx, uint32_t fn, const char *name) {
+    for (int32_t g = fn; g >= 0; g = idx->functions[g].parent) {
+        const dis_function_t *gf = &idx->functions[g];
+        dis_instruction_t ins;
+
+        for (uint32_t pc = gf->code_start; pc < gf->code_end; pc += ins.size) {
+            uint32_t ordinal = 0;
+
+            if (idx->ops->decode(idx->program, pc, gf->code_end, &ins))
+                break;
+            if ((ins.opcode != DIS_OP_FN_DECL && ins.opcode != DIS_OP_FN_DECL_LONG) || !stack_literal_is(idx, gf, ins.arg[0], DIS_LITERAL_IDENTIFIER, name)
+                    || !stack_literal_is(idx, gf, ins.arg[1], DIS_LITERAL_FUNCTION, NULL))
+                continue;
+
+            for (uint32_t l = 0; l < ins.arg[1]; l++)
+                ordinal += gf->literals[l].type == DIS_LITERAL_FUNCTION;
+
+            for (uint32_t c = g + 1; c < idx->function_count && idx->functions[c].depth > gf->depth; c++) {
+                if (idx->functions[c].parent != g || ordinal--)
+                    continue;
+
+                const dis_function_t *cf = &idx->functions[c];
+                int32_t returns = 0;
+                dis_instruction_t r;
+                for (uint32_t rpc = cf->code_start; rpc < cf->code_end; rpc += r.size) {
+                    if (idx->ops->decode(idx->program, rpc, cf->code_end, &r))
+                        return 1;
+                    if (r.opcode == DIS_OP_FN_RETURN && (int32_t) r.arg[0] > returns)
+                        returns = r.arg[0];
+                }
+                return returns;
+            }
+        }
+    }
+
+    return 1;
+}
+
+// the callee identifier was pushed at the depth the call leaves behind, found on the straight-line path
+static int32_t stack_call_returns(const dis_index_t *idx, uint32_t fn, const dis_stack_info_t *info, uint32_t i, int32_t argc) {
+    const dis_function_t *f = &idx->functions[fn];
+    int32_t depth = info->depth[i] - argc - 2;
+
+    for (uint32_t j = i; j-- > 0;) {
+        if (info->depth[j] < 0 || info->depth[j] < depth)
+            break;
+        if (info->depth[j] != depth)
+            continue;
+        if ((info->ins[j].opcode == DIS_OP_LITERAL || info->ins[j].opcode == DIS_OP_LITERAL_LONG)
+                && stack_literal_is(idx, f, info->ins[j].arg[0], DIS_LITERAL_IDENTIFIER, NULL))
+            return stack_declared_returns(idx, fn, (const char*) idx->program + f->literals[info->ins[j].arg[0]].offset + 1);
+        break;
+    }
+
+    return 1;
+}
+
+// INDEX_ASSIGN also pops the compound left by each INDEX_ASSIGN_INTERMEDIATE of its statement
+static int32_t stack_index_assign(const dis_stack_info_t *info, uint32_t i) {
+    int32_t pops = 5;
+
+    while (i-- > 0) {
+        uint8_t op = info->ins[i].opcode;
+
+        if (op == DIS_OP_INDEX_ASSIGN_INTERMEDIATE)
+            ++pops;
+        else if (op >= DIS_OP_END_OPCODES || (OP_STACK[op][1] == 0 && op != DIS_OP_GROUPING_BEGIN && op != DIS_OP_GROUPING_END))
+            break;
+    }
+
+    return pops;
+}
+
+static void stack_merge(dis_stack_info_t *info, uint32_t *work, uint32_t *work_len, uint32_t code_start, uint32_t s, int32_t depth) {
+    if (s >= info->count)
+        return;
+
+    if (info->depth[s] < 0) {
+        info->depth[s] = depth;
+        work[(*work_len)++] = s;
+    } else if (info->depth[s] != depth)
+        stack_event(&info->conflicts, &info->conflict_count, info->ins[s].offset - code_start, info->depth[s], depth);
+}
+
+// pops and pushes of instruction i, false when the argument count of a call is not a literal
+bool dis_stack_effect(const dis_index_t *idx, uint32_t fn, const dis_stack_info_t *info, uint32_t i, int32_t *pops, int32_t *pushes) {
+    const dis_instruction_t *in = &info->ins[i];
+
+    *pops = OP_STACK[in->opcode][0];
+    *pushes = OP_STACK[in->opcode][1];
+    switch (in->opcode) {
+        case DIS_OP_FN_CALL:
+        case DIS_OP_DOT:
+            *pops = stack_call_args(idx, &idx->functions[fn], info, i);
+            // callee and count only
+            if (*pops < 0) {
+                *pops = 2;
+                return false;
+            }
+            if (in->opcode == DIS_OP_FN_CALL)
+                *pushes = stack_call_returns(idx, fn, info, i, *pops);
+            *pops += 2;
+            break;
+        case DIS_OP_INDEX_ASSIGN:
+            *pops = stack_index_assign(info, i);
+            break;
+        case DIS_OP_FN_RETURN:
+            *pops = in->arg[0];
+            break;
+        case DIS_OP_POP_STACK:
+            *pops = info->depth[i];
+            break;
+    }
+
+    return true;
+}
+
+uint8_t dis_stack_analyze(const dis_index_t *idx, uint32_t fn, dis_stack_info_t *info) {
+    const dis_function_t *f = &idx->functions[fn];
+    uint32_t *work, work_len = 0;
+    bool *counted;
+
+    memset(info, 0, sizeof(dis_stack_info_t));
+    if (dis_index_decode_function(idx, fn, &info->ins, &info->count))
+        return 1;
+
+    if (fn != 0) {
+        info->params = stack_list_length(idx, f, f->args) / 2;
+        info->returns = stack_list_length(idx, f, f->rets);
+    }
+
+    info->depth = malloc((info->count ? info->count : 1) * sizeof(int32_t));
+    for (uint32_t i = 0; i < info->count; i++)
+        info->depth[i] = -1;
+
+    // every instruction enters the worklist at most once, its depth is fixed on first visit
+    work = malloc((info->count ? info->count : 1) * sizeof(uint32_t));
+    counted = calloc(info->count ? info->count : 1, sizeof(bool));
+    if (info->count) {
+        info->depth[0] = 0;
+        work[work_len++] = 0;
+    }
+
+    while (work_len) {
+        uint32_t i = work[--work_len], target = info->count;
+        const dis_instruction_t *in = &info->ins[i];
+        int32_t depth = info->depth[i], pops, pushes, after;
+
+        if (in->opcode == DIS_OP_SECTION_END || in->opcode == DIS_OP_EOF)
+            continue;
+
+        if (!dis_stack_effect(idx, fn, info, i, &pops, &pushes) && !counted[i])
+            ++info->unknown_calls;
+        counted[i] = true;
+
+        if (depth < pops) {
+            stack_event(&info->underflows, &info->underflow_count, in->offset - f->code_start, depth, pops);
+            after = pushes;
+        } else
+            after = depth - pops + pushes;
+
+        if (after > info->max_depth)
+            info->max_depth = after;
+        if (depth > info->max_depth)
+            info->max_depth = depth;
+
+        if (idx->ops->args[in->opcode][2])
+            target = dis_index_find_instruction(info->ins, info->count, f->code_start + in->arg[0]);
+
+        switch (in->opcode) {
+            case DIS_OP_JUMP:
+                stack_merge(info, work, &work_len, f->code_start, target, after);
+                break;
+            case DIS_OP_AND:
+            case DIS_OP_OR:
+                stack_merge(info, work, &work_len, f->code_start, target, depth);
+                stack_merge(info, work, &work_len, f->code_start, i + 1, after);
+                break;
+            case DIS_OP_IF_FALSE_JUMP:
+                stack_merge(info, work, &work_len, f->code_start, target, after);
+                stack_merge(info, work, &work_len, f->code_start, i + 1, after);
+                break;
+            case DIS_OP_FN_RETURN:
+                break;
+            default:
+                stack_merge(info, work, &work_len, f->code_start, i + 1, after);
+                break;
+        }
+    }
+
+    free(work);
+    free(counted);
+    return 0;
+}
+
+void dis_stack_info_free(dis_stack_info_t *info) {
+    free(info->ins);
+    free(info->depth);
+    free(info->conflicts);
+    free(info->underflows);
+    memset(info, 0, sizeof(dis_stack_info_t));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void stack_print_events(const dis_stack_event_t *events, uint32_t count, const char *fmt, bool json) {
+    for (uint32_t e = 0; e < count; e++) {
+        if (json)
+            printf("%s{ \"offset\": %u, \"depth\": [%d, %d] }", e ? ", " : "", events[e].offset, events[e].depth[0], events[e].depth[1]);
+        else {
+            printf("    [%05d] ", events[e].offset);
+            printf(fmt, events[e].depth[0], events[e].depth[1]);
+            printf("\n");
+        }
+    }
+}
+
+void dis_stack_report(char **files, uint32_t file_count, bool json) {
+    uint32_t printed = 0;
+
+    if (json)
+        printf("[");
+
+    for (uint32_t n = 0; n < file_count; n++) {
+        uint8_t *program = NULL;
+        uint32_t len = 0;
+        dis_index_t idx;
+
+        if (dis_read_file(files[n], &program, &len) || dis_index_build(program, len, &idx)) {
+            fprintf(stderr, "%s: not able to decode the file\n", files[n]);
+            if (program != NULL)
+                dis_index_free(&idx);
+            free(program);
+            continue;
+        }
+
+        if (json) {
+            printf("%s\n  { \"file\": ", printed++ ? "," : "");
+            str_print_json(files[n]);
+            printf(", \"functions\": [");
+        } else
+            printf("\n.comment stack depth: %s\n", files[n]);
+
+        for (uint32_t i = 0, fn_printed = 0; i < idx.function_count; i++) {
+            dis_stack_info_t info;
+
+            if (dis_stack_analyze(&idx, i, &info)) {
+                fprintf(stderr, "%s: %s: not able to decode the code section\n", files[n], idx.functions[i].path);
+                dis_stack_info_free(&info);
+                continue;
+            }
+
+            if (json) {
+                printf("%s\n    { \"path\": ", fn_printed++ ? "," : "");
+                str_print_json(idx.functions[i].path);
+                printf(", \"max_depth\": %d, \"params\": %u, \"returns\": %u, \"unknown_calls\": %u, \"conflicts\": [", info.max_depth, info.params,
+                        info.returns, info.unknown_calls);
+                stack_print_events(info.conflicts, info.conflict_count, NULL, true);
+                printf("], \"underflows\": [");
+                stack_print_events(info.underflows, info.underflow_count, NULL, true);
+                printf("] }");
+            } else {
+                printf("%s: max depth: %d, params: %u, returns: %u", idx.functions[i].path, info.max_depth, info.params, info.returns);
+                if (info.unknown_calls)
+                    printf(", calls with unknown arity: %u", info.unknown_calls);
+                printf("\n");
+                stack_print_events(info.conflicts, info.conflict_count, "merge conflict: depth %d vs %d", false);
+                stack_print_events(info.underflows, info.underflow_count, "underflow: depth %d, pops %d", false);
+            }
+
+            dis_stack_info_free(&info);
+        }
+
+        if (json)
+            printf("\n  ] }");
+
+        dis_index_free(&idx);
+        free(program);
+    }
+
+    if (json)
+        printf("\n]\n");
+}
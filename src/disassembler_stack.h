@@ -0,0 +1,41 @@
+/*
+ * disassembler_stack.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Static operand stack depth analysis per function.
+ */
+
+#ifndef DISASSEMBLER_STACK_H_
+#define DISASSEMBLER_STACK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "disassembler_index.h"
+
+typedef struct dis_stack_event_s {
+    uint32_t offset;  // relative to the code start
+    int32_t depth[2]; // conflict: recorded/incoming depth, underflow: depth/pops
+} dis_stack_event_t;
+
+typedef struct dis_stack_info_s {
+    dis_instruction_t *ins;        //
+    uint32_t count;                //
+    int32_t *depth;                // depth before each instruction, -1 if never reached
+    int32_t max_depth;             //
+    uint16_t params;               // from the args literal
+    uint16_t returns;              // from the rets literal
+    uint32_t unknown_calls;        // calls whose argument count is not a literal
+    dis_stack_event_t *conflicts;  // merge points reached with different depths
+    uint32_t conflict_count;       //
+    dis_stack_event_t *underflows; //
+    uint32_t underflow_count;      //
+} dis_stack_info_t;
+
+uint8_t dis_stack_analyze(const dis_index_t *idx, uint32_t fn, dis_stack_info_t *info);
+bool dis_stack_effect(const dis_index_t *idx, uint32_t fn, const dis_stack_info_t *info, uint32_t i, int32_t *pops, int32_t *pushes);
+void dis_stack_info_free(dis_stack_info_t *info);
+void dis_stack_report(char **files, uint32_t file_count, bool json);
+
+#endif /* DISASSEMBLER_STACK_H_ */
@@ -0,0 +1,260 @@
+/*
+ * disassembler_string.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Literal strings are mostly plain text, so both the NUL search and the escaping look at
+ * 32 (AVX2, when the CPU has it) or 16 (SSE2) bytes per step and only fall back to single
+ * bytes for the tail and for the bytes that need an escape. Loads never go past the bound.
+ * Other targets, or builds with -DDIS_NO_SIMD, use the scalar loops alone.
+ */
+
+#include <string.h>
+
+#include "disassembler_string.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__) && defined(__GNUC__) && !defined(DIS_NO_SIMD)
+#define DIS_SIMD_X86
+#include <immintrin.h>
+#endif
+
+static const char HEX[] = "0123456789abcdef";
+
+// digit pairs of every byte value, one two byte copy per byte dumped
+static const char HEX_PAIRS[] =
+        "000102030405060708090a0b0c0d0e0f"
+        "101112131415161718191a1b1c1d1e1f"
+        "202122232425262728292a2b2c2d2e2f"
+        "303132333435363738393a3b3c3d3e3f"
+        "404142434445464748494a4b4c4d4e4f"
+        "505152535455565758595a5b5c5d5e5f"
+        "606162636465666768696a6b6c6d6e6f"
+        "707172737475767778797a7b7c7d7e7f"
+        "808182838485868788898a8b8c8d8e8f"
+        "909192939495969798999a9b9c9d9e9f"
+        "a0a1a2a3a4a5a6a7a8a9aaabacadaeaf"
+        "b0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+        "c0c1c2c3c4c5c6c7c8c9cacbcccdcecf"
+        "d0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+        "e0e1e2e3e4e5e6e7e8e9eaebecedeeef"
+        "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+// bytes that can't appear raw in a one line literal
+static inline bool needs_escape(uint8_t c, bool identifier) {
+    return c < 0x20 || c == 0x7f || c == '"' || c == '\\' || (identifier && c == ' ');
+}
+
+#ifdef DIS_SIMD_X86
+
+// the next functions return the offset of the first match, or where the whole blocks ended
+
+__attribute__((target("avx2")))
+static uint32_t avx2_strnlen(const uint8_t *s, uint32_t i, uint32_t max) {
+    const __m256i zero = _mm256_setzero_si256();
+
+    for (; i + 32 <= max; i += 32) {
+        uint32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (s + i)), zero));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+
+    return i;
+}
+
+static uint32_t sse2_strnlen(const uint8_t *s, uint32_t i, uint32_t max) {
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 16 <= max; i += 16) {
+        uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (s + i)), zero));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+
+    return i;
+}
+
+__attribute__((target("avx2")))
+static uint32_t avx2_escape_run(const uint8_t *s, uint32_t i, uint32_t len, bool identifier) {
+    const __m256i ctrl = _mm256_set1_epi8(0x1f), del = _mm256_set1_epi8(0x7f);
+    const __m256i quote = _mm256_set1_epi8('"'), backslash = _mm256_set1_epi8('\\');
+    const __m256i space = _mm256_set1_epi8(identifier ? ' ' : '"');
+
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*) (s + i));
+        __m256i m = _mm256_cmpeq_epi8(_mm256_max_epu8(v, ctrl), ctrl);
+
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, del));
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, quote));
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, backslash));
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, space));
+
+        uint32_t mask = _mm256_movemask_epi8(m);
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+
+    return i;
+}
+
+static uint32_t sse2_escape_run(const uint8_t *s, uint32_t i, uint32_t len, bool identifier) {
+    const __m128i ctrl = _mm_set1_epi8(0x1f), del = _mm_set1_epi8(0x7f);
+    const __m128i quote = _mm_set1_epi8('"'), backslash = _mm_set1_epi8('\\');
+    const __m128i space = _mm_set1_epi8(identifier ? ' ' : '"');
+
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*) (s + i));
+        __m128i m = _mm_cmpeq_epi8(_mm_max_epu8(v, ctrl), ctrl); // v <= 0x1f, unsigned
+
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, del));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, quote));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, backslash));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, space));
+
+        uint32_t mask = _mm_movemask_epi8(m);
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+
+    return i;
+}
+
+#endif
+
+uint32_t dis_strnlen(const uint8_t *s, uint32_t max) {
+    uint32_t i = 0;
+
+#ifdef DIS_SIMD_X86
+    if (max >= 32 && __builtin_cpu_supports("avx2"))
+        i = avx2_strnlen(s, i, max);
+    i = sse2_strnlen(s, i, max);
+#endif
+
+    while (i < max && s[i])
+        ++i;
+
+    return i;
+}
+
+// offset of the first byte from i on that needs an escape, len if none
+static uint32_t escape_run(const uint8_t *s, uint32_t i, uint32_t len, bool identifier) {
+#ifdef DIS_SIMD_X86
+    if (len - i >= 32 && __builtin_cpu_supports("avx2"))
+        i = avx2_escape_run(s, i, len, identifier);
+    i = sse2_escape_run(s, i, len, identifier);
+#endif
+
+    while (i < len && !needs_escape(s[i], identifier))
+        ++i;
+
+    return i;
+}
+
+uint32_t dis_escape(const uint8_t *s, uint32_t len, char *dst, bool identifier) {
+    uint32_t i = 0, n = 0;
+
+    for (;;) {
+        uint32_t run = escape_run(s, i, len, identifier);
+
+        memcpy(dst + n, s + i, run - i);
+        n += run - i;
+        if (run == len)
+            break;
+
+        dst[n++] = '\\';
+        switch (s[run]) {
+            case '"':
+            case '\\':
+                dst[n++] = s[run];
+                break;
+            case '\n':
+                dst[n++] = 'n';
+                break;
+            case '\r':
+                dst[n++] = 'r';
+                break;
+            case '\t':
+                dst[n++] = 't';
+                break;
+            default:
+                dst[n++] = 'x';
+                dst[n++] = HEX[s[run] >> 4];
+                dst[n++] = HEX[s[run] & 15];
+        }
+
+        i = run + 1;
+    }
+
+    dst[n] = '\0';
+    return n;
+}
+
+static int8_t hex_digit(char c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+// dst may be s, the result is never longer than its source
+uint8_t dis_unescape(const char *s, char stop, char *dst, uint32_t *len, const char **end) {
+    uint32_t n = 0;
+
+    while (*s && *s != stop) {
+        if (*s != '\\') {
+            dst[n++] = *s++;
+            continue;
+        }
+
+        switch (*++s) {
+            case '"':
+            case '\\':
+                dst[n++] = *s;
+                break;
+            case 'n':
+                dst[n++] = '\n';
+                break;
+            case 'r':
+                dst[n++] = '\r';
+                break;
+            case 't':
+                dst[n++] = '\t';
+                break;
+            case 'x': {
+                int8_t hi = hex_digit(s[1]), lo = hi < 0 ? -1 : hex_digit(s[2]);
+
+                // a NUL would end the string in the bytecode
+                if (lo < 0 || (hi == 0 && lo == 0))
+                    return 1;
+                dst[n++] = hi << 4 | lo;
+                s += 2;
+            }
+                break;
+            default:
+                return 1;
+        }
+        ++s;
+    }
+
+    if (stop && *s != stop)
+        return 1;
+
+    *len = n;
+    if (end != NULL)
+        *end = s;
+    return 0;
+}
+
+uint32_t dis_hex(const uint8_t *s, uint32_t len, char *dst) {
+    char *d = dst;
+
+    for (uint32_t i = 0; i < len; i++, d += 3) {
+        memcpy(d, HEX_PAIRS + 2 * s[i], 2);
+        d[2] = ' ';
+    }
+
+    *d = '\0';
+    return d - dst;
+}
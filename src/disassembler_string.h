@@ -0,0 +1,35 @@
+/*
+ * disassembler_string.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Bounded scanning and escaping of the NUL terminated strings stored in bytecode, and hex
+ * dumps of raw bytecode.
+ */
+
+#ifndef DISASSEMBLER_STRING_H_
+#define DISASSEMBLER_STRING_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// worst case dis_escape output for len bytes, NUL included
+#define DIS_ESCAPE_MAX(len) (4 * (size_t) (len) + 1)
+
+// dis_hex output for len bytes, NUL included
+#define DIS_HEX_MAX(len) (3 * (size_t) (len) + 1)
+
+// offset of the first NUL in s[0, max), max if there is none
+uint32_t dis_strnlen(const uint8_t *s, uint32_t max);
+
+// s[0, len) with \" \\ \n \r \t and \xHH escapes (spaces too for identifiers), returns the length written
+uint32_t dis_escape(const uint8_t *s, uint32_t len, char *dst, bool identifier);
+
+// reverses dis_escape up to stop (unescaped) or the end of s, 1 on a bad escape or a missing stop
+uint8_t dis_unescape(const char *s, char stop, char *dst, uint32_t *len, const char **end);
+
+// s[0, len) as "xx " per byte, returns the length written
+uint32_t dis_hex(const uint8_t *s, uint32_t len, char *dst);
+
+#endif /* DISASSEMBLER_STRING_H_ */
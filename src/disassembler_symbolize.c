@@ -0,0 +1,241 @@
+/*
+ * disassembler_symbolize.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * The whole file is cut into one sorted array of intervals: every instruction and literal
+ * gets its own, and the bookkeeping bytes between them are covered by region entries. Since
+ * nested function bodies sit inside the function section of their parent, the parent region
+ * is started again after each child. A lookup is then a single binary search.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "disassembler_utils.h"
+#include "disassembler_index.h"
+#include "disassembler_symbolize.h"
+
+static void sym_add(dis_symbolizer_t *sym, uint32_t offset, uint32_t fn, uint8_t kind, uint32_t index) {
+    dis_symbol_t *s;
+
+    if (sym->count == sym->capacity) {
+        sym->capacity = sym->capacity ? sym->capacity * 2 : 256;
+        sym->symbols = realloc(sym->symbols, sym->capacity * sizeof(dis_symbol_t));
+    }
+
+    s = &sym->symbols[sym->count++];
+    s->offset = offset;
+    s->fn = fn;
+    s->index = index;
+    s->kind = kind;
+    s->opcode = 0;
+    s->size = 0;
+}
+
+static int sym_cmp(const void *a, const void *b) {
+    const dis_symbol_t *x = a, *y = b;
+
+    if (x->offset != y->offset)
+        return x->offset < y->offset ? -1 : 1;
+
+    // an empty region gives way to what starts at the same byte
+    return (int) x->kind - (int) y->kind;
+}
+
+uint8_t dis_symbolizer_build(const dis_index_t *idx, dis_symbolizer_t *sym) {
+    memset(sym, 0, sizeof(dis_symbolizer_t));
+    sym_add(sym, 0, 0, DIS_SYMBOL_HEADER, 0);
+
+    for (uint32_t fn = 0; fn < idx->function_count; fn++) {
+        const dis_function_t *f = &idx->functions[fn];
+        dis_instruction_t *ins = NULL;
+        uint32_t count = 0;
+
+        sym_add(sym, f->start, fn, DIS_SYMBOL_LITERALS, 0);
+        for (uint32_t l = 0; l < f->literal_count; l++)
+            sym_add(sym, f->literals[l].offset, fn, DIS_SYMBOL_LITERAL, l);
+        sym_add(sym, f->lit_end - 1, fn, DIS_SYMBOL_LITERALS, 0);
+        sym_add(sym, f->lit_end, fn, DIS_SYMBOL_FUNCTIONS, 0);
+
+        if (f->parent >= 0) {
+            sym_add(sym, f->end, f->parent, DIS_SYMBOL_FUNCTIONS, 0);
+            sym_add(sym, f->fn_end, fn, DIS_SYMBOL_SIGNATURE, 0);
+            sym_add(sym, f->code_end, fn, DIS_SYMBOL_FN_END, 0);
+        }
+
+        if (dis_index_decode_function(idx, fn, &ins, &count)) {
+            free(ins);
+            dis_symbolizer_free(sym);
+            return 1;
+        }
+
+        for (uint32_t i = 0; i < count; i++) {
+            sym_add(sym, ins[i].offset, fn, DIS_SYMBOL_CODE, i);
+            sym->symbols[sym->count - 1].opcode = ins[i].opcode;
+            sym->symbols[sym->count - 1].size = ins[i].size;
+        }
+        free(ins);
+    }
+
+    sym_add(sym, idx->len, 0, DIS_SYMBOL_NONE, 0);
+    qsort(sym->symbols, sym->count, sizeof(dis_symbol_t), sym_cmp);
+
+    // keep the last of the entries starting at the same byte
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < sym->count; i++) {
+        if (kept && sym->symbols[kept - 1].offset == sym->symbols[i].offset)
+            --kept;
+        sym->symbols[kept++] = sym->symbols[i];
+    }
+    sym->count = kept;
+
+    return 0;
+}
+
+void dis_symbolizer_free(dis_symbolizer_t *sym) {
+    free(sym->symbols);
+    memset(sym, 0, sizeof(dis_symbolizer_t));
+}
+
+// last symbol starting at or before offset
+const dis_symbol_t* dis_symbolize(const dis_symbolizer_t *sym, uint32_t offset) {
+    uint32_t lo = 0, hi = sym->count;
+
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (sym->symbols[mid].offset <= offset)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo ? &sym->symbols[lo - 1] : NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static int sym_cmp_path(const void *a, const void *b) {
+    return strcmp((*(const dis_function_t* const*) a)->path, (*(const dis_function_t* const*) b)->path);
+}
+
+static void sym_print(const dis_index_t *idx, const dis_symbol_t *s, uint32_t offset) {
+    const dis_function_t *f = &idx->functions[s->fn];
+
+    printf("%u ", offset);
+
+    switch (s->kind) {
+        case DIS_SYMBOL_HEADER:
+            printf("header\n");
+            break;
+        case DIS_SYMBOL_LITERALS:
+            printf("%s .literals\n", f->path);
+            break;
+        case DIS_SYMBOL_LITERAL:
+            printf("%s .lit [%05d] %s\n", f->path, s->index, LIT_STR[f->literals[s->index].type] + 12);
+            break;
+        case DIS_SYMBOL_FUNCTIONS:
+            printf("%s .functions\n", f->path);
+            break;
+        case DIS_SYMBOL_SIGNATURE:
+            printf("%s .signature\n", f->path);
+            break;
+        case DIS_SYMBOL_CODE:
+            printf("%s [%05d]", f->path, s->offset - f->code_start);
+            if (offset != s->offset)
+                printf("+%u", offset - s->offset);
+            if (s->opcode == DIS_OP_SECTION_END)
+                printf(" SECTION_END\n");
+            else if (s->opcode < DIS_OP_END_OPCODES)
+                printf(" %s\n", OP_STR[s->opcode] + 7);
+            else
+                printf(" (OP UNKNOWN %u)\n", s->opcode);
+            break;
+        case DIS_SYMBOL_FN_END:
+            printf("%s FN_END\n", f->path);
+            break;
+        default:
+            printf("?\n");
+            break;
+    }
+}
+
+// offsets: one per line, absolute (decimal or 0x hex) or PATH:OFFSET relative to the code start
+uint8_t dis_symbolize_file(const char *filename, const char *offsets) {
+    uint8_t *program = NULL;
+    uint32_t len = 0;
+    dis_index_t idx;
+    dis_symbolizer_t sym;
+    const dis_function_t **sorted;
+    FILE *in;
+    char line[DIS_PATH_MAX + 32];
+
+    if (dis_read_file(filename, &program, &len) || dis_index_build(program, len, &idx)) {
+        fprintf(stderr, "%s: not able to decode the file\n", filename);
+        if (program != NULL)
+            dis_index_free(&idx);
+        free(program);
+        return 1;
+    }
+
+    if (dis_symbolizer_build(&idx, &sym)) {
+        fprintf(stderr, "%s: not able to decode the code sections\n", filename);
+        dis_index_free(&idx);
+        free(program);
+        return 1;
+    }
+
+    in = strcmp(offsets, "-") ? fopen(offsets, "r") : stdin;
+    if (in == NULL) {
+        fprintf(stderr, "%s: not able to open the file\n", offsets);
+        dis_symbolizer_free(&sym);
+        dis_index_free(&idx);
+        free(program);
+        return 1;
+    }
+
+    sorted = malloc(idx.function_count * sizeof(dis_function_t*));
+    for (uint32_t i = 0; i < idx.function_count; i++)
+        sorted[i] = &idx.functions[i];
+    qsort(sorted, idx.function_count, sizeof(dis_function_t*), sym_cmp_path);
+
+    while (fgets(line, sizeof(line), in) != NULL) {
+        char *colon = strchr(line, ':'), *end;
+        uint32_t base = 0;
+        unsigned long offset;
+
+        if (colon != NULL) {
+            dis_function_t key;
+            const dis_function_t *pkey = &key, **found;
+
+            *colon = '\0';
+            snprintf(key.path, DIS_PATH_MAX, "%.*s", DIS_PATH_MAX - 1, line);
+            found = bsearch(&pkey, sorted, idx.function_count, sizeof(dis_function_t*), sym_cmp_path);
+            if (found == NULL) {
+                printf("%s: unknown function\n", line);
+                continue;
+            }
+            base = (*found)->code_start;
+        }
+
+        offset = strtoul(colon != NULL ? colon + 1 : line, &end, 0);
+        if (end == (colon != NULL ? colon + 1 : line))
+            continue;
+
+        if (base + offset >= len) {
+            printf("%lu ?\n", base + offset);
+            continue;
+        }
+
+        sym_print(&idx, dis_symbolize(&sym, base + offset), base + offset);
+    }
+
+    if (in != stdin)
+        fclose(in);
+    free(sorted);
+    dis_symbolizer_free(&sym);
+    dis_index_free(&idx);
+    free(program);
+    return 0;
+}
@@ -0,0 +1,47 @@
+/*
+ * disassembler_symbolize.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Maps absolute byte offsets of a bytecode file to function, instruction and region.
+ */
+
+#ifndef DISASSEMBLER_SYMBOLIZE_H_
+#define DISASSEMBLER_SYMBOLIZE_H_
+
+#include <stdint.h>
+
+#include "disassembler_index.h"
+
+typedef enum DIS_SYMBOL_KIND {
+    DIS_SYMBOL_HEADER,    // version bytes and build string
+    DIS_SYMBOL_LITERALS,  // literal count word and the section end
+    DIS_SYMBOL_LITERAL,   // index: literal
+    DIS_SYMBOL_FUNCTIONS, // function count/size words and the size word of every body
+    DIS_SYMBOL_SIGNATURE, // args/rets words
+    DIS_SYMBOL_CODE,      // index: instruction
+    DIS_SYMBOL_FN_END,    //
+    DIS_SYMBOL_NONE,      // past the end of the file
+} dis_symbol_kind_t;
+
+typedef struct dis_symbol_s {
+    uint32_t offset; // first byte covered
+    uint32_t fn;     // function index
+    uint32_t index;  // literal or instruction, by kind
+    uint8_t kind;    //
+    uint8_t opcode;  // DIS_SYMBOL_CODE only
+    uint8_t size;    // instruction size, DIS_SYMBOL_CODE only
+} dis_symbol_t;
+
+typedef struct dis_symbolizer_s {
+    dis_symbol_t *symbols; // sorted by offset, each covers up to the next one
+    uint32_t count;        //
+    uint32_t capacity;     //
+} dis_symbolizer_t;
+
+uint8_t dis_symbolizer_build(const dis_index_t *idx, dis_symbolizer_t *sym);
+void dis_symbolizer_free(dis_symbolizer_t *sym);
+const dis_symbol_t* dis_symbolize(const dis_symbolizer_t *sym, uint32_t offset);
+uint8_t dis_symbolize_file(const char *filename, const char *offsets);
+
+#endif /* DISASSEMBLER_SYMBOLIZE_H_ */
@@ -0,0 +1,756 @@
+/*
+ * disassembler_types.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Abstract interpretation over the basic blocks of a function. A value is the set of
+ * literal types it may have; identifiers pushed by LITERAL are resolved when an opcode uses
+ * them, from the local variable state (VAR_DECL and parameters, a concrete declared type is
+ * enforced by the VM so it wins over the assigned value) or else from the declarations of
+ * the enclosing functions. Sets only grow when states are joined at jump targets, so the
+ * worklist ends. Calls, indexing and unknown names give any.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "disassembler_utils.h"
+#include "disassembler_index.h"
+#include "disassembler_stack.h"
+#include "disassembler_types.h"
+
+#define TYPES_BIT(t)      ((uint16_t) (1u << (t)))
+#define TYPES_ANY         ((uint16_t) (0x7ff & ~TYPES_BIT(DIS_LITERAL_IDENTIFIER))) // NULL to OPAQUE
+#define TYPES_NO_SLOT     -1 // not a local variable
+#define TYPES_MIXED_SLOT  -2 // different variables joined
+
+typedef enum TYPES_KIND {
+    TYPES_STATIC,      // one type per operand, the operation is valid
+    TYPES_POLYMORPHIC, // checked at run time
+    TYPES_ERROR,       // one type per operand and the VM rejects the operation
+} types_kind_t;
+
+static const char *KIND_NAMES[] = { "static", "polymorphic", "error" };
+
+typedef struct types_value_s {
+    uint16_t mask; // possible DIS_LITERAL_* types
+    int32_t slot;  // local variable named by an identifier, resolved when used
+    int32_t type;  // TYPE literal index, for cast targets, -1 otherwise
+} types_value_t;
+
+typedef struct types_site_s {
+    uint32_t offset;     // relative to the code start
+    uint8_t opcode;      //
+    uint8_t kind;        //
+    bool redundant;      // cast to the only type the value can have
+    uint16_t operand[2]; // left and right, value and target for casts
+} types_site_t;
+
+typedef struct types_decl_s {
+    const char *name; //
+    uint16_t mask;    //
+} types_decl_t;
+
+typedef struct types_scope_s {
+    types_decl_t *decls; // VAR_DECL, FN_DECL and parameters of a function
+    uint32_t count;      //
+} types_scope_t;
+
+typedef struct types_fn_s {
+    const dis_index_t *idx;
+    const dis_function_t *f;
+    uint32_t fn;
+    dis_stack_info_t info;
+    uint32_t slot_count;      //
+    const char **slot_names;  //
+    uint16_t *declared;       // concrete declared type per slot, 0 for any
+    int32_t *lit_slot;        // per literal, slot of an identifier
+    uint16_t *lit_mask;       // per literal, value pushed by LITERAL
+    int32_t *block;           // block of each leader instruction, -1 for the rest
+    uint32_t *leaders;        //
+    uint32_t block_count;     //
+    uint32_t *stack_base;     // first stack entry of each block state
+    types_value_t *stack;     //
+    uint16_t *env;            // block_count * slot_count
+    bool *reached;            //
+    types_site_t *sites;      //
+    uint32_t site_count;      //
+} types_fn_t;
+
+static const char* types_literal_name(const dis_index_t *idx, const dis_function_t *f, uint32_t literal) {
+    if (literal >= f->literal_count || f->literals[literal].type != DIS_LITERAL_IDENTIFIER)
+        return NULL;
+    return (const char*) idx->program + f->literals[literal].offset + 1;
+}
+
+// mask of a TYPE literal, concrete is false for any and unknown kinds
+static uint16_t types_declared(const dis_index_t *idx, const dis_function_t *f, uint32_t literal, bool *concrete) {
+    uint8_t kind;
+
+    *concrete = false;
+    if (literal >= f->literal_count || (f->literals[literal].type != DIS_LITERAL_TYPE && f->literals[literal].type != DIS_LITERAL_TYPE_INTERMEDIATE))
+        return TYPES_ANY;
+
+    kind = idx->program[f->literals[literal].offset + 1];
+    if (kind > DIS_LITERAL_OPAQUE || kind == DIS_LITERAL_IDENTIFIER)
+        return TYPES_ANY;
+
+    *concrete = true;
+    return TYPES_BIT(kind);
+}
+
+static uint16_t types_literal(const dis_function_t *f, uint32_t literal) {
+    if (literal >= f->literal_count)
+        return TYPES_ANY;
+
+    switch (f->literals[literal].type) {
+        case DIS_LITERAL_ARRAY_INTERMEDIATE:
+            return TYPES_BIT(DIS_LITERAL_ARRAY);
+        case DIS_LITERAL_DICTIONARY_INTERMEDIATE:
+            return TYPES_BIT(DIS_LITERAL_DICTIONARY);
+        case DIS_LITERAL_TYPE_INTERMEDIATE:
+            return TYPES_BIT(DIS_LITERAL_TYPE);
+        case DIS_LITERAL_INDEX_BLANK:
+            return TYPES_BIT(DIS_LITERAL_NULL);
+        case DIS_LITERAL_IDENTIFIER:
+            return TYPES_ANY;
+        default:
+            return f->literals[literal].type <= DIS_LITERAL_OPAQUE ? TYPES_BIT(f->literals[literal].type) : TYPES_ANY;
+    }
+}
+
+static void types_mask_str(uint16_t mask, char *s, uint32_t size) {
+    uint32_t n = 0;
+
+    if (!mask || (mask & TYPES_ANY) == TYPES_ANY) {
+        snprintf(s, size, "any");
+        return;
+    }
+
+    s[0] = '\0';
+    for (uint32_t t = 0; t <= DIS_LITERAL_OPAQUE; t++)
+        if (mask & TYPES_BIT(t))
+            n += snprintf(s + n, n < size ? size - n : 0, "%s%s", n ? "|" : "", LIT_STR[t] + 12);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// declarations of every function, looked up by nested functions for non-local names
+static types_scope_t* types_scopes(const dis_index_t *idx) {
+    types_scope_t *scopes = calloc(idx->function_count ? idx->function_count : 1, sizeof(types_scope_t));
+
+    for (uint32_t fn = 0; fn < idx->function_count; fn++) {
+        const dis_function_t *f = &idx->functions[fn];
+        types_scope_t *s = &scopes[fn];
+        dis_instruction_t *ins;
+        uint32_t count, capacity;
+        uint16_t length = 0;
+        bool concrete;
+
+        if (fn != 0 && f->args < f->literal_count && f->literals[f->args].type == DIS_LITERAL_ARRAY)
+            memcpy(&length, idx->program + f->literals[f->args].offset + 1, 2);
+
+        dis_index_decode_function(idx, fn, &ins, &count);
+        capacity = count + length / 2 + 1;
+        s->decls = malloc(capacity * sizeof(types_decl_t));
+
+        for (uint16_t a = 0; a + 1 < length; a += 2) {
+            uint16_t name, type;
+
+            memcpy(&name, idx->program + f->literals[f->args].offset + 3 + 2 * a, 2);
+            memcpy(&type, idx->program + f->literals[f->args].offset + 5 + 2 * a, 2);
+            if (types_literal_name(idx, f, name) == NULL)
+                continue;
+            s->decls[s->count].name = types_literal_name(idx, f, name);
+            s->decls[s->count++].mask = type < f->literal_count && f->literals[type].type == DIS_LITERAL_FUNCTION_ARG_REST ?
+                    TYPES_BIT(DIS_LITERAL_ARRAY) : types_declared(idx, f, type, &concrete);
+        }
+
+        for (uint32_t i = 0; i < count; i++) {
+            const char *name = types_literal_name(idx, f, ins[i].arg[0]);
+
+            if (name == NULL)
+                continue;
+            if (ins[i].opcode == DIS_OP_VAR_DECL || ins[i].opcode == DIS_OP_VAR_DECL_LONG) {
+                s->decls[s->count].name = name;
+                s->decls[s->count++].mask = types_declared(idx, f, ins[i].arg[1], &concrete);
+            } else if (ins[i].opcode == DIS_OP_FN_DECL || ins[i].opcode == DIS_OP_FN_DECL_LONG) {
+                s->decls[s->count].name = name;
+                s->decls[s->count++].mask = TYPES_BIT(DIS_LITERAL_FUNCTION);
+            }
+        }
+
+        free(ins);
+    }
+
+    return scopes;
+}
+
+static void types_scopes_free(types_scope_t *scopes, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++)
+        free(scopes[i].decls);
+    free(scopes);
+}
+
+// nearest declaration from fn outwards, natives and globals of other files are any
+static uint16_t types_lookup(const dis_index_t *idx, const types_scope_t *scopes, uint32_t fn, const char *name) {
+    for (int32_t g = fn; g >= 0; g = idx->functions[g].parent)
+        for (uint32_t d = 0; d < scopes[g].count; d++)
+            if (!strcmp(scopes[g].decls[d].name, name))
+                return scopes[g].decls[d].mask;
+
+    return TYPES_ANY;
+}
+
+static int32_t types_slot(types_fn_t *t, const char *name, bool add) {
+    for (uint32_t s = 0; s < t->slot_count; s++)
+        if (!strcmp(t->slot_names[s], name))
+            return s;
+
+    if (!add)
+        return TYPES_NO_SLOT;
+
+    t->slot_names[t->slot_count] = name;
+    t->declared[t->slot_count] = 0;
+    return t->slot_count++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// result of op on one pair of operand types, 0 when the VM rejects it
+static uint16_t types_pair(uint8_t opcode, uint8_t a, uint8_t b) {
+    bool numbers = (a == DIS_LITERAL_INTEGER || a == DIS_LITERAL_FLOAT) && (b == DIS_LITERAL_INTEGER || b == DIS_LITERAL_FLOAT);
+
+    if (opcode == DIS_OP_ADDITION && a == DIS_LITERAL_STRING && b == DIS_LITERAL_STRING)
+        return TYPES_BIT(DIS_LITERAL_STRING);
+    if (!numbers)
+        return 0;
+
+    return a == DIS_LITERAL_FLOAT || b == DIS_LITERAL_FLOAT ? TYPES_BIT(DIS_LITERAL_FLOAT) : TYPES_BIT(DIS_LITERAL_INTEGER);
+}
+
+// b is ignored by NEGATE
+static uint8_t types_arith(uint8_t opcode, uint16_t a, uint16_t b, uint16_t *result) {
+    bool single = !(a & (a - 1)) && (opcode == DIS_OP_NEGATE || !(b & (b - 1)));
+
+    *result = 0;
+    for (uint8_t x = 0; x <= DIS_LITERAL_OPAQUE; x++) {
+        if (!(a & TYPES_BIT(x)))
+            continue;
+        if (opcode == DIS_OP_NEGATE) {
+            *result |= x == DIS_LITERAL_INTEGER || x == DIS_LITERAL_FLOAT ? TYPES_BIT(x) : 0;
+            continue;
+        }
+        for (uint8_t y = 0; y <= DIS_LITERAL_OPAQUE; y++)
+            if (b & TYPES_BIT(y))
+                *result |= types_pair(opcode, x, y);
+    }
+
+    if (single && *result)
+        return TYPES_STATIC;
+    if (!*result)
+        *result = TYPES_ANY;
+    return single ? TYPES_ERROR : TYPES_POLYMORPHIC;
+}
+
+static types_value_t types_pop(types_value_t *stack, int32_t *depth) {
+    types_value_t any = { TYPES_ANY, TYPES_NO_SLOT, -1 };
+
+    return *depth > 0 ? stack[--*depth] : any;
+}
+
+static void types_push(types_value_t *stack, int32_t *depth, int32_t capacity, uint16_t mask) {
+    types_value_t v = { mask, TYPES_NO_SLOT, -1 };
+
+    if (*depth < capacity)
+        stack[(*depth)++] = v;
+}
+
+// identifiers are read when an opcode uses them
+static uint16_t types_value(types_value_t v, const uint16_t *env) {
+    if (v.slot >= 0)
+        return env[v.slot] ? env[v.slot] : TYPES_ANY;
+    if (v.slot == TYPES_MIXED_SLOT || !v.mask)
+        return TYPES_ANY;
+    return v.mask;
+}
+
+static void types_assign(const types_fn_t *t, int32_t slot, uint16_t value, uint16_t *env) {
+    if (slot >= 0)
+        env[slot] = t->declared[slot] ? t->declared[slot] : value;
+}
+
+// applies instruction i to a state, fills site for arithmetic and casts
+static bool types_step(const types_fn_t *t, uint32_t i, types_value_t *stack, int32_t *depth, int32_t capacity, uint16_t *env, types_site_t *site) {
+    const dis_instruction_t *in = &t->info.ins[i];
+    types_value_t a, b;
+    uint16_t result;
+    int32_t pops, pushes;
+    bool concrete;
+
+    memset(site, 0, sizeof(types_site_t));
+    site->offset = in->offset - t->f->code_start;
+    site->opcode = in->opcode;
+
+    switch (in->opcode) {
+        case DIS_OP_LITERAL:
+        case DIS_OP_LITERAL_LONG:
+            if (*depth < capacity) {
+                a.mask = in->arg[0] < t->f->literal_count ? t->lit_mask[in->arg[0]] : TYPES_ANY;
+                a.slot = in->arg[0] < t->f->literal_count ? t->lit_slot[in->arg[0]] : TYPES_NO_SLOT;
+                a.type = in->arg[0] < t->f->literal_count && (t->f->literals[in->arg[0]].type == DIS_LITERAL_TYPE
+                        || t->f->literals[in->arg[0]].type == DIS_LITERAL_TYPE_INTERMEDIATE) ? (int32_t) in->arg[0] : -1;
+                stack[(*depth)++] = a;
+            }
+            return false;
+
+        case DIS_OP_LITERAL_RAW:
+            a = types_pop(stack, depth);
+            types_push(stack, depth, capacity, types_value(a, env));
+            return false;
+
+        case DIS_OP_NEGATE:
+            site->operand[0] = types_value(types_pop(stack, depth), env);
+            site->kind = types_arith(in->opcode, site->operand[0], 0, &result);
+            types_push(stack, depth, capacity, result);
+            return true;
+
+        case DIS_OP_ADDITION:
+        case DIS_OP_SUBTRACTION:
+        case DIS_OP_MULTIPLICATION:
+        case DIS_OP_DIVISION:
+        case DIS_OP_MODULO:
+            site->operand[1] = types_value(types_pop(stack, depth), env);
+            site->operand[0] = types_value(types_pop(stack, depth), env);
+            site->kind = types_arith(in->opcode, site->operand[0], site->operand[1], &result);
+            types_push(stack, depth, capacity, result);
+            return true;
+
+        case DIS_OP_VAR_ADDITION_ASSIGN:
+        case DIS_OP_VAR_SUBTRACTION_ASSIGN:
+        case DIS_OP_VAR_MULTIPLICATION_ASSIGN:
+        case DIS_OP_VAR_DIVISION_ASSIGN:
+        case DIS_OP_VAR_MODULO_ASSIGN:
+            b = types_pop(stack, depth);
+            a = types_pop(stack, depth);
+            site->operand[0] = types_value(a, env);
+            site->operand[1] = types_value(b, env);
+            site->kind = types_arith(in->opcode - DIS_OP_VAR_ADDITION_ASSIGN + DIS_OP_ADDITION, site->operand[0], site->operand[1], &result);
+            types_assign(t, a.slot, result, env);
+            return true;
+
+        case DIS_OP_VAR_ASSIGN:
+            b = types_pop(stack, depth);
+            a = types_pop(stack, depth);
+            types_assign(t, a.slot, types_value(b, env), env);
+            return false;
+
+        case DIS_OP_VAR_DECL:
+        case DIS_OP_VAR_DECL_LONG:
+            a = types_pop(stack, depth);
+            if (in->arg[0] < t->f->literal_count)
+                types_assign(t, t->lit_slot[in->arg[0]], types_value(a, env), env);
+            return false;
+
+        case DIS_OP_TYPE_CAST:
+            b = types_pop(stack, depth);
+            a = types_pop(stack, depth);
+            site->operand[0] = types_value(b, env);
+            site->operand[1] = a.type >= 0 ? types_declared(t->idx, t->f, a.type, &concrete) : TYPES_ANY;
+            site->kind = !(site->operand[0] & (site->operand[0] - 1)) && !(site->operand[1] & (site->operand[1] - 1)) ? TYPES_STATIC : TYPES_POLYMORPHIC;
+            site->redundant = site->kind == TYPES_STATIC && site->operand[0] == site->operand[1];
+            types_push(stack, depth, capacity, site->operand[1]);
+            return true;
+
+        case DIS_OP_TYPE_OF:
+            types_pop(stack, depth);
+            types_push(stack, depth, capacity, TYPES_BIT(DIS_LITERAL_TYPE));
+            return false;
+
+        case DIS_OP_COMPARE_EQUAL:
+        case DIS_OP_COMPARE_NOT_EQUAL:
+        case DIS_OP_COMPARE_LESS:
+        case DIS_OP_COMPARE_LESS_EQUAL:
+        case DIS_OP_COMPARE_GREATER:
+        case DIS_OP_COMPARE_GREATER_EQUAL:
+            types_pop(stack, depth);
+            // fall through
+        case DIS_OP_INVERT:
+            types_pop(stack, depth);
+            types_push(stack, depth, capacity, TYPES_BIT(DIS_LITERAL_BOOLEAN));
+            return false;
+
+        case DIS_OP_INDEX:
+            for (uint32_t p = 0; p < 3; p++)
+                types_pop(stack, depth);
+            a = types_pop(stack, depth);
+            types_push(stack, depth, capacity, types_value(a, env) == TYPES_BIT(DIS_LITERAL_STRING) ? TYPES_BIT(DIS_LITERAL_STRING) : TYPES_ANY);
+            return false;
+
+        case DIS_OP_TERNARY:
+            b = types_pop(stack, depth);
+            a = types_pop(stack, depth);
+            types_pop(stack, depth);
+            types_push(stack, depth, capacity, types_value(a, env) | types_value(b, env));
+            return false;
+
+        default:
+            break;
+    }
+
+    // the element of an indexed compound assignment is never known
+    bool arith = in->opcode == DIS_OP_INDEX_ASSIGN && in->arg[0] >= DIS_OP_VAR_ADDITION_ASSIGN && in->arg[0] <= DIS_OP_VAR_MODULO_ASSIGN;
+    if (arith) {
+        site->opcode = in->arg[0];
+        site->operand[0] = TYPES_ANY;
+        site->operand[1] = *depth > 0 ? types_value(stack[*depth - 1], env) : TYPES_ANY;
+        site->kind = TYPES_POLYMORPHIC;
+    }
+
+    dis_stack_effect(t->idx, t->fn, &t->info, i, &pops, &pushes);
+    if (in->opcode == DIS_OP_POP_STACK)
+        pops = *depth;
+    *depth = pops > *depth ? 0 : *depth - pops;
+    for (int32_t p = 0; p < pushes; p++)
+        types_push(stack, depth, capacity, TYPES_ANY);
+
+    return arith;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static bool types_merge_value(types_value_t *dst, const types_value_t *src) {
+    types_value_t old = *dst;
+
+    dst->mask |= src->mask;
+    if (dst->slot != src->slot)
+        dst->slot = TYPES_MIXED_SLOT;
+    if (dst->type != src->type)
+        dst->type = -1;
+
+    return memcmp(&old, dst, sizeof(types_value_t)) != 0;
+}
+
+// joins a state into the block starting at instruction target
+static void types_merge(types_fn_t *t, uint32_t target, const types_value_t *stack, int32_t depth, const uint16_t *env, uint32_t *work, uint32_t *work_len,
+        bool *in_work) {
+    types_value_t any = { TYPES_ANY, TYPES_NO_SLOT, -1 };
+    bool changed = false;
+    int32_t want, b;
+
+    if (target >= t->info.count || (b = t->block[target]) < 0 || (want = t->info.depth[target]) < 0)
+        return;
+
+    types_value_t *dst = t->stack + t->stack_base[b];
+    uint16_t *dst_env = t->env + b * t->slot_count;
+
+    if (!t->reached[b]) {
+        for (int32_t k = 0; k < want; k++)
+            dst[k] = k < depth ? stack[k] : any;
+        memcpy(dst_env, env, t->slot_count * sizeof(uint16_t));
+        t->reached[b] = changed = true;
+    } else {
+        for (int32_t k = 0; k < want && k < depth; k++)
+            changed |= types_merge_value(&dst[k], &stack[k]);
+        for (uint32_t s = 0; s < t->slot_count; s++) {
+            changed |= (dst_env[s] | env[s]) != dst_env[s];
+            dst_env[s] |= env[s];
+        }
+    }
+
+    if (changed && !in_work[b]) {
+        in_work[b] = true;
+        work[(*work_len)++] = b;
+    }
+}
+
+// walks block b from its state, to the next leader or the end of its path, recording sites when asked
+static void types_walk(types_fn_t *t, uint32_t b, types_value_t *stack, uint16_t *env, int32_t capacity, uint32_t *work, uint32_t *work_len, bool *in_work,
+        bool record) {
+    uint32_t leader = t->leaders[b];
+    int32_t depth = t->info.depth[leader];
+    types_site_t site;
+
+    memcpy(stack, t->stack + t->stack_base[b], depth * sizeof(types_value_t));
+    memcpy(env, t->env + b * t->slot_count, t->slot_count * sizeof(uint16_t));
+
+    for (uint32_t i = leader; i < t->info.count; i++) {
+        const dis_instruction_t *in = &t->info.ins[i];
+        uint32_t target = OP_ARGS[in->opcode < DIS_OP_END_OPCODES ? in->opcode : 0][2] ?
+                dis_index_find_instruction(t->info.ins, t->info.count, t->f->code_start + in->arg[0]) : t->info.count;
+
+        if (i != leader && t->block[i] >= 0) {
+            if (!record)
+                types_merge(t, i, stack, depth, env, work, work_len, in_work);
+            return;
+        }
+        if (in->opcode == DIS_OP_SECTION_END || in->opcode == DIS_OP_EOF)
+            return;
+
+        // AND/OR keep their operand when they jump
+        if (!record && (in->opcode == DIS_OP_AND || in->opcode == DIS_OP_OR))
+            types_merge(t, target, stack, depth, env, work, work_len, in_work);
+
+        if (types_step(t, i, stack, &depth, capacity, env, &site) && record)
+            t->sites[t->site_count++] = site;
+
+        if (!record && (in->opcode == DIS_OP_JUMP || in->opcode == DIS_OP_IF_FALSE_JUMP))
+            types_merge(t, target, stack, depth, env, work, work_len, in_work);
+        if (in->opcode == DIS_OP_JUMP || in->opcode == DIS_OP_FN_RETURN)
+            return;
+    }
+}
+
+static void types_free(types_fn_t *t) {
+    dis_stack_info_free(&t->info);
+    free(t->slot_names);
+    free(t->declared);
+    free(t->lit_slot);
+    free(t->lit_mask);
+    free(t->block);
+    free(t->leaders);
+    free(t->stack_base);
+    free(t->stack);
+    free(t->env);
+    free(t->reached);
+    free(t->sites);
+}
+
+static uint8_t types_analyze(const dis_index_t *idx, const types_scope_t *scopes, uint32_t fn, types_fn_t *t) {
+    const dis_function_t *f = &idx->functions[fn];
+    uint32_t literals = f->literal_count + 1, total = 0, work_len = 0, *work;
+    uint16_t length = 0, *env;
+    types_value_t *stack;
+    int32_t capacity;
+    bool *in_work, concrete;
+
+    memset(t, 0, sizeof(types_fn_t));
+    t->idx = idx;
+    t->f = f;
+    t->fn = fn;
+    if (dis_stack_analyze(idx, fn, &t->info))
+        return 1;
+
+    t->slot_names = malloc(literals * sizeof(char*));
+    t->declared = malloc(literals * sizeof(uint16_t));
+    t->lit_slot = malloc(literals * sizeof(int32_t));
+    t->lit_mask = malloc(literals * sizeof(uint16_t));
+
+    // a name declared twice keeps a concrete type only when both declarations have one
+    if (fn != 0 && f->args < f->literal_count && f->literals[f->args].type == DIS_LITERAL_ARRAY)
+        memcpy(&length, idx->program + f->literals[f->args].offset + 1, 2);
+    for (uint32_t i = 0; i < length / 2u + t->info.count; i++) {
+        const char *name;
+        uint16_t mask, type;
+        int32_t slot;
+
+        if (i < length / 2u) {
+            uint16_t literal;
+            memcpy(&literal, idx->program + f->literals[f->args].offset + 3 + 4 * i, 2);
+            memcpy(&type, idx->program + f->literals[f->args].offset + 5 + 4 * i, 2);
+            name = types_literal_name(idx, f, literal);
+            mask = type < f->literal_count && f->literals[type].type == DIS_LITERAL_FUNCTION_ARG_REST ? TYPES_BIT(DIS_LITERAL_ARRAY) :
+                    types_declared(idx, f, type, &concrete);
+            concrete = concrete || mask == TYPES_BIT(DIS_LITERAL_ARRAY);
+        } else {
+            const dis_instruction_t *in = &t->info.ins[i - length / 2];
+            if (in->opcode != DIS_OP_VAR_DECL && in->opcode != DIS_OP_VAR_DECL_LONG)
+                continue;
+            name = types_literal_name(idx, f, in->arg[0]);
+            mask = types_declared(idx, f, in->arg[1], &concrete);
+        }
+        if (name == NULL)
+            continue;
+
+        slot = types_slot(t, name, false);
+        if (slot < 0) {
+            slot = types_slot(t, name, true);
+            t->declared[slot] = concrete ? mask : 0;
+        } else if (!concrete)
+            t->declared[slot] = 0;
+        else if (t->declared[slot])
+            t->declared[slot] |= mask;
+    }
+
+    for (uint32_t l = 0; l < f->literal_count; l++) {
+        const char *name = types_literal_name(idx, f, l);
+
+        t->lit_slot[l] = name != NULL ? types_slot(t, name, false) : TYPES_NO_SLOT;
+        t->lit_mask[l] = name == NULL ? types_literal(f, l) : t->lit_slot[l] < 0 ? types_lookup(idx, scopes, fn, name) : TYPES_ANY;
+    }
+
+    // blocks start at the first instruction and at jump targets
+    t->block = malloc((t->info.count + 1) * sizeof(int32_t));
+    t->leaders = malloc((t->info.count + 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < t->info.count; i++)
+        t->block[i] = i == 0 ? 0 : -1;
+    for (uint32_t i = 0; i < t->info.count; i++) {
+        uint8_t op = t->info.ins[i].opcode;
+        if (op < DIS_OP_END_OPCODES && OP_ARGS[op][2]) {
+            uint32_t target = dis_index_find_instruction(t->info.ins, t->info.count, f->code_start + t->info.ins[i].arg[0]);
+            if (target < t->info.count)
+                t->block[target] = 0;
+        }
+    }
+
+    t->stack_base = malloc((t->info.count + 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < t->info.count; i++) {
+        if (t->block[i] < 0)
+            continue;
+        t->block[i] = t->block_count;
+        t->leaders[t->block_count] = i;
+        t->stack_base[t->block_count++] = total;
+        total += t->info.depth[i] > 0 ? t->info.depth[i] : 0;
+    }
+
+    t->stack = malloc((total + 1) * sizeof(types_value_t));
+    t->env = calloc(t->block_count * t->slot_count + 1, sizeof(uint16_t));
+    t->reached = calloc(t->block_count + 1, sizeof(bool));
+    t->sites = malloc((t->info.count + 1) * sizeof(types_site_t));
+
+    capacity = t->info.max_depth + 1;
+    stack = malloc(capacity * sizeof(types_value_t));
+    env = calloc(t->slot_count + 1, sizeof(uint16_t));
+    work = malloc((t->block_count + 1) * sizeof(uint32_t));
+    in_work = calloc(t->block_count + 1, sizeof(bool));
+
+    // parameters hold their declared type on entry
+    for (uint32_t a = 0; a < length / 2u; a++) {
+        uint16_t literal, type;
+        memcpy(&literal, idx->program + f->literals[f->args].offset + 3 + 4 * a, 2);
+        memcpy(&type, idx->program + f->literals[f->args].offset + 5 + 4 * a, 2);
+        if (types_literal_name(idx, f, literal) != NULL)
+            env[types_slot(t, types_literal_name(idx, f, literal), false)] = type < f->literal_count
+                    && f->literals[type].type == DIS_LITERAL_FUNCTION_ARG_REST ? TYPES_BIT(DIS_LITERAL_ARRAY) : types_declared(idx, f, type, &concrete);
+    }
+    if (t->info.count)
+        types_merge(t, 0, stack, 0, env, work, &work_len, in_work);
+
+    while (work_len) {
+        uint32_t b = work[--work_len];
+        in_work[b] = false;
+        types_walk(t, b, stack, env, capacity, work, &work_len, in_work, false);
+    }
+
+    for (uint32_t b = 0; b < t->block_count; b++)
+        if (t->reached[b])
+            types_walk(t, b, stack, env, capacity, NULL, NULL, NULL, true);
+
+    free(stack);
+    free(env);
+    free(work);
+    free(in_work);
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void types_print_site(const types_site_t *s, bool json) {
+    char a[128], b[128];
+    bool cast = s->opcode == DIS_OP_TYPE_CAST;
+    const char *kind = s->redundant ? "redundant" : KIND_NAMES[s->kind];
+
+    types_mask_str(s->operand[0], a, sizeof(a));
+    types_mask_str(s->operand[1], b, sizeof(b));
+
+    if (json) {
+        printf("{ \"offset\": %u, \"opcode\": \"%s\", \"kind\": \"%s\", \"operands\": [\"%s\"", s->offset, OP_STR[s->opcode] + 7, kind, a);
+        if (s->opcode != DIS_OP_NEGATE)
+            printf(", \"%s\"", b);
+        printf("] }");
+    } else if (cast)
+        printf("    [%05u] %s %s: %s -> %s\n", s->offset, OP_STR[s->opcode] + 7, kind, a, b);
+    else if (s->opcode == DIS_OP_NEGATE)
+        printf("    [%05u] %s %s: %s\n", s->offset, OP_STR[s->opcode] + 7, kind, a);
+    else
+        printf("    [%05u] %s %s: %s, %s\n", s->offset, OP_STR[s->opcode] + 7, kind, a, b);
+}
+
+static void types_print_function(const types_fn_t *t, bool json) {
+    uint32_t arith[3] = { 0 }, casts[3] = { 0 }, redundant = 0, listed = 0;
+
+    for (uint32_t s = 0; s < t->site_count; s++) {
+        if (t->sites[s].opcode == DIS_OP_TYPE_CAST) {
+            ++casts[t->sites[s].kind];
+            redundant += t->sites[s].redundant;
+        } else
+            ++arith[t->sites[s].kind];
+    }
+
+    if (json)
+        printf(", \"arithmetic\": { \"static\": %u, \"polymorphic\": %u, \"error\": %u }, \"casts\": { \"static\": %u, \"polymorphic\": %u, \"redundant\": %u }, \"sites\": [",
+                arith[TYPES_STATIC], arith[TYPES_POLYMORPHIC], arith[TYPES_ERROR], casts[TYPES_STATIC], casts[TYPES_POLYMORPHIC], redundant);
+    else
+        printf("%s: arithmetic: %u static, %u polymorphic, %u errors, casts: %u static (%u redundant), %u polymorphic\n", t->f->path,
+                arith[TYPES_STATIC], arith[TYPES_POLYMORPHIC], arith[TYPES_ERROR], casts[TYPES_STATIC], redundant, casts[TYPES_POLYMORPHIC]);
+
+    // static sites only count, the rest is what slows the VM down
+    for (uint32_t s = 0; s < t->site_count; s++) {
+        if (t->sites[s].kind == TYPES_STATIC && !t->sites[s].redundant)
+            continue;
+        if (json)
+            printf("%s", listed++ ? ", " : "");
+        types_print_site(&t->sites[s], json);
+    }
+
+    if (json)
+        printf("] }");
+}
+
+void dis_types_report(char **files, uint32_t file_count, bool json) {
+    uint32_t printed = 0;
+
+    if (json)
+        printf("[");
+
+    for (uint32_t n = 0; n < file_count; n++) {
+        uint8_t *program = NULL;
+        uint32_t len = 0;
+        dis_index_t idx;
+
+        if (dis_read_file(files[n], &program, &len) || dis_index_build(program, len, &idx)) {
+            fprintf(stderr, "%s: not able to decode the file\n", files[n]);
+            if (program != NULL)
+                dis_index_free(&idx);
+            free(program);
+            continue;
+        }
+
+        types_scope_t *scopes = types_scopes(&idx);
+
+        if (json) {
+            printf("%s\n  { \"file\": ", printed++ ? "," : "");
+            str_print_json(files[n]);
+            printf(", \"functions\": [");
+        } else
+            printf("\n.comment type flow: %s\n", files[n]);
+
+        for (uint32_t i = 0, fn_printed = 0; i < idx.function_count; i++) {
+            types_fn_t t;
+
+            if (types_analyze(&idx, scopes, i, &t)) {
+                fprintf(stderr, "%s: %s: not able to decode the code section\n", files[n], idx.functions[i].path);
+                types_free(&t);
+                continue;
+            }
+
+            if (json) {
+                printf("%s\n    { \"path\": ", fn_printed++ ? "," : "");
+                str_print_json(idx.functions[i].path);
+            }
+            types_print_function(&t, json);
+            types_free(&t);
+        }
+
+        if (json)
+            printf("\n  ] }");
+
+        types_scopes_free(scopes, idx.function_count);
+        dis_index_free(&idx);
+        free(program);
+    }
+
+    if (json)
+        printf("\n]\n");
+}
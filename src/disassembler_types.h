@@ -0,0 +1,19 @@
+/*
+ * disassembler_types.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Type flow per function: literal and declared types are propagated through the operand
+ * stack and local variables to tell arithmetic and casts with statically known operand
+ * types from the polymorphic ones the VM has to check at run time.
+ */
+
+#ifndef DISASSEMBLER_TYPES_H_
+#define DISASSEMBLER_TYPES_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+void dis_types_report(char **files, uint32_t file_count, bool json);
+
+#endif /* DISASSEMBLER_TYPES_H_ */
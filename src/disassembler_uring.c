@@ -0,0 +1,260 @@
+/*
+ * disassembler_uring.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Raw io_uring (no liburing dependency). A group of files costs two submissions: every
+ * OPENAT first, then a READ of DIS_URING_READ bytes hard linked to a CLOSE per file. A read
+ * that fills the whole buffer may have been short of the file end, that file is left to
+ * the caller, as is any file whose open or read failed.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "disassembler_uring.h"
+
+#if defined(__linux__) && !defined(DIS_NO_IO_URING) && __has_include(<linux/io_uring.h>)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#define URING_PENDING INT32_MIN // result slot of an entry that did not complete
+
+struct dis_uring_s {
+    int fd;
+    unsigned entries;
+    _Atomic unsigned *sq_head, *sq_tail, *cq_head, *cq_tail;
+    unsigned *sq_mask, *sq_array, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring, *cq_ring;
+    size_t sq_size, cq_size, sqes_size;
+};
+
+dis_uring_t* dis_uring_open(void) {
+    struct io_uring_params p;
+    dis_uring_t *ring = calloc(1, sizeof(dis_uring_t));
+
+    memset(&p, 0, sizeof(p));
+    ring->fd = syscall(__NR_io_uring_setup, 2 * DIS_URING_FILES, &p);
+    if (ring->fd < 0) {
+        free(ring);
+        return NULL;
+    }
+
+    ring->entries = p.sq_entries;
+    ring->sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    ring->cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_size > ring->sq_size)
+            ring->sq_size = ring->cq_size;
+        ring->cq_size = 0;
+    }
+
+    ring->sq_ring = mmap(NULL, ring->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    ring->cq_ring = ring->cq_size ? mmap(NULL, ring->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING) : ring->sq_ring;
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+
+    if (ring->sq_ring == MAP_FAILED || ring->cq_ring == MAP_FAILED || ring->sqes == MAP_FAILED) {
+        if (ring->sq_ring != MAP_FAILED)
+            munmap(ring->sq_ring, ring->sq_size);
+        if (ring->cq_size && ring->cq_ring != MAP_FAILED)
+            munmap(ring->cq_ring, ring->cq_size);
+        if (ring->sqes != MAP_FAILED)
+            munmap(ring->sqes, ring->sqes_size);
+        close(ring->fd);
+        free(ring);
+        return NULL;
+    }
+
+    ring->sq_head = (_Atomic unsigned*) ((uint8_t*) ring->sq_ring + p.sq_off.head);
+    ring->sq_tail = (_Atomic unsigned*) ((uint8_t*) ring->sq_ring + p.sq_off.tail);
+    ring->sq_mask = (unsigned*) ((uint8_t*) ring->sq_ring + p.sq_off.ring_mask);
+    ring->sq_array = (unsigned*) ((uint8_t*) ring->sq_ring + p.sq_off.array);
+    ring->cq_head = (_Atomic unsigned*) ((uint8_t*) ring->cq_ring + p.cq_off.head);
+    ring->cq_tail = (_Atomic unsigned*) ((uint8_t*) ring->cq_ring + p.cq_off.tail);
+    ring->cq_mask = (unsigned*) ((uint8_t*) ring->cq_ring + p.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*) ((uint8_t*) ring->cq_ring + p.cq_off.cqes);
+
+    return ring;
+}
+
+void dis_uring_close(dis_uring_t *ring) {
+    if (ring == NULL)
+        return;
+
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_size)
+        munmap(ring->cq_ring, ring->cq_size);
+    munmap(ring->sq_ring, ring->sq_size);
+    close(ring->fd);
+    free(ring);
+}
+
+static struct io_uring_sqe* uring_sqe(dis_uring_t *ring, unsigned n) {
+    unsigned tail = atomic_load_explicit(ring->sq_tail, memory_order_relaxed) + n;
+    unsigned slot = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[slot];
+
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sq_array[slot] = slot;
+    return sqe;
+}
+
+// submits n prepared entries and waits for the completions of every one the kernel took,
+// res[user_data] gets each result and stays URING_PENDING for the others. Entries refused
+// for lack of resources are offered again once some in flight completed, 1 is returned when
+// some were never taken (they are removed from the queue) or the ring stopped answering.
+static uint8_t uring_run(dis_uring_t *ring, unsigned n, int32_t *res) {
+    unsigned tail = atomic_load_explicit(ring->sq_tail, memory_order_relaxed), submitted = 0, seen = 0;
+    bool hold = false, err = false;
+
+    for (uint32_t i = 0; i < 2 * DIS_URING_FILES; i++)
+        res[i] = URING_PENDING;
+
+    atomic_store_explicit(ring->sq_tail, tail + n, memory_order_release);
+
+    while (seen < submitted || (submitted < n && !err)) {
+        unsigned to_submit = err || hold ? 0 : n - submitted;
+        unsigned flags = seen < submitted ? IORING_ENTER_GETEVENTS : 0;
+        long r = syscall(__NR_io_uring_enter, ring->fd, to_submit, flags ? 1 : 0, flags, NULL, 0);
+
+        hold = false;
+        if (r > 0)
+            submitted += r;
+        else if (r < 0 && (errno == EAGAIN || errno == EBUSY) && seen < submitted)
+            hold = true;
+        else if (r < 0 && errno != EINTR) {
+            if (!to_submit)
+                break;
+            err = true;
+        } else if (r == 0 && to_submit && seen == submitted)
+            err = true;
+
+        unsigned head = atomic_load_explicit(ring->cq_head, memory_order_relaxed);
+        while (head != atomic_load_explicit(ring->cq_tail, memory_order_acquire)) {
+            const struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+            res[cqe->user_data] = cqe->res;
+            ++head;
+            ++seen;
+        }
+        atomic_store_explicit(ring->cq_head, head, memory_order_release);
+    }
+
+    if (submitted < n)
+        atomic_store_explicit(ring->sq_tail, tail + submitted, memory_order_release);
+
+    return seen < n;
+}
+
+void dis_uring_read_files(dis_uring_t *ring, char **names, uint32_t count, uint8_t **data, uint32_t *len) {
+    int32_t res[2 * DIS_URING_FILES];
+    int fds[DIS_URING_FILES];
+
+    for (uint32_t base = 0; base < count; base += DIS_URING_FILES) {
+        uint32_t n = count - base < DIS_URING_FILES ? count - base : DIS_URING_FILES;
+        unsigned queued = 0;
+
+        for (uint32_t i = 0; i < n; i++) {
+            struct io_uring_sqe *sqe = uring_sqe(ring, i);
+
+            data[base + i] = NULL;
+            len[base + i] = 0;
+
+            sqe->opcode = IORING_OP_OPENAT;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = (uintptr_t) names[base + i];
+            sqe->open_flags = O_RDONLY;
+            sqe->user_data = i;
+        }
+
+        if (uring_run(ring, n, res)) {
+            for (uint32_t i = 0; i < n; i++)
+                if (res[i] >= 0)
+                    close(res[i]);
+            return;
+        }
+
+        for (uint32_t i = 0; i < n; i++) {
+            struct io_uring_sqe *sqe;
+            int fd = res[i];
+
+            if (fd < 0)
+                continue;
+
+            fds[i] = fd;
+            data[base + i] = malloc(DIS_URING_READ);
+
+            // the close runs whatever the read returned
+            sqe = uring_sqe(ring, queued++);
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = fd;
+            sqe->addr = (uintptr_t) data[base + i];
+            sqe->len = DIS_URING_READ;
+            sqe->off = 0;
+            sqe->flags = IOSQE_IO_HARDLINK;
+            sqe->user_data = i;
+
+            sqe = uring_sqe(ring, queued++);
+            sqe->opcode = IORING_OP_CLOSE;
+            sqe->fd = fd;
+            sqe->user_data = DIS_URING_FILES + i;
+        }
+
+        if (queued && uring_run(ring, queued, res)) {
+            for (uint32_t i = 0; i < n; i++) {
+                if (data[base + i] == NULL)
+                    continue;
+
+                // the linked close was never run
+                if (res[DIS_URING_FILES + i] == URING_PENDING)
+                    close(fds[i]);
+                free(data[base + i]);
+                data[base + i] = NULL;
+            }
+            return;
+        }
+
+        for (uint32_t i = 0; i < n; i++) {
+            if (data[base + i] == NULL)
+                continue;
+
+            if (res[i] <= 0 || res[i] >= DIS_URING_READ) {
+                free(data[base + i]);
+                data[base + i] = NULL;
+            } else
+                len[base + i] = res[i];
+        }
+    }
+}
+
+#else
+
+dis_uring_t* dis_uring_open(void) {
+    return NULL;
+}
+
+void dis_uring_close(dis_uring_t *ring) {
+    (void) ring;
+}
+
+void dis_uring_read_files(dis_uring_t *ring, char **names, uint32_t count, uint8_t **data, uint32_t *len) {
+    (void) ring;
+    (void) names;
+
+    for (uint32_t i = 0; i < count; i++) {
+        data[i] = NULL;
+        len[i] = 0;
+    }
+}
+
+#endif
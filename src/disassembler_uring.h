@@ -0,0 +1,26 @@
+/*
+ * disassembler_uring.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Bulk file reading through io_uring: the opens, reads and closes of a whole group of files
+ * are submitted with two io_uring_enter calls. dis_uring_open returns NULL where io_uring
+ * is not available (other systems, old kernels, seccomp), callers then read files as usual.
+ * Define DIS_NO_IO_URING to leave the backend out of the build.
+ */
+
+#ifndef DISASSEMBLER_URING_H_
+#define DISASSEMBLER_URING_H_
+
+#include <stdint.h>
+
+#define DIS_URING_FILES 256         // files per submission
+#define DIS_URING_READ  (64 * 1024) // read size guess, larger files are read again the usual way
+
+typedef struct dis_uring_s dis_uring_t;
+
+dis_uring_t* dis_uring_open(void);
+void dis_uring_close(dis_uring_t *ring);
+void dis_uring_read_files(dis_uring_t *ring, char **names, uint32_t count, uint8_t **data, uint32_t *len);
+
+#endif /* DISASSEMBLER_URING_H_ */
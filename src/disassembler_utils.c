@@ -10,9 +10,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
 
 #include "disassembler_utils.h"
 
+#define DIS_READ_CHUNK (1 << 16)
+
 void dis_enqueue(void *x, queue_node_t **queue_front, queue_node_t **queue_rear, uint32_t *len) {
     queue_node_t *temp;
 
@@ -64,7 +68,12 @@ char* str_replace_substr_all(char *mainstr, char *substr, char *newstr) {
     lenmain = strlen(mainstr);
     lensub = strlen(substr);
     lennew = strlen(newstr);
-    char *result = (char*) malloc(sizeof(char) * (lenmain + 200));
+
+    // room for every occurrence growing by lennew - lensub
+    c = 0;
+    for (const char *found = strstr(mainstr, substr); lensub && found != NULL; found = strstr(found + lensub, substr))
+        c++;
+    char *result = (char*) malloc(sizeof(char) * (lenmain + 1 + (lennew > lensub ? c * (lennew - lensub) : 0)));
     for (c = 0, i = 0; i < lenmain; i++) {
         if (lenmain - i >= lensub && *(mainstr + i) == *(substr)) {
             startindex = i;
@@ -90,3 +99,198 @@ char* str_replace_substr_all(char *mainstr, char *substr, char *newstr) {
     *(result + c) = '\0';
     return result;
 }
+
+void str_print_json(const char *str) {
+    putchar('"');
+    for (; *str; str++) {
+        unsigned char c = *str;
+        if (c == '"' || c == '\\')
+            printf("\\%c", c);
+        else if (c < 0x20)
+            printf("\\u%04x", c);
+        else
+            putchar(c);
+    }
+    putchar('"');
+}
+
+///
+
+void dis_buffer_append(dis_buffer_t *buf, const void *data, uint32_t len) {
+    if (len == 0) // an empty buffer has no data to copy from or to
+        return;
+
+    if (buf->len + len > buf->capacity) {
+        buf->capacity = buf->capacity ? buf->capacity : 256;
+        while (buf->len + len > buf->capacity)
+            buf->capacity *= 2;
+        buf->data = realloc(buf->data, buf->capacity);
+    }
+
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+}
+
+void dis_buffer_byte(dis_buffer_t *buf, uint8_t byte) {
+    dis_buffer_append(buf, &byte, 1);
+}
+
+void dis_buffer_word(dis_buffer_t *buf, uint16_t word) {
+    dis_buffer_append(buf, &word, 2);
+}
+
+void dis_buffer_free(dis_buffer_t *buf) {
+    free(buf->data);
+    buf->data = NULL;
+    buf->len = buf->capacity = 0;
+}
+
+///
+
+// pipes have no size up front, the buffer doubles from DIS_READ_CHUNK
+static uint8_t dis_read_stream(FILE *f, uint8_t **buf, uint32_t *len) {
+    size_t size = DIS_READ_CHUNK, used = 0, bytes;
+
+    *buf = malloc(size);
+    while ((bytes = fread(*buf + used, 1, size - used, f)) > 0) {
+        used += bytes;
+        if (used < size)
+            continue;
+
+        if (size > UINT32_MAX / 2) {
+            free(*buf);
+            *buf = NULL;
+            return 1;
+        }
+        size *= 2;
+        *buf = realloc(*buf, size);
+    }
+
+    if (ferror(f)) {
+        free(*buf);
+        *buf = NULL;
+        return 1;
+    }
+
+    *len = used;
+    return 0;
+}
+
+uint8_t dis_read_file(const char *filename, uint8_t **buf, uint32_t *len) {
+    FILE *f;
+    long fsize;
+
+    if (!strcmp(filename, "-"))
+        return dis_read_stream(stdin, buf, len);
+
+    f = fopen(filename, "rb");
+    if (f == NULL)
+        return 1;
+
+    fseek(f, 0, SEEK_END);
+    fsize = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    if (fsize < 0) {
+        fclose(f);
+        return 1;
+    }
+
+    // one read for the whole file, a per-byte loop dominates on large corpora
+    *buf = malloc(fsize ? fsize : 1);
+    if (fread(*buf, 1, fsize, f) != (size_t) fsize) {
+        free(*buf);
+        *buf = NULL;
+        fclose(f);
+        return 1;
+    }
+
+    *len = fsize;
+    fclose(f);
+    return 0;
+}
+
+uint8_t dis_write_file(const char *filename, const uint8_t *buf, uint32_t len) {
+    FILE *f;
+
+    f = fopen(filename, "wb");
+    if (f == NULL)
+        return 1;
+
+    if (fwrite(buf, 1, len, f) != len) {
+        fclose(f);
+        return 1;
+    }
+
+    return fclose(f) != 0;
+}
+
+static void dis_add_file(const char *path, char ***files, uint32_t *count) {
+    if (!(*count & (*count - 1)))
+        *files = realloc(*files, (*count ? *count * 2 : 1) * sizeof(char*));
+
+    (*files)[*count] = malloc(strlen(path) + 1);
+    strcpy((*files)[*count], path);
+    ++(*count);
+}
+
+static void dis_walk_dir(const char *path, const char *ext, char ***files, uint32_t *count) {
+    struct stat st;
+    struct dirent *entry;
+    DIR *dir;
+
+    dir = opendir(path);
+    if (dir == NULL)
+        return;
+
+    while ((entry = readdir(dir)) != NULL) {
+        size_t nlen = strlen(entry->d_name);
+        char child[strlen(path) + nlen + 2];
+
+        if (entry->d_name[0] == '.')
+            continue;
+
+        // links are skipped, they could loop back or list the same file twice
+        sprintf(child, "%s/%s", path, entry->d_name);
+        if (lstat(child, &st) != 0 || S_ISLNK(st.st_mode))
+            continue;
+
+        if (S_ISDIR(st.st_mode))
+            dis_walk_dir(child, ext, files, count);
+        else if (nlen >= strlen(ext) && !strcmp(entry->d_name + nlen - strlen(ext), ext))
+            dis_add_file(child, files, count);
+    }
+
+    closedir(dir);
+}
+
+static int dis_path_cmp(const void *a, const void *b) {
+    return strcmp(*(char* const*) a, *(char* const*) b);
+}
+
+void dis_collect_files(const char *path, const char *ext, char ***files, uint32_t *count) {
+    struct stat st;
+    uint32_t start = *count;
+
+    if (stat(path, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        dis_add_file(path, files, count);
+        return;
+    }
+
+    // readdir order depends on the file system, sorted the listings are the same everywhere
+    dis_walk_dir(path, ext, files, count);
+    if (*count > start)
+        qsort(*files + start, *count - start, sizeof(char*), dis_path_cmp);
+}
+
+// FNV-1a 64, chain calls by passing the previous result as hash
+uint64_t dis_hash(const void *data, uint32_t len, uint64_t hash) {
+    const uint8_t *p = data;
+
+    for (uint32_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
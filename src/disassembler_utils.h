@@ -17,10 +17,31 @@ typedef struct queue_node_s {
 	struct queue_node_s *next;
 } queue_node_t;
 
+typedef struct dis_buffer_s {
+    uint8_t *data;
+    uint32_t len;
+    uint32_t capacity;
+} dis_buffer_t;
+
 void dis_enqueue(void *x, queue_node_t **queue_front, queue_node_t **queue_rear, uint32_t *len);
 void dis_dequeue(queue_node_t **queue_front, queue_node_t **queue_rear, uint32_t *len);
 
 void str_append(char **str, const char *app);
 char* str_replace_substr_all(char *mainstr, char *substr, char *newstr);
+void str_print_json(const char *str);
+
+void dis_buffer_append(dis_buffer_t *buf, const void *data, uint32_t len);
+void dis_buffer_byte(dis_buffer_t *buf, uint8_t byte);
+void dis_buffer_word(dis_buffer_t *buf, uint16_t word);
+void dis_buffer_free(dis_buffer_t *buf);
+
+// "-" reads stdin to its end
+uint8_t dis_read_file(const char *filename, uint8_t **buf, uint32_t *len);
+uint8_t dis_write_file(const char *filename, const uint8_t *buf, uint32_t len);
+// a directory is walked for files ending in ext, sorted by path, links inside it are skipped
+void dis_collect_files(const char *path, const char *ext, char ***files, uint32_t *count);
+
+#define DIS_HASH_SEED 0xcbf29ce484222325ULL
+uint64_t dis_hash(const void *data, uint32_t len, uint64_t hash);
 
 #endif /* UTILS_H_ */
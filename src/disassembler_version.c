@@ -0,0 +1,190 @@
+/*
+ * disassembler_version.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Toy 1.x stopped executing TYPE_DECL, TYPE_DECL_LONG and EXPORT (kept as *_removed so the
+ * numbering stays put). The decode loop is instantiated once per table so the per-instruction
+ * path only reads constant tables, there is no version test in it. A header of a major
+ * version with no registered table is refused rather than decoded with a guessed layout,
+ * dis_opset_select returns NULL for it.
+ *
+ * Only the opcode tables differ between versions. Every known version encodes literals the
+ * same way, with the one LITERAL_FORMAT table below, and no minor version changed either.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "disassembler_index.h"
+#include "disassembler_version.h"
+
+#define VER_LITERAL_TYPES (DIS_LITERAL_INDEX_BLANK + 1)
+
+static const uint8_t LITERAL_FORMAT[VER_LITERAL_TYPES] = {
+        [DIS_LITERAL_NULL] = DIS_LITFMT_EMPTY,                       //
+        [DIS_LITERAL_BOOLEAN] = DIS_LITFMT_BYTE,                     //
+        [DIS_LITERAL_INTEGER] = DIS_LITFMT_FOUR,                     //
+        [DIS_LITERAL_FLOAT] = DIS_LITFMT_FOUR,                       //
+        [DIS_LITERAL_STRING] = DIS_LITFMT_STRING,                    //
+        [DIS_LITERAL_ARRAY] = DIS_LITFMT_ELEMENTS,                   //
+        [DIS_LITERAL_DICTIONARY] = DIS_LITFMT_PAIRS,                 //
+        [DIS_LITERAL_FUNCTION] = DIS_LITFMT_WORD,                    //
+        [DIS_LITERAL_IDENTIFIER] = DIS_LITFMT_STRING,                //
+        [DIS_LITERAL_TYPE] = DIS_LITFMT_TYPE,                        //
+        [DIS_LITERAL_TYPE_INTERMEDIATE] = DIS_LITFMT_TYPE,           //
+        [DIS_LITERAL_ARRAY_INTERMEDIATE] = DIS_LITFMT_ELEMENTS,      //
+        [DIS_LITERAL_DICTIONARY_INTERMEDIATE] = DIS_LITFMT_PAIRS,    //
+        [DIS_LITERAL_INDEX_BLANK] = DIS_LITFMT_EMPTY,                //
+};
+
+static const bool OP_REMOVED_V1[DIS_OP_END_OPCODES] = {
+        [DIS_OP_TYPE_DECL_removed] = true,      //
+        [DIS_OP_TYPE_DECL_LONG_removed] = true, //
+        [DIS_OP_EXPORT_removed] = true,         //
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the tables are compile time constants in each instantiation below
+static inline __attribute__((always_inline)) uint8_t ver_decode(const uint8_t (*args)[3], const bool *removed, const uint8_t *program, uint32_t pc,
+        uint32_t end, dis_instruction_t *ins) {
+    uint16_t word;
+
+    ins->offset = pc;
+    ins->opcode = program[pc];
+    ins->size = 1;
+    ins->arg[0] = ins->arg[1] = 0;
+
+    if (ins->opcode == DIS_OP_SECTION_END || ins->opcode == DIS_OP_EOF)
+        return 0;
+
+    if (ins->opcode >= DIS_OP_END_OPCODES || removed[ins->opcode])
+        return 1;
+
+    ++pc;
+    for (uint8_t n = 0; n < 2; n++) {
+        uint32_t size = 0;
+
+        switch (args[ins->opcode][n]) {
+            case DIS_ARG_NONE:
+                break;
+            case DIS_ARG_BYTE:
+                if (pc + 1 > end)
+                    return 1;
+                ins->arg[n] = program[pc];
+                size = 1;
+                break;
+            case DIS_ARG_WORD:
+                if (pc + 2 > end)
+                    return 1;
+                memcpy(&word, program + pc, 2);
+                ins->arg[n] = word;
+                size = 2;
+                break;
+            case DIS_ARG_INTEGER:
+            case DIS_ARG_FLOAT:
+                if (pc + 4 > end)
+                    return 1;
+                memcpy(&ins->arg[n], program + pc, 4);
+                size = 4;
+                break;
+            case DIS_ARG_STRING: {
+                const uint8_t *nul = pc < end ? memchr(program + pc, '\0', end - pc) : NULL;
+
+                if (nul == NULL)
+                    return 1;
+                size = (uint32_t) (nul - (program + pc)) + 1;
+                ins->arg[n] = pc;
+            }
+                break;
+        }
+
+        pc += size;
+    }
+
+    ins->size = pc - ins->offset;
+    return 0;
+}
+
+static uint8_t ver_decode_v1(const uint8_t *program, uint32_t pc, uint32_t end, dis_instruction_t *ins) {
+    return ver_decode(OP_ARGS, OP_REMOVED_V1, program, pc, end, ins);
+}
+
+// newest first
+static const dis_opset_t OPSETS[] = {
+        { 0, "Toy 1.x", 1, OP_ARGS, OP_REMOVED_V1, ver_decode_v1 },
+};
+
+const dis_opset_t* dis_opset_latest(void) {
+    return &OPSETS[0];
+}
+
+const dis_opset_t* dis_opset_select(uint8_t major) {
+    for (uint32_t i = 0; i < sizeof(OPSETS) / sizeof(OPSETS[0]); i++)
+        if (OPSETS[i].major == major)
+            return &OPSETS[i];
+
+    return NULL;
+}
+
+const dis_opset_t* dis_opset_header(const uint8_t *program, uint32_t len) {
+    const dis_opset_t *ops = len >= 1 ? dis_opset_select(program[0]) : NULL;
+
+    // callers only reach here with a program dis_index_build accepted
+    return ops != NULL ? ops : &OPSETS[0];
+}
+
+uint8_t dis_literal_size(const uint8_t *program, uint32_t pc, uint32_t end, uint32_t *size) {
+    uint32_t start = pc;
+    uint16_t length;
+    const uint8_t *nul;
+
+    if (pc >= end || program[pc] >= VER_LITERAL_TYPES)
+        return 1;
+
+    switch (LITERAL_FORMAT[program[pc++]]) {
+        case DIS_LITFMT_EMPTY:
+            break;
+        case DIS_LITFMT_BYTE:
+            pc += 1;
+            break;
+        case DIS_LITFMT_FOUR:
+            pc += 4;
+            break;
+        case DIS_LITFMT_WORD:
+            pc += 2;
+            break;
+        case DIS_LITFMT_STRING:
+            if (pc >= end || (nul = memchr(program + pc, '\0', end - pc)) == NULL)
+                return 1;
+            pc = nul - program + 1;
+            break;
+        case DIS_LITFMT_ELEMENTS:
+        case DIS_LITFMT_PAIRS:
+            if (pc + 2 > end)
+                return 1;
+            memcpy(&length, program + pc, 2);
+            pc += 2;
+            pc += LITERAL_FORMAT[program[start]] == DIS_LITFMT_PAIRS ? 4 * (length / 2) : 2 * length;
+            break;
+        case DIS_LITFMT_TYPE:
+            if (pc + 2 > end || program[pc] >= VER_LITERAL_TYPES)
+                return 1;
+            if (program[pc] == DIS_LITERAL_ARRAY)
+                pc += 2;
+            else if (program[pc] == DIS_LITERAL_DICTIONARY)
+                pc += 4;
+            pc += 2;
+            break;
+        default:
+            return 1;
+    }
+
+    if (pc > end)
+        return 1;
+
+    *size = pc - start;
+    return 0;
+}
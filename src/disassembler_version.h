@@ -0,0 +1,47 @@
+/*
+ * disassembler_version.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Opcode tables per Toy bytecode version, chosen once from the major version of the .tb
+ * header. Each registered version carries its own decode loop specialized on its tables.
+ */
+
+#ifndef DISASSEMBLER_VERSION_H_
+#define DISASSEMBLER_VERSION_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "disassembler.h"
+
+struct dis_instruction_s;
+
+typedef enum DIS_LITERAL_FORMAT {
+    DIS_LITFMT_INVALID,  // not stored in a literal cache
+    DIS_LITFMT_EMPTY,    // type byte only
+    DIS_LITFMT_BYTE,     //
+    DIS_LITFMT_FOUR,     // integer or float
+    DIS_LITFMT_WORD,     //
+    DIS_LITFMT_STRING,   // NUL terminated
+    DIS_LITFMT_ELEMENTS, // count word then one word per element
+    DIS_LITFMT_PAIRS,    // count word (keys and values) then one word per key or value
+    DIS_LITFMT_TYPE,     // kind and const bytes, then the subtype words of arrays and dictionaries
+} dis_literal_format_t;
+
+typedef uint8_t (*dis_decode_fn_t)(const uint8_t *program, uint32_t pc, uint32_t end, struct dis_instruction_s *ins);
+
+typedef struct dis_opset_s {
+    uint8_t id;                              // position in the registry, part of the section cache key
+    const char *name;                        //
+    uint8_t major;                           // header major version served
+    const uint8_t (*args)[3];                // same layout as OP_ARGS
+    const bool *removed;                     // opcodes the runtime of this version rejects
+    dis_decode_fn_t decode;                  //
+} dis_opset_t;
+
+const dis_opset_t* dis_opset_latest(void);
+const dis_opset_t* dis_opset_select(uint8_t major);
+const dis_opset_t* dis_opset_header(const uint8_t *program, uint32_t len);
+
+#endif /* DISASSEMBLER_VERSION_H_ */
@@ -0,0 +1,361 @@
+/*
+ * disassembler_watch.c
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Every directory under the watched one gets an inotify watch, new directories are added
+ * as they appear. A .tb file is rendered again when it is closed after writing or moved
+ * into place, all events read together are coalesced first so a file written by several
+ * processes at once is rendered once.
+ *
+ * Each file keeps its state resident between renders: the hash of the bytes of the last
+ * render, which skips files that were rewritten with the same contents, and a memo of its
+ * rendered code sections keyed by their content, so only the functions whose bytes changed
+ * go through the listing code again. Listings are written to a temporary name and renamed,
+ * an editor never shows a partial one.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+
+#include "disassembler_utils.h"
+#include "disassembler_index.h"
+#include "disassembler_cache.h"
+#include "disassembler_watch.h"
+
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_CREATE | IN_ONLYDIR)
+
+typedef struct watch_file_s {
+    char *path;      // input
+    char *out;       // mirrored listing
+    uint64_t hash;   // of the bytes of the last render
+    dis_memo_t memo; // code sections of the last render
+} watch_file_t;
+
+typedef struct watch_dir_s {
+    int wd;     //
+    char *path; //
+} watch_dir_t;
+
+typedef struct watch_s {
+    char *dir;
+    char *out_dir;
+    options_t config;
+    int fd;
+    watch_dir_t *dirs;
+    uint32_t dir_count;
+    watch_file_t *files;
+    uint32_t file_count;
+} watch_t;
+
+static volatile sig_atomic_t watch_stop = 0;
+
+static void watch_signal(int sig) {
+    (void) sig;
+    watch_stop = 1;
+}
+
+static bool watch_is_tb(const char *name) {
+    size_t len = strlen(name);
+
+    return len > 3 && name[0] != '.' && !strcmp(name + len - 3, ".tb");
+}
+
+static char* watch_strdup_trimmed(const char *path) {
+    char *s = strdup(path);
+    size_t len = strlen(s);
+
+    while (len > 1 && s[len - 1] == '/')
+        s[--len] = '\0';
+
+    return s;
+}
+
+// DIR/a/b.tb -> OUT/a/b.txt, creating the directories on the way
+static char* watch_out_path(watch_t *w, const char *path) {
+    const char *rel = path + strlen(w->dir) + 1;
+    size_t len = strlen(w->out_dir) + strlen(rel) + 3;
+    char *out = malloc(len);
+
+    snprintf(out, len, "%s/%.*s.txt", w->out_dir, (int) (strlen(rel) - 3), rel);
+
+    for (char *p = out + 1; (p = strchr(p, '/')) != NULL; p++) {
+        *p = '\0';
+        mkdir(out, 0777);
+        *p = '/';
+    }
+
+    return out;
+}
+
+static void watch_list_add(char ***list, uint32_t *count, const char *path) {
+    *list = realloc(*list, (*count + 1) * sizeof(char*));
+    (*list)[(*count)++] = strdup(path);
+}
+
+static watch_file_t* watch_find(watch_t *w, const char *path) {
+    for (uint32_t i = 0; i < w->file_count; i++)
+        if (!strcmp(w->files[i].path, path))
+            return &w->files[i];
+
+    return NULL;
+}
+
+static void watch_forget(watch_t *w, const char *path) {
+    watch_file_t *f = watch_find(w, path);
+
+    if (f == NULL)
+        return;
+
+    remove(f->out);
+    printf(".comment watch %s: removed %s\n", f->path, f->out);
+    fflush(stdout);
+
+    free(f->path);
+    free(f->out);
+    dis_memo_free(&f->memo);
+    *f = w->files[--w->file_count];
+}
+
+static void watch_render(watch_t *w, const char *path) {
+    watch_file_t *f = watch_find(w, path);
+    struct timespec t0, t1;
+    uint8_t *data = NULL;
+    uint32_t len = 0;
+    dis_index_t idx;
+    FILE *stream;
+    uint64_t hash;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    // moved away or deleted again before the event was read
+    if (dis_read_file(path, &data, &len)) {
+        watch_forget(w, path);
+        return;
+    }
+
+    hash = dis_hash(data, len, DIS_HASH_SEED);
+    if (f != NULL && f->hash == hash) {
+        free(data);
+        return;
+    }
+
+    // the listing code exits on malformed input, a file caught half written keeps its listing
+    if (dis_index_build(data, len, &idx)) {
+        fprintf(stderr, "%s: not able to decode the file\n", path);
+        dis_index_free(&idx);
+        free(data);
+        return;
+    }
+    dis_index_free(&idx);
+
+    if (f == NULL) {
+        w->files = realloc(w->files, (w->file_count + 1) * sizeof(watch_file_t));
+        f = &w->files[w->file_count++];
+        memset(f, 0, sizeof(watch_file_t));
+        f->path = strdup(path);
+        f->out = watch_out_path(w, path);
+    }
+
+    char tmp[strlen(f->out) + 5];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", f->out);
+
+    stream = fopen(tmp, "w");
+    if (stream == NULL) {
+        perror(tmp);
+        free(data);
+        return;
+    }
+
+    w->config.memo = &f->memo;
+    disassemble_buffer(path, data, len, w->config, stream);
+    w->config.memo = NULL;
+    free(data);
+
+    if (fclose(stream) || rename(tmp, f->out)) {
+        perror(f->out);
+        remove(tmp);
+        return;
+    }
+
+    f->hash = hash;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    printf(".comment watch %s: %u of %u code sections rendered, %.2f ms\n", path, f->memo.misses, f->memo.hits + f->memo.misses,
+            (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6);
+    fflush(stdout);
+
+    dis_memo_sweep(&f->memo);
+}
+
+// watches path and everything below it, then renders the files found there
+static void watch_add_dir(watch_t *w, const char *path) {
+    char **files = NULL;
+    uint32_t count = 0;
+    int wd;
+
+    wd = inotify_add_watch(w->fd, path, WATCH_EVENTS);
+    if (wd < 0) {
+        perror(path);
+        return;
+    }
+
+    w->dirs = realloc(w->dirs, (w->dir_count + 1) * sizeof(watch_dir_t));
+    w->dirs[w->dir_count].wd = wd;
+    w->dirs[w->dir_count].path = strdup(path);
+    w->dir_count++;
+
+    DIR *dir = opendir(path);
+    if (dir != NULL) {
+        struct dirent *entry;
+        struct stat st;
+
+        while ((entry = readdir(dir)) != NULL) {
+            char child[strlen(path) + strlen(entry->d_name) + 2];
+
+            if (entry->d_name[0] == '.')
+                continue;
+
+            sprintf(child, "%s/%s", path, entry->d_name);
+            if (stat(child, &st) == 0 && S_ISDIR(st.st_mode))
+                watch_add_dir(w, child);
+            else if (watch_is_tb(entry->d_name))
+                watch_list_add(&files, &count, child);
+        }
+
+        closedir(dir);
+    }
+
+    // after the watch is in place, a file written meanwhile is either seen here or in an event
+    for (uint32_t i = 0; i < count; i++) {
+        watch_render(w, files[i]);
+        free(files[i]);
+    }
+    free(files);
+}
+
+static const char* watch_dir_path(watch_t *w, int wd) {
+    for (uint32_t i = 0; i < w->dir_count; i++)
+        if (w->dirs[i].wd == wd)
+            return w->dirs[i].path;
+
+    return NULL;
+}
+
+static void watch_pending_add(char ***pending, uint32_t *count, const char *path) {
+    for (uint32_t i = 0; i < *count; i++)
+        if (!strcmp((*pending)[i], path))
+            return;
+
+    watch_list_add(pending, count, path);
+}
+
+// one read worth of events, renders after all of them are seen
+static uint8_t watch_events(watch_t *w) {
+    char buf[64 * 1024] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    char **pending = NULL;
+    uint32_t pending_count = 0;
+    ssize_t n;
+
+    n = read(w->fd, buf, sizeof(buf));
+    if (n < 0)
+        return errno == EINTR ? 0 : 1;
+
+    for (char *p = buf; p < buf + n; p += sizeof(struct inotify_event) + ((struct inotify_event*) p)->len) {
+        const struct inotify_event *ev = (const struct inotify_event*) p;
+        const char *dir = watch_dir_path(w, ev->wd);
+
+        if (ev->mask & IN_Q_OVERFLOW)
+            fprintf(stderr, "%s: events lost, touch the files to render them again\n", w->dir);
+
+        if (dir == NULL || ev->len == 0 || ev->name[0] == '.')
+            continue;
+
+        char path[strlen(dir) + strlen(ev->name) + 2];
+        sprintf(path, "%s/%s", dir, ev->name);
+
+        if (ev->mask & IN_ISDIR) {
+            if (ev->mask & (IN_CREATE | IN_MOVED_TO))
+                watch_add_dir(w, path);
+        } else if (watch_is_tb(ev->name)) {
+            if (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+                watch_pending_add(&pending, &pending_count, path);
+            else if (ev->mask & (IN_DELETE | IN_MOVED_FROM))
+                watch_forget(w, path);
+        }
+    }
+
+    for (uint32_t i = 0; i < pending_count; i++) {
+        watch_render(w, pending[i]);
+        free(pending[i]);
+    }
+    free(pending);
+
+    return 0;
+}
+
+uint8_t dis_watch(const char *dir, const char *out_dir, options_t config) {
+    watch_t w = { .config = config };
+    struct sigaction sa;
+    struct stat st;
+    uint8_t err = 0;
+
+    if (stat(dir, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        fprintf(stderr, "%s: not a directory\n", dir);
+        return 1;
+    }
+
+    // the rendered sections are held in memory, the per section disk cache adds nothing
+    w.config.cache_dir = NULL;
+    w.config.stream_flag = false;
+
+    w.dir = watch_strdup_trimmed(dir);
+    w.out_dir = watch_strdup_trimmed(out_dir != NULL ? out_dir : dir);
+
+    w.fd = inotify_init1(IN_CLOEXEC);
+    if (w.fd < 0) {
+        perror("inotify");
+        free(w.dir);
+        free(w.out_dir);
+        return 1;
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = watch_signal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    watch_add_dir(&w, w.dir);
+    printf(".comment watching %s: %u files in %u directories, listings in %s\n", w.dir, w.file_count, w.dir_count, w.out_dir);
+    fflush(stdout);
+
+    while (!watch_stop && !err)
+        err = watch_events(&w);
+
+    if (err)
+        perror(w.dir);
+
+    close(w.fd);
+    for (uint32_t i = 0; i < w.file_count; i++) {
+        free(w.files[i].path);
+        free(w.files[i].out);
+        dis_memo_free(&w.files[i].memo);
+    }
+    for (uint32_t i = 0; i < w.dir_count; i++)
+        free(w.dirs[i].path);
+    free(w.files);
+    free(w.dirs);
+    free(w.dir);
+    free(w.out_dir);
+
+    return err;
+}
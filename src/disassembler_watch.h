@@ -0,0 +1,19 @@
+/*
+ * disassembler_watch.h
+ *
+ *  Created on: 19 oct. 2026
+ *
+ * Watch mode: keeps the listing of every .tb file under a directory up to date in a
+ * mirrored tree, re-rendering only the files and the code sections that changed.
+ */
+
+#ifndef DISASSEMBLER_WATCH_H_
+#define DISASSEMBLER_WATCH_H_
+
+#include <stdint.h>
+
+#include "disassembler.h"
+
+uint8_t dis_watch(const char *dir, const char *out_dir, options_t config);
+
+#endif /* DISASSEMBLER_WATCH_H_ */
@@ -1,7 +1,28 @@
 #include <stdlib.h>
+#include <errno.h>
 
 #include "cargs.h"
+#include "assembler.h"
 #include "disassembler.h"
+#include "disassembler_ngram.h"
+#include "disassembler_optimizer.h"
+#include "disassembler_compact.h"
+#include "disassembler_stack.h"
+#include "disassembler_deadcode.h"
+#include "disassembler_diff.h"
+#include "disassembler_symbolize.h"
+#include "disassembler_daemon.h"
+#include "disassembler_batch.h"
+#include "disassembler_size.h"
+#include "disassembler_dupes.h"
+#include "disassembler_fuzz.h"
+#include "disassembler_decompile.h"
+#include "disassembler_types.h"
+#include "disassembler_browse.h"
+#include "disassembler_watch.h"
+
+// -o output is written in blocks of this size
+#define DIS_OUTPUT_BUFFER (1 << 20)
 
 static struct cag_option options[] = {
         {
@@ -16,6 +37,156 @@ static struct cag_option options[] = {
                 .access_name = NULL,
                 .value_name = NULL,
                 .description = "Group literals with functions"
+        }, {
+                .identifier = 'm',
+                .access_letters = "m",
+                .access_name = "stream",
+                .value_name = NULL,
+                .description = "Stream the input section by section, memory use stays flat for any file size"
+        }, {
+                .identifier = 'x',
+                .access_letters = "x",
+                .access_name = "hex",
+                .value_name = NULL,
+                .description = "Show the raw bytes of every instruction and literal entry (default format)"
+        }, {
+                .identifier = 'o',
+                .access_letters = "o",
+                .access_name = "output",
+                .value_name = "FILE",
+                .description = "Write the output to FILE instead of stdout (input file - reads stdin)"
+        }, {
+                .identifier = 'b',
+                .access_letters = "b",
+                .access_name = "batch",
+                .value_name = NULL,
+                .description = "Disassemble every file or directory given, reading, rendering and writing in parallel"
+        }, {
+                .identifier = 'c',
+                .access_letters = "c",
+                .access_name = "cache",
+                .value_name = "DIR",
+                .description = "Serve unchanged files and code sections from a disassembly cache in DIR"
+        }, {
+                .identifier = 'p',
+                .access_letters = "p",
+                .access_name = "profile",
+                .value_name = "FILE",
+                .description = "Annotate the listing with execution counts (OFFSET, PATH:OFFSET or PATH: per line, then COUNT)"
+        }, {
+                .identifier = 'n',
+                .access_letters = "n",
+                .access_name = "ngram",
+                .value_name = "N",
+                .description = "Count opcode N-grams over files/directories (corpus mode)"
+        }, {
+                .identifier = 't',
+                .access_letters = "t",
+                .access_name = "top",
+                .value_name = "K",
+                .description = "Number of entries reported by corpus modes (default 50)"
+        }, {
+                .identifier = 'O',
+                .access_letters = "O",
+                .access_name = "optimize",
+                .value_name = "OUT",
+                .description = "Write a peephole optimized copy of file to OUT"
+        }, {
+                .identifier = 'C',
+                .access_letters = "C",
+                .access_name = "compact",
+                .value_name = "OUT",
+                .description = "Write a copy of file with deduplicated literal caches to OUT"
+        }, {
+                .identifier = 'F',
+                .access_letters = "F",
+                .access_name = "fuzz",
+                .value_name = "RUNS",
+                .description = "Fuzz the decoders with RUNS mutants of the seed files/directories, timing every input (0 times the seeds only)"
+        }, {
+                .identifier = 'i',
+                .access_letters = "i",
+                .access_name = "browse",
+                .value_name = NULL,
+                .description = "Browse file interactively, functions are decoded as they are expanded or scrolled into view"
+        }, {
+                .identifier = 'w',
+                .access_letters = "w",
+                .access_name = "watch",
+                .value_name = "DIR",
+                .description = "Keep listings of the .tb files under DIR up to date, mirrored into the -o directory (default DIR)"
+        }, {
+                .identifier = 'A',
+                .access_letters = "A",
+                .access_name = "assemble",
+                .value_name = "OUT",
+                .description = "Assemble alternate format source file into OUT"
+        }, {
+                .identifier = 's',
+                .access_letters = "s",
+                .access_name = "stack",
+                .value_name = NULL,
+                .description = "Report max stack depth and merge conflicts per function"
+        }, {
+                .identifier = 'u',
+                .access_letters = "u",
+                .access_name = "unused",
+                .value_name = NULL,
+                .description = "Report unreachable code and dead literals per function"
+        }, {
+                .identifier = 'y',
+                .access_letters = "y",
+                .access_name = "types",
+                .value_name = NULL,
+                .description = "Report arithmetic and casts with statically known or polymorphic operand types per function"
+        }, {
+                .identifier = 'z',
+                .access_letters = "z",
+                .access_name = "size",
+                .value_name = NULL,
+                .description = "Attribute every byte to header, literals by type, overhead, code and markers per function"
+        }, {
+                .identifier = 'k',
+                .access_letters = "k",
+                .access_name = "sort",
+                .value_name = "KEY",
+                .description = "Size report order: total (default), self, code, literals or tree"
+        }, {
+                .identifier = 'U',
+                .access_letters = "U",
+                .access_name = "dupes",
+                .value_name = NULL,
+                .description = "Group identical and near-identical functions over files/directories (corpus mode)"
+        }, {
+                .identifier = 'e',
+                .access_letters = "e",
+                .access_name = "decompile",
+                .value_name = NULL,
+                .description = "Print Toy-like pseudo source per function, statements tagged with their code offset"
+        }, {
+                .identifier = 'd',
+                .access_letters = "d",
+                .access_name = "diff",
+                .value_name = NULL,
+                .description = "Structural diff of two files or directories, by function path"
+        }, {
+                .identifier = 'S',
+                .access_letters = "S",
+                .access_name = "symbolize",
+                .value_name = "OFFSETS",
+                .description = "Map offsets (one per line, - for stdin) to function and instruction"
+        }, {
+                .identifier = 'D',
+                .access_letters = "D",
+                .access_name = "daemon",
+                .value_name = "SOCKET",
+                .description = "Serve disassembly requests on a Unix socket"
+        }, {
+                .identifier = 'j',
+                .access_letters = "j",
+                .access_name = "json",
+                .value_name = NULL,
+                .description = "JSON output for reports"
         }, {
                 .identifier = 'h',
                 .access_letters = "h",
@@ -24,10 +195,38 @@ static struct cag_option options[] = {
         }
 };
 
+static void usage(FILE *stream) {
+	fprintf(stream, "Usage: disassembler [OPTION] file\n");
+	cag_option_print(options, CAG_ARRAY_SIZE(options), stream);
+}
+
+// whole decimal numbers in [min, max] only, 0 on success
+static uint8_t parse_number(const char *str, long min, long max, long *value) {
+	char *end;
+
+	errno = 0;
+	*value = strtol(str, &end, 10);
+	return str[0] == '\0' || *end != '\0' || errno == ERANGE || *value < min || *value > max;
+}
+
 int main(int argc, char *argv[]) {
 	char identifier;
 	cag_option_context context;
-	options_t config = { false, false };
+	options_t config = { false, false, NULL, NULL, false, false, NULL };
+	uint8_t ngram = 0;
+	uint32_t top = 50;
+	long number;
+	int64_t fuzz = -1;
+	const char *optimize = NULL;
+	const char *compact = NULL;
+	const char *assemble = NULL;
+	const char *symbolize = NULL;
+	const char *daemon = NULL;
+	const char *watch = NULL;
+	const char *output = NULL;
+	bool stack = false, unused = false, diff = false, batch = false, json = false, size = false, dupes = false, decompile = false, types = false;
+	bool browse = false;
+	dis_size_sort_t sort = DIS_SIZE_SORT_TOTAL;
 
 	cag_option_prepare(&context, options, CAG_ARRAY_SIZE(options), argc, argv);
 	while (cag_option_fetch(&context)) {
@@ -40,13 +239,191 @@ int main(int argc, char *argv[]) {
 		    config.group_flag = true;
 		    config.alt_format_flag = true;
 		    break;
+		case 'm':
+			config.stream_flag = true;
+			break;
+		case 'x':
+			config.hex_flag = true;
+			break;
+		case 'o':
+			output = cag_option_get_value(&context);
+			break;
+		case 'b':
+			batch = true;
+			break;
+		case 'c':
+			config.cache_dir = cag_option_get_value(&context);
+			break;
+		case 'p':
+			config.profile = cag_option_get_value(&context);
+			break;
+		case 'n':
+			if (parse_number(cag_option_get_value(&context), 1, DIS_NGRAM_MAX, &number)) {
+				fprintf(stderr, "-n needs an n-gram length between 1 and %d, got %s\n", DIS_NGRAM_MAX, cag_option_get_value(&context));
+				usage(stderr);
+				return EXIT_FAILURE;
+			}
+			ngram = number;
+			break;
+		case 't':
+			if (parse_number(cag_option_get_value(&context), 0, UINT32_MAX, &number)) {
+				fprintf(stderr, "-t needs a count, got %s\n", cag_option_get_value(&context));
+				usage(stderr);
+				return EXIT_FAILURE;
+			}
+			top = number;
+			break;
+		case 'O':
+			optimize = cag_option_get_value(&context);
+			break;
+		case 'C':
+			compact = cag_option_get_value(&context);
+			break;
+		case 'F':
+			if (parse_number(cag_option_get_value(&context), 0, UINT32_MAX, &number)) {
+				fprintf(stderr, "-F needs a run count, got %s\n", cag_option_get_value(&context));
+				usage(stderr);
+				return EXIT_FAILURE;
+			}
+			fuzz = number;
+			break;
+		case 'i':
+			browse = true;
+			break;
+		case 'w':
+			watch = cag_option_get_value(&context);
+			break;
+		case 'A':
+			assemble = cag_option_get_value(&context);
+			break;
+		case 's':
+			stack = true;
+			break;
+		case 'u':
+			unused = true;
+			break;
+		case 'y':
+			types = true;
+			break;
+		case 'z':
+			size = true;
+			break;
+		case 'k':
+			if (dis_size_sort_key(cag_option_get_value(&context), &sort)) {
+				fprintf(stderr, "unknown sort key %s\n", cag_option_get_value(&context));
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'U':
+			dupes = true;
+			break;
+		case 'e':
+			decompile = true;
+			break;
+		case 'd':
+			diff = true;
+			break;
+		case 'S':
+			symbolize = cag_option_get_value(&context);
+			break;
+		case 'D':
+			daemon = cag_option_get_value(&context);
+			break;
+		case 'j':
+			json = true;
+			break;
 		case 'h':
-			printf("Usage: disassembler [OPTION] file\n");
-			cag_option_print(options, CAG_ARRAY_SIZE(options), stdout);
+			usage(stdout);
 			return EXIT_SUCCESS;
 		}
 	}
 
+	// the output names a directory of listings here, not a file
+	if (watch != NULL)
+		return dis_watch(watch, output, config) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+	if (output != NULL) {
+		if (freopen(output, "w", stdout) == NULL) {
+			perror(output);
+			return EXIT_FAILURE;
+		}
+		setvbuf(stdout, NULL, _IOFBF, DIS_OUTPUT_BUFFER);
+	}
+
+	if (daemon != NULL)
+		return dis_daemon(daemon) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+	if (fuzz >= 0)
+		return dis_fuzz(&argv[context.index], argc - context.index, fuzz) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+	if (ngram) {
+		dis_ngram_corpus(&argv[context.index], argc - context.index, ngram, top);
+		return EXIT_SUCCESS;
+	}
+
+	if (stack) {
+		dis_stack_report(&argv[context.index], argc - context.index, json);
+		return EXIT_SUCCESS;
+	}
+
+	if (unused) {
+		dis_deadcode_report(&argv[context.index], argc - context.index, json);
+		return EXIT_SUCCESS;
+	}
+
+	if (types) {
+		dis_types_report(&argv[context.index], argc - context.index, json);
+		return EXIT_SUCCESS;
+	}
+
+	if (size) {
+		dis_size_report(&argv[context.index], argc - context.index, sort, top, json);
+		return EXIT_SUCCESS;
+	}
+
+	if (dupes) {
+		dis_dupes_report(&argv[context.index], argc - context.index, top, json);
+		return EXIT_SUCCESS;
+	}
+
+	if (decompile) {
+		dis_decompile_report(&argv[context.index], argc - context.index);
+		return EXIT_SUCCESS;
+	}
+
+	if (diff) {
+		if (argc - context.index != 2) {
+			fprintf(stderr, "diff needs two files or two directories\n");
+			return EXIT_FAILURE;
+		}
+		return dis_diff(argv[context.index], argv[context.index + 1]) ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+
+	// every mode below reads the file (or files, in batch mode) named after the options
+	if (argc - context.index < 1) {
+		fprintf(stderr, "no input file\n");
+		usage(stderr);
+		return EXIT_FAILURE;
+	}
+
+	if (browse)
+		return dis_browse(argv[context.index]) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+	if (symbolize != NULL)
+		return dis_symbolize_file(argv[context.index], symbolize) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+	if (assemble != NULL)
+		return dis_assemble(argv[context.index], assemble) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+	if (optimize != NULL)
+		return dis_optimize(argv[context.index], optimize) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+	if (compact != NULL)
+		return dis_compact(argv[context.index], compact) ? EXIT_FAILURE : EXIT_SUCCESS;
+
+	if (batch)
+		return dis_batch(&argv[context.index], argc - context.index, config) ? EXIT_FAILURE : EXIT_SUCCESS;
+
 	disassemble(argv[context.index], config);
 
 	return EXIT_SUCCESS;
@@ -0,0 +1,17 @@
+# -b prints the listings in argument order, each one as the single file run prints it
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+
+for fmt in "" -a -g -x; do
+	$DIS -b $fmt fib-memo.tb generator.tb function-within-function-bugfix.tb > batch.txt
+	for f in fib-memo generator function-within-function-bugfix; do
+		$DIS $fmt $f.tb
+	done | cmp - batch.txt && echo "batch $fmt: same listings"
+done
+
+# directories are walked recursively, a file that cannot be read is reported and skipped
+mkdir -p dir/sub
+cp fib-memo.tb dir
+cp generator.tb dir/sub
+$DIS -b dir missing.tb > batch.txt
+echo "batch exit $?"
+grep '^File:' batch.txt | sort
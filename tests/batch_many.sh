@@ -0,0 +1,21 @@
+# -b over more files than the reader keeps in flight, and over a large one
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+
+mkdir many
+for i in $(seq -w 1 80); do
+	cp generator.tb many/$i.tb
+done
+for i in $(seq -w 1 40); do
+	cp fib-memo.tb many/$i.small.tb
+done
+
+$DIS -b many/*.tb > batch.txt
+for f in many/*.tb; do
+	$DIS $f
+done | cmp - batch.txt && echo "$(ls many | wc -l) files: same listings"
+
+for i in $(seq 200); do
+	cat generator.tb
+done > large.tb
+$DIS -b large.tb generator.tb > batch.txt
+($DIS large.tb; $DIS generator.tb) | cmp - batch.txt && echo "large file: same listing"
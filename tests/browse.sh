@@ -0,0 +1,48 @@
+# -i draws the function tree on a terminal, moves, searches and quits on q; it refuses to
+# run without one
+cp generator.tb "$TMP" && cd "$TMP" || exit 1
+
+$DIS -i generator.tb < /dev/null
+echo "without a terminal: exit $?"
+
+command -v python3 > /dev/null || exit 77
+
+python3 - "$DIS" <<'END'
+import fcntl, os, pty, re, select, struct, sys, termios, time
+
+pid, fd = pty.fork()
+if pid == 0:
+    os.execv(sys.argv[1], [sys.argv[1], '-i', 'generator.tb'])
+
+fcntl.ioctl(fd, termios.TIOCSWINSZ, struct.pack('HHHH', 24, 80, 0, 0))
+os.kill(pid, 28) # SIGWINCH, the size was set after the fork
+
+def frame(keys):
+    if keys:
+        os.write(fd, keys)
+    text, deadline = b'', time.time() + 5
+    while time.time() < deadline:
+        r, _, _ = select.select([fd], [], [], 0.3)
+        if not r:
+            if text:
+                break
+            continue
+        try:
+            chunk = os.read(fd, 65536)
+        except OSError:
+            break
+        if not chunk:
+            break
+        text += chunk
+    return re.sub(r'\x1b\[[0-9;?]*[A-Za-z]', '', text.decode(errors='replace'))
+
+start = frame(None)
+print('start shows MAIN:', 'MAIN' in start, 'EOF' in start, 'FN_CALL' in start)
+print('G reaches EOF:', 'EOF' in frame(b'G'))
+print('g goes back:', 'EOF' in frame(b'g'))
+print('search finds FN_CALL:', 'FN_CALL' in frame(b'/FN_CALL\r'))
+frame(b'jjjjl\rhkkbb ')
+frame(b'q')
+_, status = os.waitpid(pid, 0)
+print('q exits:', os.WIFEXITED(status) and os.WEXITSTATUS(status))
+END
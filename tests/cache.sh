@@ -0,0 +1,16 @@
+# -c serves the same listing cold and warm, per format, and keeps one entry per file and code section
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+$DIS -O generator.opt.tb generator.tb > /dev/null
+
+for f in fib-memo generator generator.opt; do
+	for fmt in "" -a -g -x; do
+		$DIS $fmt $f.tb > plain.txt
+		$DIS -c cache $fmt $f.tb > cold.txt
+		$DIS -c cache $fmt $f.tb > warm.txt
+		cmp plain.txt cold.txt && cmp plain.txt warm.txt || echo "$f $fmt: cached listing differs"
+	done
+done
+
+echo "file entries: $(find cache -type f -name 'f*' | wc -l)"
+echo "section entries: $(find cache -type f -name 's*' | wc -l)"
+find cache -name '*.tmp*'
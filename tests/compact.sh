@@ -0,0 +1,19 @@
+# -C merges duplicate literals, the compacted copy lists with the same code and assembles back
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+
+$DIS -C generator.min.tb generator.tb
+$DIS -d generator.tb generator.min.tb
+$DIS -e generator.tb > before.txt
+$DIS -e generator.min.tb | sed 's/generator\.min\.tb/generator.tb/' | cmp - before.txt && echo "same pseudo source"
+
+$DIS -a -o generator.min.txt generator.min.tb
+$DIS -A again.tb generator.min.txt > /dev/null
+cmp generator.min.tb again.tb && echo "round trip: identical"
+
+$DIS -C fib-memo.min.tb fib-memo.tb
+cmp fib-memo.tb fib-memo.min.tb && echo "nothing to merge: identical"
+
+# no input file
+$DIS -C none.tb 2> error.txt
+echo "no input exit $?"
+head -1 error.txt
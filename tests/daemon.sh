@@ -0,0 +1,64 @@
+# -D answers FILE, FUNCTION, RANGE and PING requests like the command line does, serving a
+# client while another one has only sent part of its request, then stops on SHUTDOWN
+command -v python3 > /dev/null || exit 77
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+
+$DIS -D sock > daemon.txt 2>&1 &
+daemon=$!
+for i in $(seq 50); do
+	[ -S sock ] && break
+	sleep 0.1
+done
+
+$DIS fib-memo.tb > fib-memo.txt
+$DIS -a generator.tb > generator.txt
+
+python3 - "$TMP" <<'END'
+import socket, struct, sys
+
+def connect():
+    s = socket.socket(socket.AF_UNIX)
+    s.connect('sock')
+    s.settimeout(10)
+    return s
+
+def send(s, *fields):
+    p = '\t'.join(fields).encode()
+    s.sendall(struct.pack('<I', len(p)) + p)
+
+def receive(s):
+    n = struct.unpack('<I', s.recv(4, socket.MSG_WAITALL))[0]
+    return s.recv(n, socket.MSG_WAITALL).decode()
+
+def request(s, *fields):
+    send(s, *fields)
+    return receive(s)
+
+a, b = connect(), connect()
+
+# half a request on a, b is still served
+a.sendall(struct.pack('<I', 4) + b'PI')
+print('PING:', request(b, 'PING'))
+a.sendall(b'NG')
+print('PING on the other client:', receive(a))
+
+print('FILE default:', request(b, 'FILE', 'fib-memo.tb') == '0' + open('fib-memo.txt').read())
+print('FILE alt:', request(a, 'FILE', 'generator.tb', 'alt') == '0' + open('generator.txt').read())
+
+# pipelined, answered in order
+send(a, 'FUNCTION', 'generator.tb', '4_0', 'alt')
+send(a, 'RANGE', 'fib-memo.tb', '170', '200')
+send(a, 'RANGE', 'fib-memo.tb', '290', '400')
+for i in range(3):
+    sys.stdout.write(receive(a))
+
+for r in [('FILE', 'missing.tb'), ('FUNCTION', 'fib-memo.tb', '7'), ('RANGE', 'fib-memo.tb', '300', '10'), ('HELLO',)]:
+    print(' '.join(r) + ':', request(b, *r).strip())
+
+send(b, 'SHUTDOWN')
+END
+
+wait $daemon
+echo "daemon exit $?"
+[ -e sock ] && echo "socket left behind"
+sed "s|$TMP|TMP|g" daemon.txt
@@ -0,0 +1,6 @@
+# -e pseudo source of the bundled samples
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+
+for f in fib-memo function-within-function-bugfix generator; do
+	$DIS -e $f.tb
+done
@@ -0,0 +1,13 @@
+# -d between a file and itself, an optimized copy and an unrelated file, then two directories
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+$DIS -O generator.opt.tb generator.tb > /dev/null
+
+$DIS -d generator.tb generator.tb
+$DIS -d generator.tb generator.opt.tb
+$DIS -d fib-memo.tb function-within-function-bugfix.tb
+
+mkdir a b
+cp fib-memo.tb generator.tb a
+cp fib-memo.tb b
+cp generator.opt.tb b/generator.tb
+$DIS -d a b
@@ -0,0 +1,14 @@
+# -U groups identical and near-identical functions across files, as text and as JSON
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+$DIS -O generator.opt.tb generator.tb > /dev/null
+
+$DIS -U generator.tb generator.opt.tb fib-memo.tb function-within-function-bugfix.tb | sed 's/time: [0-9.]*s/time: -/'
+$DIS -U -t 2 -j generator.tb generator.opt.tb
+
+# a directory lists in path order whatever readdir returns, the links in it are skipped
+mkdir -p tree/b tree/a
+cp generator.tb tree/b/generator.tb
+cp generator.opt.tb tree/a/generator.tb
+ln -s ../b/generator.tb tree/a/link.tb
+ln -s .. tree/b/loop
+$DIS -U tree | sed 's/time: [0-9.]*s/time: -/' | head -5
@@ -0,0 +1,16 @@
+# string and identifier literals with quotes, backslashes, control bytes and spaces are
+# escaped on one line in every format, and -A reads the escapes back
+cp fib-memo.tb "$TMP" && cd "$TMP" || exit 1
+
+$DIS -a fib-memo.tb | sed \
+	-e 's/\.lit STRING ": "/.lit STRING "quote \\" backslash \\\\ tab \\t newline \\n del \\x7f and a run of plain text past thirty two bytes \\x01"/' \
+	-e 's/\.lit IDENTIFIER res$/.lit IDENTIFIER a\\x20spaced\\tname/' > escaped.txt
+$DIS -A escaped.tb escaped.txt > /dev/null
+
+$DIS escaped.tb | grep 'string\|identifier'
+$DIS -a escaped.tb | grep 'STRING\|IDENTIFIER'
+$DIS -x escaped.tb | grep 'string\|identifier'
+
+$DIS -a -o listed.txt escaped.tb
+$DIS -A again.tb listed.txt > /dev/null
+cmp escaped.tb again.tb && echo "round trip: identical"
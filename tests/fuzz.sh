@@ -0,0 +1,28 @@
+# -F over the samples finds nothing, and the listing modes refuse truncated or corrupted
+# files instead of reading past them
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+
+$DIS -F 300 fib-memo.tb function-within-function-bugfix.tb generator.tb > fuzz.txt 2>&1
+echo "fuzz exit $?"
+grep -o 'no crashes or hangs' fuzz.txt
+
+for args in "-F 1x" "-F abc" "-F -1" "-F 4294967296"; do
+	$DIS $args fib-memo.tb > /dev/null 2> error.txt
+	echo "$args: exit $?"
+	head -1 error.txt
+done
+
+head -c 200 generator.tb > truncated.tb
+head -c 3 fib-memo.tb > header.tb
+cp fib-memo.tb corrupt.tb
+printf '\xff\xff' | dd of=corrupt.tb bs=1 seek=38 conv=notrunc 2> /dev/null
+head -c 4096 /dev/zero > zeros.tb
+
+for f in truncated header corrupt zeros; do
+	for fmt in "" -a -x; do
+		$DIS $fmt $f.tb > /dev/null
+		echo "$f $fmt: exit $?"
+	done
+	$DIS -m $f.tb > /dev/null 2>&1
+	echo "$f -m: exit $?"
+done
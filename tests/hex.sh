@@ -0,0 +1,5 @@
+# -x shows the raw bytes of every literal and instruction next to the listing
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+
+$DIS -x fib-memo.tb
+$DIS -x -g function-within-function-bugfix.tb
@@ -0,0 +1,10 @@
+# -n counts opcode sequences over the samples, -n and -t are range checked
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+
+for n in 1 2 4; do
+	$DIS -n $n -t 8 fib-memo.tb function-within-function-bugfix.tb generator.tb | sed 's/time: [0-9.]*s/time: -/'
+done
+
+for args in "-n 0" "-n 9" "-n 300" "-n 2x" "-n 2 -t -1" "-n 2 -t 4294967296"; do
+	$DIS $args fib-memo.tb 2>&1 | head -1
+done
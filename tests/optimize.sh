@@ -0,0 +1,23 @@
+# -O: the pass report, then what changed in the listing of the optimized copy
+cp generator.tb fib-memo.tb "$TMP" && cd "$TMP" || exit 1
+
+$DIS -O generator.opt.tb generator.tb
+$DIS generator.tb > before.txt
+$DIS generator.opt.tb | sed 's/generator\.opt\.tb/generator.tb/' > after.txt
+diff before.txt after.txt
+
+# nothing to rewrite, the copy is identical
+$DIS -O fib-memo.opt.tb fib-memo.tb
+cmp fib-memo.tb fib-memo.opt.tb
+
+# a folded chain keeps only its final value, the copy is smaller than the input
+$DIS -a fib-memo.tb | sed '0,/^    LITERAL b(9)$/s//    LITERAL b(9)\n    LITERAL b(10)\n    ADDITION\n    LITERAL b(10)\n    NEGATE\n    SUBTRACTION/' > fold.txt
+$DIS -A fold.tb fold.txt > /dev/null
+$DIS -O fold.opt.tb fold.tb
+$DIS -u fold.opt.tb
+$DIS -a fold.opt.tb | sed -n '/^    .lit STRING/,/^$/p;/^JL_0001_:/,/IF_FALSE_JUMP/p'
+
+# no input file
+$DIS -O none.tb 2> error.txt
+echo "no input exit $?"
+head -1 error.txt
@@ -0,0 +1,16 @@
+# -p annotates blocks and instructions with counts given by function offset, file offset or function
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+
+cat > profile.txt <<END
+0:5 40
+0:47 1000
+MAIN: 1
+250 7
+0:70 12
+9:3 5
+# comment
+not a line
+9000 3
+END
+$DIS -p profile.txt fib-memo.tb
+$DIS -a -p profile.txt fib-memo.tb | grep -i 'hits\|comment'
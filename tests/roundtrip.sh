@@ -0,0 +1,9 @@
+# -a then -A gives back every bundled sample byte for byte, and so does the optimized generator
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+$DIS -O generator.opt.tb generator.tb > /dev/null
+
+for f in fib-memo function-within-function-bugfix generator generator.opt; do
+	$DIS -a -o $f.txt $f.tb || echo "$f: listing failed"
+	$DIS -A $f.out.tb $f.txt > /dev/null || echo "$f: assembly failed"
+	cmp $f.tb $f.out.tb && echo "$f: identical"
+done
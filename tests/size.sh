@@ -0,0 +1,9 @@
+# -z attributes every byte once, in every sort order, as text and as JSON
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+
+$DIS -z function-within-function-bugfix.tb
+for key in total self code literals tree; do
+	$DIS -z -k $key generator.tb
+done
+$DIS -z -j fib-memo.tb function-within-function-bugfix.tb
+$DIS -z -k bogus fib-memo.tb
@@ -0,0 +1,7 @@
+# -s per function stack depths and merge conflicts, as text and as JSON
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+
+for f in fib-memo function-within-function-bugfix generator; do
+	$DIS -s $f.tb
+done
+$DIS -s -j fib-memo.tb
@@ -0,0 +1,17 @@
+# - reads the program from stdin, pipes included, and -o writes the listing to a file
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+
+for f in fib-memo generator; do
+	for fmt in "" -a -g; do
+		$DIS $fmt $f.tb | sed "s/File: $f.tb\b/File: -/" > plain.txt
+		$DIS $fmt - < $f.tb | cmp - plain.txt || echo "$f $fmt: listing from stdin differs"
+		cat $f.tb | $DIS $fmt - | cmp - plain.txt || echo "$f $fmt: listing from a pipe differs"
+		$DIS $fmt -o out.txt - < $f.tb
+		cmp out.txt plain.txt && echo "$f $fmt: same listings"
+	done
+done
+
+$DIS -o out.txt fib-memo.tb
+head -3 out.txt
+$DIS - < /dev/null
+$DIS -o missing/out.txt fib-memo.tb
@@ -0,0 +1,13 @@
+# -m streams section by section and prints what the in memory listing prints
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+
+$DIS -m fib-memo.tb
+
+for f in fib-memo generator function-within-function-bugfix; do
+	for fmt in "" -a -g -x; do
+		$DIS $fmt $f.tb > plain.txt
+		$DIS -m $fmt $f.tb | cmp - plain.txt || echo "$f $fmt: streamed listing differs"
+	done
+	$DIS $f.tb | sed "s/^File: $f.tb$/File: -/" > plain.txt
+	$DIS -m - < $f.tb | cmp - plain.txt && echo "$f: same listings"
+done
@@ -0,0 +1,12 @@
+# -S maps file offsets to header, literals, instructions and markers, from stdin and from a file
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+
+printf '0\n40\n100\n2756\n2800\n3000\n3222\n3235\n9000\n9054\n9055\n99999\n' | $DIS -S - generator.tb
+
+seq 0 25 306 > offsets.txt
+$DIS -S offsets.txt fib-memo.tb
+
+# no input file
+$DIS -S offsets.txt 2> error.txt
+echo "no input exit $?"
+head -1 error.txt
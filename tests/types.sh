@@ -0,0 +1,7 @@
+# -y arithmetic and casts with known or polymorphic operand types, as text and as JSON
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+
+for f in fib-memo function-within-function-bugfix generator; do
+	$DIS -y $f.tb
+done
+$DIS -y -j fib-memo.tb
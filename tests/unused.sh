@@ -0,0 +1,7 @@
+# -u unreachable code and dead literals, as text and as JSON
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+
+for f in fib-memo function-within-function-bugfix generator; do
+	$DIS -u $f.tb
+done
+$DIS -u -j function-within-function-bugfix.tb
@@ -0,0 +1,32 @@
+# the header major version picks the opcode tables: 1.x rejects TYPE_DECL, a version with no
+# registered table is refused instead of decoded with a guessed layout
+cp fib-memo.tb "$TMP" && cd "$TMP" || exit 1
+
+# patch writes byte $3 at offset $2 of file $1
+patch() {
+	printf "\\x$3" | dd of=$1 bs=1 seek=$2 conv=notrunc 2> /dev/null
+}
+
+# the VAR_DECL at MAIN [00002] becomes a TYPE_DECL
+cp fib-memo.tb v1.tb
+patch v1.tb 239 11
+cp fib-memo.tb v0.tb
+patch v0.tb 0 00
+cp fib-memo.tb v7.tb
+patch v7.tb 0 07
+
+$DIS v1.tb | sed -n '4p;/reading main code/,+3p'
+
+for v in v0 v7; do
+	$DIS $v.tb; echo "$v exit $?"
+	$DIS -m $v.tb; echo "$v stream exit $?"
+	$DIS -a $v.tb; echo "$v -a exit $?"
+	$DIS -O $v.opt.tb $v.tb; echo "$v -O exit $?"
+done
+
+# the assembler refuses both a removed opcode and an unknown header version
+$DIS -a -o v1.txt fib-memo.tb
+sed 's/^    VAR_DECL b(1) b(3)$/    TYPE_DECL_removed b(1) b(3)/' v1.txt > removed.txt
+$DIS -A removed.tb removed.txt
+sed 's/Header Version: 1/Header Version: 0/' v1.txt > v0.txt
+$DIS -A v0.out.tb v0.txt
@@ -0,0 +1,46 @@
+# -w renders the files already there, then every .tb written, renamed into or removed from
+# the tree, mirroring it into the -o directory
+cp *.tb "$TMP" && cd "$TMP" || exit 1
+
+mkdir -p in/sub out
+cp fib-memo.tb in/
+$DIS -w in -o out > watch.txt 2>&1 &
+watch=$!
+
+# waits until the watcher printed $1 lines
+lines() {
+	for i in $(seq 100); do
+		[ $(grep -c . watch.txt) -ge $1 ] && return
+		sleep 0.05
+	done
+	echo "timed out waiting for line $1"
+}
+
+lines 2
+cp generator.tb in/sub/generator.tb
+lines 3
+cp function-within-function-bugfix.tb in/.partial
+mv in/.partial in/sub/moved.tb
+lines 4
+cp fib-memo.tb in/sub/generator.tb   # rewritten with new contents
+lines 5
+cp fib-memo.tb in/sub/generator.tb   # same contents, not rendered again
+rm in/fib-memo.tb
+lines 6
+mkdir in/new
+cp generator.tb in/new/late.tb
+lines 7
+echo text > in/notes.txt         # not a .tb, ignored
+sleep 0.2
+
+kill -TERM $watch
+wait $watch
+echo "watch exit $?"
+
+sed -e "s|$TMP/||g" -e 's/, [0-9.]* ms$//' watch.txt
+(cd out && find . -type f | sort)
+
+# every listing is what the single file run prints for the current input
+for f in sub/generator sub/moved new/late; do
+	$DIS in/$f.tb | cmp - out/$f.txt && echo "$f: same listing"
+done